@@ -580,8 +580,17 @@ public:
   insert_diff_node(const diff *d,
 		   const type_or_decl_base_sptr& impacted_iface);
 
-  artifact_sptr_set_type*
-  lookup_impacted_interfaces(const diff *d) const;
+  void
+  index_impacted_interfaces();
+
+  size_t
+  lookup_impacted_interfaces(const diff *d, vector<size_t>& ifaces) const;
+
+  const type_or_decl_base_sptr&
+  get_impacted_interface(size_t index) const;
+
+  const string&
+  get_impacted_interface_pretty_representation(size_t index) const;
 }; // end class diff_maps
 
 /// A convenience typedef for a shared pointer to @ref corpus_diff.
@@ -592,6 +601,8 @@ typedef shared_ptr<corpus_diff> corpus_diff_sptr;
 /// entities and the reporting that follows.
 class diff_context
 {
+  friend class diff;
+
   struct priv;
   shared_ptr<priv> priv_;
 
@@ -730,6 +741,16 @@ public:
   void
   add_suppressions(const suppr::suppressions_type& supprs);
 
+  bool
+  get_cached_suppression_verdict(const suppr::suppression_base* s,
+				 const type_base* t,
+				 bool& verdict) const;
+
+  void
+  cache_suppression_verdict(const suppr::suppression_base* s,
+			    const type_base* t,
+			    bool verdict);
+
   void
   show_leaf_changes_only(bool f);
 
@@ -919,6 +940,18 @@ protected:
   set_canonical_diff(diff *);
 
 public:
+  static void*
+  operator new(std::size_t size, const diff_context_sptr& ctxt);
+
+  static void*
+  operator new(std::size_t size);
+
+  static void
+  operator delete(void* p, const diff_context_sptr& ctxt);
+
+  static void
+  operator delete(void* p);
+
   type_or_decl_base_sptr
   first_subject() const;
 
@@ -2448,6 +2481,7 @@ public:
 
   friend class default_reporter;
   friend class leaf_reporter;
+  friend class json_reporter;
 }; // end class corpus_diff
 
 corpus_diff_sptr
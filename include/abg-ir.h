@@ -307,6 +307,9 @@ public:
   string
   expand(void) const;
 
+  const std::string&
+  expand_path() const;
+
   friend class location_manager;
 }; // end class location
 
@@ -331,6 +334,9 @@ public:
   void
   expand_location(const location& location, std::string& path,
 		  unsigned& line, unsigned& column) const;
+
+  const std::string&
+  expand_location_path(const location& location) const;
 };
 
 /// The base of an entity of the intermediate representation that is
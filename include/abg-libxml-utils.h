@@ -74,13 +74,17 @@ int get_xml_node_depth(xmlNodePtr);
   xml::build_sptr(xmlTextReaderGetAttribute(reader.get(), BAD_CAST(name)))
 
 /// Get the value of attribute 'name' ont the instance of xmlNodePtr
-/// denoted by 'node'.
+/// denoted by 'node'.  The value is not copied, so it must not be
+/// used after 'node' is freed.
 #define XML_NODE_GET_ATTRIBUTE(node, name) \
-  xml::build_sptr(xmlGetProp(node, BAD_CAST(name)))
+  xml::get_node_attribute(node, BAD_CAST(name))
 
 #define CHAR_STR(xml_char_str) \
   reinterpret_cast<char*>(xml_char_str.get())
 
+xml_char_sptr
+get_node_attribute(xmlNodePtr node, const xmlChar* name);
+
 xmlNodePtr
 advance_to_next_sibling_element(xmlNodePtr node);
 
@@ -112,6 +116,15 @@ unescape_xml_comment(const std::string& str,
 std::string
 unescape_xml_comment(const std::string& str);
 
+bool
+is_binary_tree(const char* buf, size_t size);
+
+bool
+write_binary_tree(xmlNodePtr root, std::ostream& out);
+
+xmlDocPtr
+read_binary_tree(const char* buf, size_t size);
+
 }//end namespace xml
 
 namespace sptr_utils
@@ -66,6 +66,10 @@ corpus_sptr
 read_corpus_from_native_xml(std::istream* in,
 			    environment*  env);
 
+corpus_sptr
+read_corpus_from_native_xml_buffer(const string& buffer,
+				   environment*  env);
+
 corpus_sptr
 read_corpus_from_native_xml_file(const string& path,
 				 environment*  env);
@@ -91,6 +95,9 @@ add_read_context_suppressions(read_context& ctxt,
 void
 consider_types_not_reachable_from_public_interfaces(read_context& ctxt,
 						    bool flag);
+
+void
+parse_translation_units_concurrently(read_context& ctxt, bool flag);
 }//end xml_reader
 }//end namespace abigail
 
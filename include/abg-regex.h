@@ -28,9 +28,27 @@ namespace regex
 /// A convenience typedef for a shared pointer of regex_t.
 typedef std::shared_ptr<regex_t> regex_t_sptr;
 
+class matcher;
+
+/// A convenience typedef for a shared pointer of @ref matcher.
+typedef std::shared_ptr<matcher> matcher_sptr;
+
 /// A delete functor for a shared_ptr of regex_t.
+///
+/// For a regex compiled by regex::compile(), the deleter also holds
+/// the @ref matcher used by regex::match() to match strings against
+/// the regex.
 struct regex_t_deleter
 {
+  matcher_sptr matcher_;
+
+  regex_t_deleter()
+  {}
+
+  regex_t_deleter(const matcher_sptr& m)
+    : matcher_(m)
+  {}
+
   /// The operator called to de-allocate the pointer to regex_t
   /// embedded in a shared_ptr<regex_t>
   ///
@@ -59,6 +77,10 @@ generate_from_strings(const std::vector<std::string>& strs);
 regex_t_sptr
 compile(const std::string& str);
 
+void
+compile_alternation(const std::vector<std::string>& patterns,
+		    std::vector<regex_t_sptr>& result);
+
 bool
 match(const regex_t_sptr& r, const std::string& str);
 
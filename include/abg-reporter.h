@@ -326,6 +326,106 @@ public:
 	 const std::string& indent = "") const;
 }; // end class leaf_reporter
 
+class json_reporter;
+
+/// A convenience typedef for a shared_ptr to a @ref json_reporter.
+typedef shared_ptr<json_reporter> json_reporter_sptr;
+
+/// A reporter that emits a machine-readable report, made of one JSON
+/// object per line (the JSON Lines format).
+///
+/// There is one record per removed, added or changed function,
+/// variable, ELF symbol or type.  Records are written out one at a
+/// time while the diff graph is walked; no record depends on a later
+/// one.
+///
+/// Note that this is only a different output format.  The diff graph
+/// is fully built and categorized before the first record is written
+/// out, and it's not released as records are emitted, so this
+/// reporter doesn't need less memory than the other ones.
+class json_reporter : public reporter_base
+{
+public:
+
+  virtual bool diff_has_net_changes(const corpus_diff *d) const;
+
+  virtual void
+  report(const type_decl_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const enum_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const typedef_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const qualified_type_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const distinct_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const pointer_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const reference_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const array_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const base_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const class_or_union_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const class_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const union_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const scope_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const fn_parm_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const function_type_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const function_decl_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const var_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const translation_unit_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+
+  virtual void
+  report(const corpus_diff& d, std::ostream& out,
+	 const std::string& indent = "") const;
+}; // end class json_reporter
+
 } // end namespace comparison
 } // end namespace abigail
 
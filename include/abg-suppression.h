@@ -525,6 +525,15 @@ public:
   void
   set_symbol_name_not_regex_str(const string&);
 
+  const unordered_set<string>&
+  get_symbol_names_to_keep() const;
+
+  unordered_set<string>&
+  get_symbol_names_to_keep();
+
+  void
+  set_symbol_names_to_keep(const unordered_set<string>&);
+
   const string&
   get_symbol_version() const;
 
@@ -720,6 +729,15 @@ public:
   void
   set_symbol_name_not_regex_str(const string&);
 
+  const unordered_set<string>&
+  get_symbol_names_to_keep() const;
+
+  unordered_set<string>&
+  get_symbol_names_to_keep();
+
+  void
+  set_symbol_names_to_keep(const unordered_set<string>&);
+
   const string&
   get_symbol_version() const;
 
@@ -37,6 +37,8 @@ const char* get_anonymous_enum_internal_name_prefix();
 bool file_exists(const string&);
 bool is_regular_file(const string&);
 bool is_dir(const string&);
+bool file_is_compressed(const string&);
+bool read_file_content(const string&, string&);
 bool dir_exists(const string&);
 bool dir_is_empty(const string &);
 bool decl_names_equal(const string&, const string&);
@@ -51,6 +53,7 @@ void real_path(const string&path, string& realpath);
 bool ensure_dir_path_created(const string&);
 bool ensure_parent_dir_created(const string&);
 ostream& emit_prefix(const string& prog_name, ostream& out);
+ostream& emit_json_string(const string& s, ostream& out);
 bool check_file(const string& path, ostream& out, const string& prog_name = "");
 bool check_dir(const string& path, ostream& out, const string& prog_name="");
 bool string_ends_with(const string&, const string&);
@@ -193,7 +196,10 @@ enum file_type
   FILE_TYPE_DIR,
   /// A tar archive.  The archive can be compressed with the popular
   /// compression schemes recognized by GNU tar.
-  FILE_TYPE_TAR
+  FILE_TYPE_TAR,
+  /// A native corpus in the binary corpus format, as emitted by
+  /// abidw --binary.
+  FILE_TYPE_BINARY_CORPUS
 };
 
 /// Exit status for abidiff and abicompat tools.
@@ -279,6 +285,29 @@ public:
 
 ostream& operator<<(ostream&, const timer&);
 
+/// An output file stream that compresses the content written to it
+/// in the gzip format, on the fly.
+///
+/// The files written that way can be read back by the native readers,
+/// which decompress them transparently.
+class compressed_ofstream : public std::ostream
+{
+  struct priv;
+  typedef shared_ptr<priv> priv_sptr;
+
+  priv_sptr priv_;
+
+  // Forbid copy.
+  compressed_ofstream(const compressed_ofstream&);
+  compressed_ofstream& operator=(const compressed_ofstream&);
+
+public:
+  compressed_ofstream(const string& path, int level = 6);
+  bool is_open() const;
+  bool close();
+  ~compressed_ofstream();
+}; //end class compressed_ofstream
+
 ostream&
 operator<<(ostream& output, file_type r);
 
@@ -32,6 +32,14 @@ namespace workers
 
 size_t get_number_of_threads();
 
+size_t get_physical_memory_size();
+
+size_t get_resident_set_size();
+
+size_t get_thread_budget();
+
+void set_thread_budget(size_t);
+
 /// This represents a task to be performed.
 ///
 /// Each instance of this type represents a task that can be performed
@@ -64,6 +72,15 @@ typedef shared_ptr<task> task_sptr;
 /// task to be added to the queue.
 ///
 /// Of course, several worker threads can execute tasks concurrently.
+///
+/// A task performed by a worker thread can in turn schedule tasks
+/// onto the same worker threads, using a @ref task_group or a @ref
+/// future.
+///
+/// A queue can also be given a memory budget, together with a @ref
+/// memory_estimator that estimates the memory each task needs.  The
+/// worker threads then only pick the tasks whose estimated memory
+/// fits in what is left of the budget.
 class queue
 {
 public:
@@ -76,13 +93,23 @@ public:
 private:
   priv_sptr p_;
 
+  friend class task_group;
+  friend class future
+  async(queue&, const task_sptr&);
+
 public:
   struct task_done_notify;
+  struct memory_estimator;
   queue();
   queue(unsigned number_of_workers);
   queue(unsigned number_of_workers,
 	task_done_notify& notifier);
+  queue(unsigned number_of_workers,
+	task_done_notify& notifier,
+	size_t memory_budget,
+	memory_estimator& estimator);
   size_t get_size() const;
+  size_t get_memory_budget() const;
   bool schedule_task(const task_sptr&);
   bool schedule_tasks(const tasks_type&);
   void wait_for_workers_to_complete();
@@ -97,6 +124,82 @@ struct queue::task_done_notify
   virtual void
   operator()(const task_sptr& task_done);
 };
+
+/// This functor estimates the memory that tasks scheduled for
+/// execution need, and is told about the memory they actually used
+/// once they are performed.
+///
+/// The member functions of a @ref memory_estimator are invoked in
+/// sequence, never in parallel with one another.
+struct queue::memory_estimator
+{
+  virtual size_t
+  estimate(const task_sptr& t);
+
+  virtual void
+  observe(const task_sptr& t, size_t peak_memory);
+
+  virtual ~memory_estimator(){};
+};
+
+/// This represents a set of tasks that are scheduled for execution
+/// by the worker threads of a @ref queue, and whose completion can be
+/// waited for.
+///
+/// A task being performed by a worker thread can use a @ref
+/// task_group to spawn sub-tasks and wait for them.  While waiting,
+/// the worker thread performs pending tasks, rather than sitting
+/// idle, so this doesn't deadlock the pool of worker threads.
+///
+/// The @ref queue of a @ref task_group must outlive it.
+class task_group
+{
+public:
+  struct priv;
+  typedef shared_ptr<priv> priv_sptr;
+
+private:
+  priv_sptr p_;
+
+  // Forbid copying.
+  task_group(const task_group&);
+  task_group& operator=(const task_group&);
+
+public:
+  task_group();
+  task_group(queue&);
+  bool schedule_task(const task_sptr&);
+  bool schedule_tasks(const queue::tasks_type&);
+  void wait();
+  ~task_group();
+}; // end class task_group
+
+/// This represents the result of a task that is scheduled for
+/// execution by the worker threads of a @ref queue.
+///
+/// Getting the task of a @ref future waits for the task to be
+/// performed, performing other pending tasks in the mean time if the
+/// current thread is a worker thread.
+class future
+{
+public:
+  struct priv;
+  typedef shared_ptr<priv> priv_sptr;
+
+private:
+  priv_sptr p_;
+
+public:
+  future();
+  future(const priv_sptr&);
+  bool is_valid() const;
+  bool is_ready() const;
+  const task_sptr& get() const;
+}; // end class future
+
+future async(const task_sptr&);
+
+future async(queue&, const task_sptr&);
 } // end namespace workers
 } // end namespace abigail
 #endif // __ABG_WORKERS_H__
@@ -69,6 +69,9 @@ set_write_parameter_names(write_context& ctxt, bool flag);
 void
 set_type_id_style(write_context& ctxt, type_id_style_kind style);
 
+void
+set_write_translation_units_concurrently(write_context& ctxt, bool flag);
+
 /// A convenience generic function to set common options (usually used
 /// by Libabigail tools) from a generic options carrying-object, into
 /// a given @ref write_context.
@@ -121,6 +124,10 @@ write_corpus(write_context&	ctxt,
 	     unsigned		indent,
 	     bool		member_of_group = false);
 
+bool
+write_corpus_to_binary(write_context&		ctxt,
+		       const corpus_sptr&	corpus);
+
 bool
 write_corpus_group(write_context&	    ctx,
 		   const corpus_group_sptr& group,
@@ -18,7 +18,11 @@
 
 #include "abg-internal.h"
 // <headers defining libabigail's API go under here>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <new>
 #include <unordered_set>
 ABG_BEGIN_EXPORT_DECLARATIONS
 
@@ -159,11 +163,278 @@ struct diff_equal
   }
 }; // end struct diff_equal
 
+/// A set of interfaces, represented as a bitset.  Bit N is set iff
+/// the interface which index is N belongs to the set.  The bitset is
+/// only as long as its highest set bit requires.
+typedef vector<uint64_t> interface_bitset;
+
 /// A convenience typedef for an unordered_map which key is a @ref
-/// diff* and which value is a @ref artifact_sptr_set_type.
-typedef unordered_map<const diff*, artifact_sptr_set_type,
+/// diff* and which value is a @ref interface_bitset.
+typedef unordered_map<const diff*, interface_bitset,
 		      diff_hash, diff_equal>
-diff_artifact_set_map_type;
+diff_interface_bitset_map_type;
+
+/// A memory arena from which diff nodes and their private data are
+/// allocated.
+///
+/// Memory is handed out by bumping a pointer into large blocks and is
+/// never given back piecemeal, nor reused: all the blocks are
+/// released at once, once the @ref diff_context that owns the arena
+/// is gone and all the chunks handed out have been given back.
+///
+/// Each chunk is preceded by a small header holding a pointer to its
+/// arena, so that the arena of a chunk is found from the address of
+/// the chunk.  The chunks that belong to no arena are allocated from
+/// the free store, with a header holding a nil arena pointer.
+///
+/// The arena counts its chunks that are still in use with a plain
+/// counter, so allocating and giving chunks back involves no atomic
+/// operation.  This means that an arena, its @ref diff_context and
+/// the diff nodes of that context must not be used by several threads
+/// at the same time.  They can be handed over from one thread to
+/// another, though, provided the two threads synchronize, as is done
+/// when a task is handed over to a worker of a worker::queue.  Note
+/// that diff nodes must not outlive the last diff node or @ref
+/// diff_context that refers to their arena either; shared pointers
+/// to them keep the arena alive.
+class diff_arena
+{
+  /// The header that precedes each chunk.
+  struct chunk_header
+  {
+    // The arena the chunk belongs to, or nil if the chunk belongs to
+    // no arena and was allocated from the free store.
+    diff_arena*	arena;
+  };
+
+  vector<char*>	blocks_;
+  size_t	used_;
+  // The number of chunks handed out that are not given back yet, plus
+  // one for the owner of the arena.
+  size_t	num_references_;
+
+  // Forbidden
+  diff_arena(const diff_arena&);
+  diff_arena& operator=(const diff_arena&);
+
+  ~diff_arena()
+  {
+    for (vector<char*>::iterator i = blocks_.begin(); i != blocks_.end(); ++i)
+      free(*i);
+  }
+
+public:
+  /// The alignment of the chunks of memory handed out by the arena.
+  static const size_t alignment = alignof(std::max_align_t);
+
+  /// The size of the blocks the arena hands memory out from.
+  static const size_t block_size = 64 * 1024;
+
+  /// Round a size up to the alignment of the arena.
+  ///
+  /// @param size the size to round up.
+  ///
+  /// @return the rounded up size.
+  static size_t
+  aligned_size(size_t size)
+  {return (size + alignment - 1) & ~(alignment - 1);}
+
+  /// The size taken by the header that precedes each chunk.
+  static size_t
+  header_size()
+  {return aligned_size(sizeof(chunk_header));}
+
+  /// Allocate some memory from the free store.
+  ///
+  /// @param size the size of the memory to allocate.
+  ///
+  /// @return the newly allocated memory.
+  static char*
+  allocate_from_free_store(size_t size)
+  {
+    void* m = malloc(size);
+    if (!m)
+      throw std::bad_alloc();
+    return static_cast<char*>(m);
+  }
+
+  /// Write the header of a chunk.
+  ///
+  /// @param m the memory of the chunk, including its header.
+  ///
+  /// @param arena the arena the chunk belongs to.  Can be nil.
+  ///
+  /// @return the chunk, past its header.
+  static void*
+  tag_chunk(char* m, diff_arena* arena)
+  {
+    reinterpret_cast<chunk_header*>(m)->arena = arena;
+    return m + header_size();
+  }
+
+  /// Get the header of a chunk.
+  ///
+  /// @param p the chunk to consider.
+  ///
+  /// @return the header of @p p.
+  static chunk_header*
+  header_of(void* p)
+  {return reinterpret_cast<chunk_header*>(static_cast<char*>(p)
+					  - header_size());}
+
+  diff_arena()
+    : used_(block_size),
+      num_references_(1)
+  {}
+
+  /// Allocate a chunk of memory from the arena.
+  ///
+  /// @param size the size of the chunk to allocate.
+  ///
+  /// @return the newly allocated chunk.
+  void*
+  allocate(size_t size)
+  {
+    size = header_size() + aligned_size(size);
+    ++num_references_;
+    if (size > block_size)
+      {
+	// This chunk gets a block of its own.  Insert it before the
+	// current block so that the latter can still be used.
+	char* b = allocate_from_free_store(size);
+	blocks_.insert(blocks_.empty() ? blocks_.end() : blocks_.end() - 1,
+		       b);
+	return tag_chunk(b, this);
+      }
+
+    if (used_ + size > block_size)
+      {
+	blocks_.push_back(allocate_from_free_store(block_size));
+	used_ = 0;
+      }
+
+    char* result = blocks_.back() + used_;
+    used_ += size;
+    return tag_chunk(result, this);
+  }
+
+  /// Allocate a chunk of memory that belongs to no arena.
+  ///
+  /// The chunk is allocated from the free store, and is released when
+  /// it's given back.
+  ///
+  /// @param size the size of the chunk to allocate.
+  ///
+  /// @return the newly allocated chunk.
+  static void*
+  allocate_standalone(size_t size)
+  {return tag_chunk(allocate_from_free_store(header_size() + size), 0);}
+
+  /// Give a chunk of memory back.
+  ///
+  /// If the chunk belongs to an arena, its memory is actually released
+  /// when the whole arena is.
+  ///
+  /// @param p the chunk to give back.  It must have been allocated by
+  /// diff_arena::allocate or diff_arena::allocate_standalone.
+  static void
+  deallocate(void* p)
+  {
+    chunk_header* h = header_of(p);
+    if (h->arena)
+      h->arena->release();
+    else
+      free(h);
+  }
+
+  /// Drop a reference to the arena.  The arena is destroyed when its
+  /// owner and all its chunks have dropped their reference.
+  void
+  release()
+  {
+    if (--num_references_ == 0)
+      delete this;
+  }
+}; // end class diff_arena
+
+/// A standard allocator that allocates from a @ref diff_arena.
+///
+/// When it's used to allocate the control block of a shared_ptr, the
+/// memory is given back to the arena when the last reference to the
+/// pointed-to object is dropped.
+template<typename T>
+class diff_arena_allocator
+{
+  template<typename U> friend class diff_arena_allocator;
+
+  diff_arena* arena_;
+
+public:
+  typedef T value_type;
+
+  diff_arena_allocator(diff_arena* a)
+    : arena_(a)
+  {}
+
+  template<typename U>
+  diff_arena_allocator(const diff_arena_allocator<U>& o)
+    : arena_(o.arena_)
+  {}
+
+  T*
+  allocate(size_t n)
+  {return static_cast<T*>(arena_->allocate(n * sizeof(T)));}
+
+  void
+  deallocate(T* p, size_t)
+  {diff_arena::deallocate(p);}
+
+  template<typename U>
+  bool
+  operator==(const diff_arena_allocator<U>& o) const
+  {return arena_ == o.arena_;}
+
+  template<typename U>
+  bool
+  operator!=(const diff_arena_allocator<U>& o) const
+  {return !operator==(o);}
+}; // end class diff_arena_allocator
+
+/// Create an object into a @ref diff_arena and return a shared
+/// pointer to it.
+///
+/// The object and the control block of the shared pointer are
+/// allocated in one go from the arena.  If no arena is given, the
+/// object is allocated from the free store.
+///
+/// @param arena the arena to allocate from.  Can be nil.
+///
+/// @param args the arguments to pass to the constructor of the
+/// object.
+///
+/// @return the shared pointer to the new object.
+template<typename T, typename... Args>
+shared_ptr<T>
+new_in_diff_arena(diff_arena* arena, Args&&... args)
+{
+  if (!arena)
+    return shared_ptr<T>(new T(std::forward<Args>(args)...));
+  return std::allocate_shared<T>(diff_arena_allocator<T>(arena),
+				 std::forward<Args>(args)...);
+}
+
+/// Convenience typedef for a map of suppression specification ->
+/// verdict of the suppression specification about a given type.
+typedef unordered_map<const suppression_base*, bool> suppression_verdict_map_type;
+
+/// Convenience typedef for a map of type -> verdicts of suppression
+/// specifications about the type.
+///
+/// The verdicts are grouped by type as all the suppression
+/// specifications are evaluated in a row against the subject types of
+/// a given diff node.
+typedef unordered_map<const type_base*,
+		      suppression_verdict_map_type> type_suppression_verdicts_map_type;
 
 /// The private member (pimpl) for @ref diff_context.
 struct diff_context::priv
@@ -171,10 +442,12 @@ struct diff_context::priv
   diff_category			allowed_category_;
   reporter_base_sptr			reporter_;
   types_or_decls_diff_map_type		types_or_decls_diff_map;
-  unordered_diff_sptr_set		live_diffs_;
+  diff_arena*				arena_;
+  vector<diff_sptr>			live_diffs_;
   vector<diff_sptr>			canonical_diffs;
   vector<filtering::filter_base_sptr>	filters_;
   suppressions_type			suppressions_;
+  type_suppression_verdicts_map_type	suppression_verdicts_;
   pointer_map				visited_diff_nodes_;
   corpus_diff_sptr			corpus_diff_;
   ostream*				default_output_stream_;
@@ -206,6 +479,7 @@ struct diff_context::priv
   priv()
     : allowed_category_(EVERYTHING_CATEGORY),
       reporter_(),
+      arena_(new diff_arena),
       default_output_stream_(),
       error_output_stream_(),
       leaf_changes_only_(),
@@ -232,6 +506,11 @@ struct diff_context::priv
       show_impacted_interfaces_(true),
       dump_diff_tree_()
    {}
+
+  /// Drop the reference of the context to its arena.  The arena is
+  /// released when the diff nodes allocated from it are gone.
+  ~priv()
+  {arena_->release();}
 };// end struct diff_context::priv
 
 struct type_diff_base::priv
@@ -256,6 +535,8 @@ struct diff::priv
   diff_category		category_;
   mutable bool			reported_once_;
   mutable bool			currently_reporting_;
+  // True iff the node is in the nodes kept alive by its context.
+  bool				kept_alive_;
   mutable string		pretty_representation_;
 
   priv();
@@ -279,7 +560,8 @@ public:
       local_category_(category),
       category_(category),
       reported_once_(reported_once),
-      currently_reporting_(currently_reporting)
+      currently_reporting_(currently_reporting),
+      kept_alive_()
   {}
 
   /// Getter of the diff context associated with this diff.
@@ -1451,6 +1733,13 @@ get_fn_decl_or_var_decl_diff_ancestor(const diff *);
 bool
 is_diff_of_global_decls(const diff*);
 
+void
+apply_filter_and_propagate_categories(filtering::filter_base&, diff*);
+
+void
+apply_filter_and_propagate_categories(filtering::filter_base&,
+				      corpus_diff*);
+
 } // end namespace comparison
 
 } // namespace abigail
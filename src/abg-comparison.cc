@@ -1222,7 +1222,14 @@ diff_context::initialize_canonical_diff(const diff_sptr diff)
 /// the current instance of @ref diff_context.
 void
 diff_context::keep_diff_alive(diff_sptr& d)
-{priv_->live_diffs_.insert(d);}
+{
+  // A node can be the child of several parents; keep it alive only
+  // once.
+  if (!d || d->priv_->kept_alive_)
+    return;
+  d->priv_->kept_alive_ = true;
+  priv_->live_diffs_.push_back(d);
+}
 
 /// Test if a diff node has been traversed.
 ///
@@ -1344,7 +1351,9 @@ diff_context::add_diff_filter(filtering::filter_base_sptr f)
 ///
 /// If the current context is instructed to filter out some categories
 /// then this function walks the given sub-tree and categorizes its
-/// nodes by using the filters held by the context.
+/// nodes by using the filters held by the context.  When there is
+/// only one filter, the categories are propagated to parent nodes
+/// during that same walk.
 ///
 /// @param diff the diff sub-tree to apply the filters to.
 void
@@ -1359,6 +1368,13 @@ diff_context::maybe_apply_filters(diff_sptr diff)
   if (!diff->has_changes())
     return;
 
+  if (diff_filters().size() == 1)
+    {
+      apply_filter_and_propagate_categories(*diff_filters().front(),
+					    diff.get());
+      return;
+    }
+
   for (filtering::filters::const_iterator i = diff_filters().begin();
        i != diff_filters().end();
        ++i)
@@ -1366,15 +1382,16 @@ diff_context::maybe_apply_filters(diff_sptr diff)
       filtering::apply_filter(*i, diff);
       propagate_categories(diff);
     }
-
- }
+}
 
 /// Apply the diff filters to the diff nodes of a @ref corpus_diff
 /// instance.
 ///
 /// If the current context is instructed to filter out some categories
 /// then this function walks the diff tree and categorizes its nodes
-/// by using the filters held by the context.
+/// by using the filters held by the context.  When there is only one
+/// filter, the categories are propagated to parent nodes during that
+/// same walk.
 ///
 /// @param diff the corpus diff to apply the filters to.
 void
@@ -1384,6 +1401,13 @@ diff_context::maybe_apply_filters(corpus_diff_sptr diff)
   if (!diff || !diff->has_changes())
     return;
 
+  if (diff_filters().size() == 1)
+    {
+      apply_filter_and_propagate_categories(*diff_filters().front(),
+					    diff.get());
+      return;
+    }
+
   for (filtering::filters::const_iterator i = diff_filters().begin();
        i != diff_filters().end();
        ++i)
@@ -1422,6 +1446,56 @@ diff_context::add_suppressions(const suppressions_type& supprs)
 			      supprs.begin(), supprs.end());
 }
 
+/// Getter of the verdict of a suppression specification about a
+/// type, as cached by diff_context::cache_suppression_verdict().
+///
+/// Evaluating a suppression specification against the subject types
+/// of a diff node can be costly.  As the same types are the subjects
+/// of many diff nodes, the verdicts are cached in the diff context.
+///
+/// Note that suppression specifications are applied to the diff
+/// nodes serially, so the cache is not protected against concurrent
+/// accesses.
+///
+/// @param s the suppression specification to consider.
+///
+/// @param t the type to consider.
+///
+/// @param verdict output parameter.  This is set to the cached
+/// verdict of @p s about @p t, if any.
+///
+/// @return true iff a verdict of @p s about @p t was cached.
+bool
+diff_context::get_cached_suppression_verdict(const suppression_base* s,
+					     const type_base* t,
+					     bool& verdict) const
+{
+  type_suppression_verdicts_map_type::const_iterator i =
+    priv_->suppression_verdicts_.find(t);
+  if (i == priv_->suppression_verdicts_.end())
+    return false;
+
+  suppression_verdict_map_type::const_iterator j = i->second.find(s);
+  if (j == i->second.end())
+    return false;
+
+  verdict = j->second;
+  return true;
+}
+
+/// Cache the verdict of a suppression specification about a type.
+///
+/// @param s the suppression specification to consider.
+///
+/// @param t the type to consider.
+///
+/// @param verdict the verdict of @p s about @p t.
+void
+diff_context::cache_suppression_verdict(const suppression_base* s,
+					const type_base* t,
+					bool verdict)
+{priv_->suppression_verdicts_[t][s] = verdict;}
+
 /// Set the flag that indicates if the diff using this context should
 /// show only leaf changes or not.
 ///
@@ -1850,12 +1924,64 @@ diff::diff(type_or_decl_base_sptr first_subject,
 diff::diff(type_or_decl_base_sptr	first_subject,
 	   type_or_decl_base_sptr	second_subject,
 	   diff_context_sptr	ctxt)
-  : priv_(new priv(first_subject, second_subject,
-		   ctxt, NO_CHANGE_CATEGORY,
-		   /*reported_once=*/false,
-		   /*currently_reporting=*/false))
+  : priv_(new_in_diff_arena<priv>(ctxt ? ctxt->priv_->arena_ : 0,
+				       first_subject, second_subject,
+				       ctxt, NO_CHANGE_CATEGORY,
+				       /*reported_once=*/false,
+				       /*currently_reporting=*/false))
 {}
 
+/// Allocate memory for a diff node.
+///
+/// The memory is allocated from the arena of the diff context of the
+/// node, so that the nodes of a given context are packed together
+/// and released in one go, rather than one by one from the free
+/// store.
+///
+/// @param size the size of the diff node to allocate.
+///
+/// @param ctxt the context the diff node belongs to.  If it's nil,
+/// the node gets a chunk of memory of its own.
+///
+/// @return the newly allocated memory.
+void*
+diff::operator new(std::size_t size, const diff_context_sptr& ctxt)
+{
+  if (ctxt)
+    return ctxt->priv_->arena_->allocate(size);
+  return diff_arena::allocate_standalone(size);
+}
+
+/// Allocate memory for a diff node that doesn't belong to any diff
+/// context.
+///
+/// @param size the size of the diff node to allocate.
+///
+/// @return the newly allocated memory.
+void*
+diff::operator new(std::size_t size)
+{return diff_arena::allocate_standalone(size);}
+
+/// Release the memory of a diff node whose constructor threw.
+///
+/// @param p the memory to release.
+void
+diff::operator delete(void* p, const diff_context_sptr&)
+{diff::operator delete(p);}
+
+/// Release the memory of a diff node.
+///
+/// If the node was allocated from an arena, the memory is given back
+/// when the whole arena is released.
+///
+/// @param p the memory to release.
+void
+diff::operator delete(void* p)
+{
+  if (p)
+    diff_arena::deallocate(p);
+}
+
 /// Flag a given diff node as being traversed.
 ///
 /// For certain diff nodes like @ref class_diff, it's important to
@@ -2659,7 +2785,7 @@ compute_diff_for_distinct_kinds(const type_or_decl_base_sptr first,
   if (!distinct_diff::entities_are_of_distinct_kinds(first, second))
     return distinct_diff_sptr();
 
-  distinct_diff_sptr result(new distinct_diff(first, second, ctxt));
+  distinct_diff_sptr result(new (ctxt) distinct_diff(first, second, ctxt));
 
   ctxt->initialize_canonical_diff(result);
 
@@ -3324,7 +3450,7 @@ compute_diff(const var_decl_sptr	first,
   if (first && second)
     ABG_ASSERT(first->get_environment() == second->get_environment());
 
-  var_diff_sptr d(new var_diff(first, second, diff_sptr(), ctxt));
+  var_diff_sptr d(new (ctxt) var_diff(first, second, diff_sptr(), ctxt));
   ctxt->initialize_canonical_diff(d);
 
   return d;
@@ -3471,7 +3597,8 @@ compute_diff(pointer_type_def_sptr	first,
   diff_sptr d = compute_diff_for_types(first->get_pointed_to_type(),
 				       second->get_pointed_to_type(),
 				       ctxt);
-  pointer_diff_sptr result(new pointer_diff(first, second, d, ctxt));
+  pointer_diff_sptr result(new (ctxt) pointer_diff(first, second,
+						    d, ctxt));
   ctxt->initialize_canonical_diff(result);
 
   return result;
@@ -3637,7 +3764,7 @@ compute_diff(array_type_def_sptr	first,
   diff_sptr d = compute_diff_for_types(first->get_element_type(),
 				       second->get_element_type(),
 				       ctxt);
-  array_diff_sptr result(new array_diff(first, second, d, ctxt));
+  array_diff_sptr result(new (ctxt) array_diff(first, second, d, ctxt));
   ctxt->initialize_canonical_diff(result);
   return result;
 }
@@ -3782,7 +3909,8 @@ compute_diff(reference_type_def_sptr	first,
   diff_sptr d = compute_diff_for_types(first->get_pointed_to_type(),
 				       second->get_pointed_to_type(),
 				       ctxt);
-  reference_diff_sptr result(new reference_diff(first, second, d, ctxt));
+  reference_diff_sptr result(new (ctxt) reference_diff(first, second,
+							d, ctxt));
   ctxt->initialize_canonical_diff(result);
   return result;
 }
@@ -3942,8 +4070,9 @@ compute_diff(const qualified_type_def_sptr	first,
   diff_sptr d = compute_diff_for_types(first->get_underlying_type(),
 				       second->get_underlying_type(),
 				       ctxt);
-  qualified_type_diff_sptr result(new qualified_type_diff(first, second,
-							  d, ctxt));
+  qualified_type_diff_sptr result(new (ctxt) qualified_type_diff(first,
+								  second,
+								  d, ctxt));
   ctxt->initialize_canonical_diff(result);
   return result;
 }
@@ -4170,7 +4299,7 @@ compute_diff(const enum_type_decl_sptr first,
   diff_sptr ud = compute_diff_for_types(first->get_underlying_type(),
 					second->get_underlying_type(),
 					ctxt);
-  enum_diff_sptr d(new enum_diff(first, second, ud, ctxt));
+  enum_diff_sptr d(new (ctxt) enum_diff(first, second, ud, ctxt));
 
   compute_diff(first->get_enumerators().begin(),
 	       first->get_enumerators().end(),
@@ -5661,7 +5790,7 @@ compute_diff(const class_decl_sptr	first,
   class_decl_sptr f = is_class_type(look_through_decl_only_class(first)),
     s = is_class_type(look_through_decl_only_class(second));
 
-  class_diff_sptr changes(new class_diff(f, s, ctxt));
+  class_diff_sptr changes(new (ctxt) class_diff(f, s, ctxt));
 
   ctxt->initialize_canonical_diff(changes);
   ABG_ASSERT(changes->get_canonical_diff());
@@ -5903,7 +6032,7 @@ compute_diff(const class_decl::base_spec_sptr	first,
   class_diff_sptr cl = compute_diff(first->get_base_class(),
 				    second->get_base_class(),
 				    ctxt);
-  base_diff_sptr changes(new base_diff(first, second, cl, ctxt));
+  base_diff_sptr changes(new (ctxt) base_diff(first, second, cl, ctxt));
 
   ctxt->initialize_canonical_diff(changes);
 
@@ -6023,7 +6152,7 @@ compute_diff(const union_decl_sptr	first,
   if (first && second)
     ABG_ASSERT(first->get_environment() == second->get_environment());
 
-  union_diff_sptr changes(new union_diff(first, second, ctxt));
+  union_diff_sptr changes(new (ctxt) union_diff(first, second, ctxt));
 
   ctxt->initialize_canonical_diff(changes);
   ABG_ASSERT(changes->get_canonical_diff());
@@ -6571,7 +6700,8 @@ compute_diff(const scope_decl_sptr	first_scope,
     ABG_ASSERT(first_scope->get_environment()
 	   == second_scope->get_environment());
 
-  scope_diff_sptr d(new scope_diff(first_scope, second_scope, ctxt));
+  scope_diff_sptr d(new (ctxt) scope_diff(first_scope, second_scope,
+					  ctxt));
   d = compute_diff(first_scope, second_scope, d, ctxt);
   ctxt->initialize_canonical_diff(d);
   return d;
@@ -6729,7 +6859,7 @@ compute_diff(const function_decl::parameter_sptr	first,
 
   ABG_ASSERT(first->get_environment() == second->get_environment());
 
-  fn_parm_diff_sptr result(new fn_parm_diff(first, second, ctxt));
+  fn_parm_diff_sptr result(new (ctxt) fn_parm_diff(first, second, ctxt));
   ctxt->initialize_canonical_diff(result);
 
   return result;
@@ -7023,7 +7153,8 @@ compute_diff(const function_type_sptr	first,
 
   ABG_ASSERT(first->get_environment() == second->get_environment());
 
-  function_type_diff_sptr result(new function_type_diff(first, second, ctxt));
+  function_type_diff_sptr result(new (ctxt) function_type_diff(first, second,
+								ctxt));
 
   diff_utils::compute_diff(first->get_first_parm(),
 			   first->get_parameters().end(),
@@ -7179,8 +7310,8 @@ compute_diff(const function_decl_sptr first,
 						   second->get_type(),
 						   ctxt);
 
-  function_decl_diff_sptr result(new function_decl_diff(first, second,
-							ctxt));
+  function_decl_diff_sptr result(new (ctxt) function_decl_diff(first, second,
+								ctxt));
   result->priv_->type_diff_ = type_diff;
 
   result->ensure_lookup_tables_populated();
@@ -7309,7 +7440,8 @@ compute_diff(const type_decl_sptr	first,
   if (first && second)
     ABG_ASSERT(first->get_environment() == second->get_environment());
 
-  type_decl_diff_sptr result(new type_decl_diff(first, second, ctxt));
+  type_decl_diff_sptr result(new (ctxt) type_decl_diff(first, second,
+							ctxt));
 
   // We don't need to actually compute a diff here as a type_decl
   // doesn't have complicated sub-components.  type_decl_diff::report
@@ -7475,7 +7607,8 @@ compute_diff(const typedef_decl_sptr	first,
   diff_sptr d = compute_diff_for_types(first->get_underlying_type(),
 				       second->get_underlying_type(),
 				       ctxt);
-  typedef_diff_sptr result(new typedef_diff(first, second, d, ctxt));
+  typedef_diff_sptr result(new (ctxt) typedef_diff(first, second,
+						    d, ctxt));
 
   ctxt->initialize_canonical_diff(result);
 
@@ -7596,8 +7729,9 @@ compute_diff(const translation_unit_sptr	first,
     ctxt.reset(new diff_context);
 
   // TODO: handle first or second having empty contents.
-  translation_unit_diff_sptr tu_diff(new translation_unit_diff(first, second,
-							       ctxt));
+  translation_unit_diff_sptr tu_diff(new (ctxt) translation_unit_diff(first,
+								       second,
+								       ctxt));
   scope_diff_sptr sc_diff = dynamic_pointer_cast<scope_diff>(tu_diff);
 
   compute_diff(static_pointer_cast<scope_decl>(first->get_global_scope()),
@@ -7629,9 +7763,185 @@ struct diff_maps::priv
   string_diff_ptr_map var_decl_diff_map_;
   string_diff_ptr_map distinct_diff_map_;
   string_diff_ptr_map fn_parm_diff_map_;
-  diff_artifact_set_map_type impacted_artifacts_map_;
+  // The interfaces impacted by the leaf diff nodes.  Each interface
+  // is designated by its index in this vector.  Artifacts that have
+  // the same pretty representation are deemed to be the same
+  // interface.
+  vector<type_or_decl_base_sptr> impacted_ifaces_;
+  // The pretty representations of the elements of impacted_ifaces_.
+  vector<string> impacted_iface_reprs_;
+  // The index of the impacted interfaces, by pretty representation.
+  unordered_map<string, size_t> impacted_iface_index_by_repr_;
+  // The set of interfaces impacted by each leaf diff node.
+  diff_interface_bitset_map_type impacted_ifaces_map_;
+  // Whether impacted_ifaces_ is sorted.
+  bool impacted_ifaces_sorted_;
+
+  priv()
+    : impacted_ifaces_sorted_(true)
+  {}
+
+  size_t
+  get_impacted_iface_index(const type_or_decl_base_sptr&);
+
+  void
+  sort_impacted_ifaces();
 }; // end struct diff_maps::priv
 
+/// Get the index of an interface impacted by a leaf diff node.
+///
+/// If the interface has not been seen before, it's given a new
+/// index.
+///
+/// @param iface the interface to consider.
+///
+/// @return the index of @p iface.
+size_t
+diff_maps::priv::get_impacted_iface_index(const type_or_decl_base_sptr& iface)
+{
+  string repr = get_pretty_representation(iface);
+  size_t index = impacted_ifaces_.size();
+  std::pair<unordered_map<string, size_t>::iterator, bool> r =
+    impacted_iface_index_by_repr_.insert(std::make_pair(repr, index));
+  if (r.second)
+    {
+      impacted_ifaces_.push_back(iface);
+      impacted_iface_reprs_.push_back(repr);
+      impacted_ifaces_sorted_ = false;
+    }
+  else
+    index = r.first->second;
+
+  return index;
+}
+
+/// A functor to compare the indexes of two interfaces by comparing
+/// the interfaces themselves.
+///
+/// Variables come first, then functions, then any other kind of
+/// artifact.  Artifacts of the same kind are compared using @ref
+/// type_or_decl_base_comp.  Ranking the kinds first keeps the order
+/// total when variables and functions are mixed, which @ref
+/// type_or_decl_base_comp alone doesn't guarantee.
+struct impacted_iface_index_comp
+{
+  const vector<type_or_decl_base_sptr>& ifaces_;
+
+  impacted_iface_index_comp(const vector<type_or_decl_base_sptr>& ifaces)
+    : ifaces_(ifaces)
+  {}
+
+  static int
+  get_rank(const type_or_decl_base_sptr& iface)
+  {
+    if (is_var_decl(iface))
+      return 0;
+    if (is_function_decl(iface))
+      return 1;
+    return 2;
+  }
+
+  bool
+  operator()(size_t l, size_t r) const
+  {
+    int l_rank = get_rank(ifaces_[l]), r_rank = get_rank(ifaces_[r]);
+    if (l_rank != r_rank)
+      return l_rank < r_rank;
+
+    type_or_decl_base_comp comp;
+    return comp(ifaces_[l], ifaces_[r]);
+  }
+}; // end struct impacted_iface_index_comp
+
+/// Set a bit in an @ref interface_bitset, growing it as needed.
+///
+/// @param bits the bitset to consider.
+///
+/// @param index the index of the bit to set.
+static void
+set_interface_bit(interface_bitset& bits, size_t index)
+{
+  size_t word = index / 64;
+  if (word >= bits.size())
+    bits.resize(word + 1, 0);
+  bits[word] |= uint64_t(1) << (index % 64);
+}
+
+/// Get the indexes of the bits set in an @ref interface_bitset, in
+/// increasing order.
+///
+/// @param bits the bitset to consider.
+///
+/// @param indexes output parameter.  The indexes of the bits set in
+/// @p bits are appended to this vector.
+static void
+get_interface_bits(const interface_bitset& bits, vector<size_t>& indexes)
+{
+  for (size_t word = 0; word < bits.size(); ++word)
+    {
+      uint64_t w = bits[word];
+      for (size_t bit = 0; w; ++bit, w >>= 1)
+	if (w & 1)
+	  indexes.push_back(word * 64 + bit);
+    }
+}
+
+/// Sort the impacted interfaces, so that the order of their indexes
+/// is the order in which they are to be reported.
+///
+/// All the indexes held by the data members of this type are updated
+/// accordingly.
+void
+diff_maps::priv::sort_impacted_ifaces()
+{
+  if (impacted_ifaces_sorted_)
+    return;
+
+  size_t num_ifaces = impacted_ifaces_.size();
+  vector<size_t> sorted(num_ifaces);
+  for (size_t i = 0; i < num_ifaces; ++i)
+    sorted[i] = i;
+  std::stable_sort(sorted.begin(), sorted.end(),
+		   impacted_iface_index_comp(impacted_ifaces_));
+
+  // new_index[i] is the index of the interface that had the index i.
+  vector<size_t> new_index(num_ifaces);
+  vector<type_or_decl_base_sptr> ifaces(num_ifaces);
+  vector<string> reprs(num_ifaces);
+  for (size_t i = 0; i < num_ifaces; ++i)
+    {
+      new_index[sorted[i]] = i;
+      ifaces[i] = impacted_ifaces_[sorted[i]];
+      reprs[i].swap(impacted_iface_reprs_[sorted[i]]);
+    }
+  impacted_ifaces_.swap(ifaces);
+  impacted_iface_reprs_.swap(reprs);
+
+  for (unordered_map<string, size_t>::iterator i =
+	 impacted_iface_index_by_repr_.begin();
+       i != impacted_iface_index_by_repr_.end();
+       ++i)
+    i->second = new_index[i->second];
+
+  vector<size_t> indexes;
+  for (diff_interface_bitset_map_type::iterator i =
+	 impacted_ifaces_map_.begin();
+       i != impacted_ifaces_map_.end();
+       ++i)
+    {
+      indexes.clear();
+      get_interface_bits(i->second, indexes);
+      interface_bitset bits;
+      for (vector<size_t>::const_iterator j = indexes.begin();
+	   j != indexes.end();
+	   ++j)
+	set_interface_bit(bits, new_index[*j]);
+      i->second.swap(bits);
+    }
+
+  impacted_ifaces_sorted_ = true;
+}
+
 /// Default constructor of the @ref diff_maps type.
 diff_maps::diff_maps()
   : priv_(new diff_maps::priv())
@@ -7858,38 +8168,77 @@ diff_maps::insert_diff_node(const diff *dif,
   // interfaces it impacts.
 
   if (impacted_iface)
-    {
-      diff_artifact_set_map_type::iterator i =
-	priv_->impacted_artifacts_map_.find(dif);
-
-      if (i == priv_->impacted_artifacts_map_.end())
-	{
-	  artifact_sptr_set_type set;
-	  set.insert(impacted_iface);
-	  priv_->impacted_artifacts_map_[dif] = set;
-	}
-      else
-	i->second.insert(impacted_iface);
-    }
+    set_interface_bit(priv_->impacted_ifaces_map_[dif],
+		      priv_->get_impacted_iface_index(impacted_iface));
 
   return true;
 }
 
+/// Build the index of the interfaces impacted by the leaf diff nodes
+/// of the current instance of @ref diff_maps.
+///
+/// The interfaces are sorted and numbered in the order in which they
+/// are to be reported.  This is done once all the leaf diff nodes
+/// have been inserted, so that lookup_impacted_interfaces() doesn't
+/// need to sort anything.
+void
+diff_maps::index_impacted_interfaces()
+{priv_->sort_impacted_ifaces();}
+
 /// Lookup the interfaces that are impacted by a given leaf diff node.
 ///
 /// @param d the diff node to consider.
 ///
-/// @return the set of artifacts impacted by @p d.
-artifact_sptr_set_type*
-diff_maps::lookup_impacted_interfaces(const diff *d) const
+/// @param ifaces output parameter.  The indexes of the interfaces
+/// impacted by @p d are appended to this vector, in the order in
+/// which they are to be reported.  The interfaces themselves can be
+/// retrieved with get_impacted_interface().
+///
+/// @return the number of interfaces impacted by @p d.
+size_t
+diff_maps::lookup_impacted_interfaces(const diff *d,
+				      vector<size_t>& ifaces) const
 {
-  diff_artifact_set_map_type::iterator i =
-    priv_->impacted_artifacts_map_.find(d);
+  diff_interface_bitset_map_type::const_iterator i =
+    priv_->impacted_ifaces_map_.find(d);
 
-  if (i == priv_->impacted_artifacts_map_.end())
+  if (i == priv_->impacted_ifaces_map_.end())
     return 0;
 
-  return &i->second;
+  if (!priv_->impacted_ifaces_sorted_)
+    const_cast<diff_maps*>(this)->index_impacted_interfaces();
+
+  size_t size = ifaces.size();
+  get_interface_bits(i->second, ifaces);
+  return ifaces.size() - size;
+}
+
+/// Getter of an interface impacted by a leaf diff node.
+///
+/// @param index the index of the interface, as returned by
+/// lookup_impacted_interfaces().
+///
+/// @return the interface which index is @p index.
+const type_or_decl_base_sptr&
+diff_maps::get_impacted_interface(size_t index) const
+{
+  ABG_ASSERT(index < priv_->impacted_ifaces_.size());
+  return priv_->impacted_ifaces_[index];
+}
+
+/// Getter of the pretty representation of an interface impacted by a
+/// leaf diff node.
+///
+/// @param index the index of the interface, as returned by
+/// lookup_impacted_interfaces().
+///
+/// @return the pretty representation of the interface which index is
+/// @p index.
+const string&
+diff_maps::get_impacted_interface_pretty_representation(size_t index) const
+{
+  ABG_ASSERT(index < priv_->impacted_iface_reprs_.size());
+  return priv_->impacted_iface_reprs_[index];
 }
 
 //
@@ -10895,6 +11244,8 @@ corpus_diff::mark_leaf_diff_nodes()
   traverse(v);
   context()->forbid_visiting_a_node_twice(s);
   context()->forbid_visiting_a_node_twice_per_interface(false);
+
+  get_leaf_diffs().index_impacted_interfaces();
 }
 
 /// Get the set of maps that contain leaf nodes.  A leaf node being a
@@ -11480,6 +11831,162 @@ struct category_propagation_visitor : public diff_node_visitor
   }
 };// end struct category_propagation_visitor
 
+/// A visitor that applies a categorization filter to the nodes of a
+/// diff tree and propagates the resulting categories up to the parent
+/// nodes, in one single traversal of the tree.
+///
+/// For a given node, the filter is applied before the categories of
+/// its children nodes are propagated to it.  As long as the tree has
+/// no cycle, walking it with this visitor is equivalent to walking it
+/// with the filter and then walking it again with a @ref
+/// category_propagation_visitor.
+///
+/// When a node is reached again while its own children are being
+/// visited, though, the categories of some of the nodes of the cycle
+/// might be propagated before the filter has had a chance to
+/// categorize them all.  So the visitor records that it went through
+/// a cycle and, from that point on, stops propagating categories.
+/// The categories it has propagated so far are recorded as well, so
+/// that they can be rolled back by @ref rollback_propagation before
+/// the caller performs a separate category propagation pass.
+struct filter_and_category_propagation_visitor
+  : public category_propagation_visitor
+{
+  filtering::filter_base&			filter_;
+  bool						saw_cycle_;
+  vector<std::pair<diff*, diff_category> >	propagated_;
+
+  filter_and_category_propagation_visitor(filtering::filter_base& f)
+    : filter_(f),
+      saw_cycle_(false)
+  {}
+
+  virtual void
+  visit_begin(diff* d)
+  {filter_.visit_begin(d);}
+
+  virtual void
+  visit_begin(corpus_diff* d)
+  {filter_.visit_begin(d);}
+
+  virtual bool
+  visit(diff* d, bool pre)
+  {
+    // The node is being visited while it's already being traversed;
+    // this means we went through a cycle.
+    if (pre && d->is_traversing())
+      saw_cycle_ = true;
+    return filter_.visit(d, pre);
+  }
+
+  virtual bool
+  visit(corpus_diff* d, bool pre)
+  {return filter_.visit(d, pre);}
+
+  virtual void
+  visit_end(diff* d)
+  {
+    filter_.visit_end(d);
+    if (saw_cycle_)
+      return;
+
+    diff* canonical = d->get_canonical_diff();
+    diff_category c = d->get_category();
+    diff_category cc = canonical ? canonical->get_category() : c;
+
+    category_propagation_visitor::visit_end(d);
+
+    if (diff_category added = d->get_category() & ~c)
+      propagated_.push_back(std::make_pair(d, added));
+    if (canonical && canonical != d)
+      if (diff_category added = canonical->get_category() & ~cc)
+	propagated_.push_back(std::make_pair(canonical, added));
+  }
+
+  virtual void
+  visit_end(corpus_diff* d)
+  {filter_.visit_end(d);}
+
+  /// Remove the categories propagated by this visitor from the nodes
+  /// they were propagated to.
+  ///
+  /// The categories that the filter put in the local category of a
+  /// node are kept.
+  void
+  rollback_propagation()
+  {
+    for (vector<std::pair<diff*, diff_category> >::const_iterator i =
+	   propagated_.begin();
+	 i != propagated_.end();
+	 ++i)
+      {
+	diff* d = i->first;
+	d->set_category(d->get_category()
+			& ~(i->second & ~d->get_local_category()));
+      }
+    propagated_.clear();
+  }
+}; // end struct filter_and_category_propagation_visitor
+
+/// Walk a diff sub-tree once, applying a filter to its nodes and
+/// propagating the categories of each node up to its parent nodes.
+///
+/// If the sub-tree turns out to have cycles, the categories are then
+/// propagated by a separate walk, just as @ref propagate_categories
+/// would do after @ref filtering::apply_filter.
+///
+/// Note that this function makes sure to avoid visiting a node (or
+/// any other node equivalent to it) more than once.
+///
+/// @param filter the filter to apply to the nodes of the sub-tree.
+///
+/// @param diff_tree the diff sub-tree to walk.
+void
+apply_filter_and_propagate_categories(filtering::filter_base& filter,
+				      diff* diff_tree)
+{
+  filter_and_category_propagation_visitor v(filter);
+  bool s = diff_tree->context()->visiting_a_node_twice_is_forbidden();
+  diff_tree->context()->forbid_visiting_a_node_twice(true);
+  diff_tree->context()->forget_visited_diffs();
+  diff_tree->traverse(v);
+  diff_tree->context()->forbid_visiting_a_node_twice(s);
+
+  if (v.saw_cycle_)
+    {
+      v.rollback_propagation();
+      propagate_categories(diff_tree);
+    }
+}
+
+/// Walk a @ref corpus_diff tree once, applying a filter to its nodes
+/// and propagating the categories of each node up to its parent
+/// nodes.
+///
+/// If the tree turns out to have cycles, the categories are then
+/// propagated by a separate walk, just as @ref propagate_categories
+/// would do after @ref filtering::apply_filter.
+///
+/// @param filter the filter to apply to the nodes of the tree.
+///
+/// @param diff_tree the @ref corpus_diff tree to walk.
+void
+apply_filter_and_propagate_categories(filtering::filter_base& filter,
+				      corpus_diff* diff_tree)
+{
+  filter_and_category_propagation_visitor v(filter);
+  bool s = diff_tree->context()->visiting_a_node_twice_is_forbidden();
+  diff_tree->context()->forbid_visiting_a_node_twice(false);
+  diff_tree->traverse(v);
+  diff_tree->context()->forbid_visiting_a_node_twice(s);
+
+  if (v.saw_cycle_)
+    {
+      v.rollback_propagation();
+      propagate_categories(diff_tree);
+    }
+}
+
 /// Visit all the nodes of a given sub-tree.  For each node that has a
 /// particular category set, propagate that category set up to its
 /// parent nodes.
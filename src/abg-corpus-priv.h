@@ -35,6 +35,73 @@ typedef vector<regex_t_sptr> regex_t_sptrs_type;
 
 // <corpus::exported_decls_builder>
 
+/// A set of regular expressions that designate functions or
+/// variables by their qualified name.
+///
+/// The regular expressions are compiled into as few alternations as
+/// possible, so that a name is matched against many of them in one
+/// go.  As the same names are looked at several times, the
+/// verdict is cached per interned name.
+class names_regex_set
+{
+  regex_t_sptrs_type			regexes_;
+  unordered_map<const string*, bool>	verdicts_;
+
+public:
+
+  /// Getter for the compiled regular expressions of the set.
+  ///
+  /// If the regular expressions are not compiled yet, this function
+  /// compiles them.
+  ///
+  /// @param patterns the regular expressions of the set.
+  ///
+  /// @return the compiled regular expressions.
+  const regex_t_sptrs_type&
+  get_regexes(const vector<string>& patterns)
+  {
+    if (regexes_.empty())
+      regex::compile_alternation(patterns, regexes_);
+    return regexes_;
+  }
+
+  /// Test if a name matches one of the regular expressions of the
+  /// set.
+  ///
+  /// @param patterns the regular expressions of the set.
+  ///
+  /// @param name the name to consider.
+  ///
+  /// @return true iff @p name matches one of @p patterns.
+  bool
+  matches(const vector<string>& patterns, const interned_string& name)
+  {
+    const regex_t_sptrs_type& regexes = get_regexes(patterns);
+    if (regexes.empty())
+      return false;
+
+    unordered_map<const string*, bool>::const_iterator i =
+      verdicts_.find(name.raw());
+    if (i != verdicts_.end())
+      return i->second;
+
+    const string empty_name;
+    const string& n = name.raw() ? *name.raw() : empty_name;
+    bool verdict = false;
+    for (regex_t_sptrs_type::const_iterator r = regexes.begin();
+	 r != regexes.end();
+	 ++r)
+      if (regex::match(*r, n))
+	{
+	  verdict = true;
+	  break;
+	}
+
+    verdicts_[name.raw()] = verdict;
+    return verdict;
+  }
+}; // end class names_regex_set
+
 /// Convenience typedef for a hash map which key is a string and which
 /// data is a vector of abigail::ir::function_decl*
 typedef unordered_map<string, vector<function_decl*> > str_fn_ptrs_map_type;
@@ -64,13 +131,13 @@ class corpus::exported_decls_builder::priv
   str_fn_ptrs_map_type	id_fns_map_;
   str_var_ptr_map_type	id_var_map_;
   strings_type&	fns_suppress_regexps_;
-  regex_t_sptrs_type	compiled_fns_suppress_regexp_;
+  names_regex_set	compiled_fns_suppress_regexp_;
   strings_type&	vars_suppress_regexps_;
-  regex_t_sptrs_type	compiled_vars_suppress_regexp_;
+  names_regex_set	compiled_vars_suppress_regexp_;
   strings_type&	fns_keep_regexps_;
-  regex_t_sptrs_type	compiled_fns_keep_regexps_;
+  names_regex_set	compiled_fns_keep_regexps_;
   strings_type&	vars_keep_regexps_;
-  regex_t_sptrs_type	compiled_vars_keep_regexps_;
+  names_regex_set	compiled_vars_keep_regexps_;
   strings_type&	sym_id_of_fns_to_keep_;
   strings_type&	sym_id_of_vars_to_keep_;
 
@@ -97,90 +164,34 @@ public:
   /// Getter for the compiled regular expressions that designate the
   /// functions to suppress from the set of exported functions.
   ///
-  /// @return a vector of the compiled regular expressions.
-  regex_t_sptrs_type&
+  /// @return the set of compiled regular expressions.
+  const regex_t_sptrs_type&
   compiled_regex_fns_suppress()
-  {
-    if (compiled_fns_suppress_regexp_.empty())
-      {
-	for (vector<string>::const_iterator i =
-	       fns_suppress_regexps_.begin();
-	     i != fns_suppress_regexps_.end();
-	     ++i)
-	  {
-	    regex_t_sptr r = regex::compile(*i);
-	    if (r)
-	      compiled_fns_suppress_regexp_.push_back(r);
-	  }
-      }
-    return compiled_fns_suppress_regexp_;
-  }
+  {return compiled_fns_suppress_regexp_.get_regexes(fns_suppress_regexps_);}
 
   /// Getter for the compiled regular expressions that designates the
   /// functions to keep in the set of exported functions.
   ///
-  /// @return a vector of compiled regular expressions.
-  regex_t_sptrs_type&
+  /// @return the set of compiled regular expressions.
+  const regex_t_sptrs_type&
   compiled_regex_fns_keep()
-  {
-    if (compiled_fns_keep_regexps_.empty())
-      {
-	for (vector<string>::const_iterator i =
-	       fns_keep_regexps_.begin();
-	     i != fns_keep_regexps_.end();
-	     ++i)
-	  {
-	    regex_t_sptr r = regex::compile(*i);
-	    if (r)
-	      compiled_fns_keep_regexps_.push_back(r);
-	  }
-      }
-    return compiled_fns_keep_regexps_;
-  }
+  {return compiled_fns_keep_regexps_.get_regexes(fns_keep_regexps_);}
 
   /// Getter of the compiled regular expressions that designate the
   /// variables to suppress from the set of exported variables.
   ///
-  /// @return a vector of compiled regular expressions.
-  regex_t_sptrs_type&
+  /// @return the set of compiled regular expressions.
+  const regex_t_sptrs_type&
   compiled_regex_vars_suppress()
-  {
-    if (compiled_vars_suppress_regexp_.empty())
-      {
-	for (vector<string>::const_iterator i =
-	       vars_suppress_regexps_.begin();
-	     i != vars_suppress_regexps_.end();
-	     ++i)
-	  {
-	    regex_t_sptr r = regex::compile(*i);
-	    if (r)
-	      compiled_vars_suppress_regexp_.push_back(r);
-	  }
-      }
-    return compiled_vars_suppress_regexp_;
-  }
+  {return compiled_vars_suppress_regexp_.get_regexes(vars_suppress_regexps_);}
 
   /// Getter for the compiled regular expressions that designate the
   /// variables to keep in the set of exported variables.
   ///
-  /// @return a vector of compiled regular expressions.
-  regex_t_sptrs_type&
+  /// @return the set of compiled regular expressions.
+  const regex_t_sptrs_type&
   compiled_regex_vars_keep()
-  {
-    if (compiled_vars_keep_regexps_.empty())
-      {
-	for (vector<string>::const_iterator i =
-	       vars_keep_regexps_.begin();
-	     i != vars_keep_regexps_.end();
-	     ++i)
-	  {
-	    regex_t_sptr r = regex::compile(*i);
-	    if (r)
-	      compiled_vars_keep_regexps_.push_back(r);
-	  }
-      }
-    return compiled_vars_keep_regexps_;
-  }
+  {return compiled_vars_keep_regexps_.get_regexes(vars_keep_regexps_);}
 
   /// Getter for a map of the IDs of the functions that are present in
   /// the set of exported functions.
@@ -499,20 +510,8 @@ public:
     if (!fn)
       return false;
 
-    string frep = fn->get_qualified_name();
-    bool keep = true;
-
-    for (regex_t_sptrs_type::const_iterator i =
-	   compiled_regex_fns_suppress().begin();
-	 i != compiled_regex_fns_suppress().end();
-	 ++i)
-      if (regex::match(*i, frep))
-	{
-	  keep = false;
-	  break;
-	}
-
-    return keep;
+    return !compiled_fns_suppress_regexp_.matches(fns_suppress_regexps_,
+						  fn->get_qualified_name());
   }
 
   /// Look at the regular expressions of the functions to keep and
@@ -528,24 +527,11 @@ public:
     if (!fn)
       return false;
 
-    string frep = fn->get_qualified_name();
-    bool keep = true;
-
-    if (!compiled_regex_fns_keep().empty())
-      keep = false;
-
-    if (!keep)
-      for (regex_t_sptrs_type::const_iterator i =
-	     compiled_regex_fns_keep().begin();
-	   i != compiled_regex_fns_keep().end();
-	   ++i)
-	if (regex::match(*i, frep))
-	  {
-	    keep = true;
-	    break;
-	  }
+    if (compiled_regex_fns_keep().empty())
+      return true;
 
-    return keep;
+    return compiled_fns_keep_regexps_.matches(fns_keep_regexps_,
+					      fn->get_qualified_name());
   }
 
   /// Look at the regular expressions of the variables to keep and
@@ -606,20 +592,8 @@ public:
     if (!var)
       return false;
 
-    string frep = var->get_qualified_name();
-    bool keep = true;
-
-    for (regex_t_sptrs_type::const_iterator i =
-	   compiled_regex_vars_suppress().begin();
-	 i != compiled_regex_vars_suppress().end();
-	 ++i)
-      if (regex::match(*i, frep))
-	{
-	  keep = false;
-	  break;
-	}
-
-    return keep;
+    return !compiled_vars_suppress_regexp_.matches(vars_suppress_regexps_,
+						   var->get_qualified_name());
   }
 
   /// Look at the regular expressions of the variables to keep and
@@ -635,26 +609,11 @@ public:
     if (!var)
       return false;
 
-    string frep = var->get_qualified_name();
-    bool keep = true;
-
-    if (!compiled_regex_vars_keep().empty())
-      keep = false;
-
-    if (!keep)
-      {
-	for (regex_t_sptrs_type::const_iterator i =
-	       compiled_regex_vars_keep().begin();
-	     i != compiled_regex_vars_keep().end();
-	     ++i)
-	  if (regex::match(*i, frep))
-	    {
-	      keep = true;
-	      break;
-	    }
-      }
+    if (compiled_regex_vars_keep().empty())
+      return true;
 
-    return keep;
+    return compiled_vars_keep_regexps_.matches(vars_keep_regexps_,
+					       var->get_qualified_name());
   }
 }; // end struct corpus::exported_decls_builder::priv
 
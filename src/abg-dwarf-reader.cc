@@ -2119,6 +2119,7 @@ public:
   }; // end die_dependant_container_set
 
   suppr::suppressions_type	supprs_;
+  mutable suppr::suppressions_index supprs_index_;
   unsigned short		dwarf_version_;
   Dwfl_Callbacks		offline_callbacks_;
   // The set of directories under which to look for debug info.
@@ -2251,6 +2252,11 @@ public:
   address_set_sptr		linux_exported_var_syms_;
   address_set_sptr		linux_exported_gpl_fn_syms_;
   address_set_sptr		linux_exported_gpl_var_syms_;
+  // The addresses of the function and variable symbols that were
+  // dropped on the floor while loading the symbol maps, because they
+  // are suppressed.
+  address_set_type		dropped_fn_syms_addresses_;
+  address_set_type		dropped_var_syms_addresses_;
   vector<string>		dt_needed_;
   string			dt_soname_;
   string			elf_architecture_;
@@ -2361,6 +2367,7 @@ public:
     clear_alt_debug_info_data();
 
     supprs_.clear();
+    supprs_index_.invalidate();
     decl_die_repr_die_offsets_maps_.clear();
     type_die_repr_die_offsets_maps_.clear();
     die_qualified_name_maps_.clear();
@@ -2404,6 +2411,8 @@ public:
     linux_exported_var_syms_.reset();
     linux_exported_gpl_fn_syms_.reset();
     linux_exported_gpl_var_syms_.reset();
+    dropped_fn_syms_addresses_.clear();
+    dropped_var_syms_addresses_.clear();
     dt_needed_.clear();
     dt_soname_.clear();
     elf_architecture_.clear();
@@ -2517,7 +2526,23 @@ public:
   /// @return the suppression specifications.
   suppr::suppressions_type&
   get_suppressions()
-  {return supprs_;}
+  {
+    // The caller might modify the suppression specifications so the
+    // index of the suppression specifications needs to be updated.
+    supprs_index_.invalidate();
+    return supprs_;
+  }
+
+  /// Getter of the index of the suppression specifications to be
+  /// used during ELF/DWARF parsing.
+  ///
+  /// @return the index of the suppression specifications.
+  const suppr::suppressions_index&
+  get_suppressions_index() const
+  {
+    supprs_index_.update(supprs_);
+    return supprs_index_;
+  }
 
   /// Getter for the callbacks of the Dwarf Front End library of
   /// elfutils that is used by this reader to read dwarf.
@@ -6207,15 +6232,34 @@ public:
 	    && (GELF_ST_TYPE(sym->st_info) == STT_FUNC
 		|| GELF_ST_TYPE(sym->st_info) == STT_GNU_IFUNC))
 	  {
+	    // If the symbol was suppressed by a suppression
+	    // specification then drop it on the floor, before
+	    // building its elf_symbol.  Its address is remembered so
+	    // that the DIEs of the function it designates can be
+	    // skipped early.
+	    if (is_elf_symbol_suppressed(elf_strptr(elf_handle(),
+						    symtab_sheader->sh_link,
+						    sym->st_name),
+					 stt_to_elf_symbol_type
+					 (GELF_ST_TYPE(sym->st_info))))
+	      {
+		if (load_fun_map && sym->st_shndx != SHN_UNDEF)
+		  {
+		    dropped_fn_syms_addresses_.insert
+		      (maybe_adjust_et_rel_sym_addr_to_abs_addr(elf_handle(),
+								sym));
+		    if (is_ppc64)
+		      dropped_fn_syms_addresses_.insert
+			(lookup_ppc64_elf_fn_entry_point_address
+			 (sym->st_value));
+		  }
+		continue;
+	      }
+
 	    elf_symbol_sptr symbol = lookup_elf_symbol_from_index(i);
 	    ABG_ASSERT(symbol);
 	    ABG_ASSERT(symbol->is_function());
 
-	    // If the symbol was suppressed by a suppression
-	    // specification then drop it on the floor.
-	    if (is_elf_symbol_suppressed(symbol))
-	      continue;
-
 	    if (load_fun_map && symbol->is_public())
 	      {
 		(*fun_syms_)[symbol->get_name()].push_back(symbol);
@@ -6332,6 +6376,24 @@ public:
 		 && (sym->st_shndx != SHN_ABS
 		     || GELF_ST_TYPE(sym->st_info) != STT_OBJECT ))
 	  {
+	    // If the symbol was suppressed by a suppression
+	    // specification then drop it on the floor, before
+	    // building its elf_symbol.
+	    if (is_elf_symbol_suppressed(elf_strptr(elf_handle(),
+						    symtab_sheader->sh_link,
+						    sym->st_name),
+					 stt_to_elf_symbol_type
+					 (GELF_ST_TYPE(sym->st_info))))
+	      {
+		if (load_var_map
+		    && sym->st_shndx != SHN_UNDEF
+		    && sym->st_shndx != SHN_COMMON)
+		  dropped_var_syms_addresses_.insert
+		    (maybe_adjust_et_rel_sym_addr_to_abs_addr(elf_handle(),
+							      sym));
+		continue;
+	      }
+
 	    elf_symbol_sptr symbol = lookup_elf_symbol_from_index(i);
 	    ABG_ASSERT(symbol);
 	    ABG_ASSERT(symbol->is_variable());
@@ -6751,6 +6813,70 @@ public:
 					       symbol->get_type()));
   }
 
+  /// Test if an ELF symbol, designated by its name and type, is
+  /// suppressed by a suppression specification.
+  ///
+  /// This lets the caller drop a symbol on the floor without having
+  /// to build the @ref elf_symbol that represents it.
+  ///
+  /// @param name the name of the symbol to consider, as found in the
+  /// string table of the symbol table section.  It can be nil.
+  ///
+  /// @param type the type of the symbol to consider.
+  ///
+  /// @return true iff the symbol is suppressed.
+  bool
+  is_elf_symbol_suppressed(const char* name, elf_symbol::type type) const
+  {
+    if (get_suppressions().empty())
+      return false;
+    return suppr::is_elf_symbol_suppressed(*this, name ? name : "", type);
+  }
+
+  /// Test if the function symbol at a given address was dropped on
+  /// the floor because it's suppressed.
+  ///
+  /// Note that if another symbol at that address, e.g, an alias of
+  /// the dropped symbol, was kept, then the address is not considered
+  /// as dropped.
+  ///
+  /// @param symbol_address the address to consider, as returned by
+  /// read_context::get_function_address().
+  ///
+  /// @return true iff the function symbol at @p symbol_address was
+  /// dropped.
+  bool
+  function_symbol_is_dropped(GElf_Addr symbol_address) const
+  {
+    if (dropped_fn_syms_addresses_.empty())
+      return false;
+    return (dropped_fn_syms_addresses_.find(symbol_address)
+	    != dropped_fn_syms_addresses_.end()
+	    && !lookup_elf_fn_symbol_from_address(symbol_address));
+  }
+
+  /// Test if the variable symbol at a given address was dropped on
+  /// the floor because it's suppressed.
+  ///
+  /// Note that if another symbol at that address, e.g, an alias of
+  /// the dropped symbol, was kept, then the address is not considered
+  /// as dropped.
+  ///
+  /// @param symbol_address the address to consider, as returned by
+  /// read_context::get_variable_address().
+  ///
+  /// @return true iff the variable symbol at @p symbol_address was
+  /// dropped.
+  bool
+  variable_symbol_is_dropped(GElf_Addr symbol_address) const
+  {
+    if (dropped_var_syms_addresses_.empty())
+      return false;
+    return (dropped_var_syms_addresses_.find(symbol_address)
+	    != dropped_var_syms_addresses_.end()
+	    && !lookup_elf_var_symbol_from_address(symbol_address));
+  }
+
   /// Populate the symbol map by reading exported symbols from the
   /// ksymtab directly.
   ///
@@ -6891,23 +7017,41 @@ public:
     bool is_relasec = (reloc_section_shdr->sh_type == SHT_RELA);
     elf_symbol_sptr symbol;
     GElf_Sym native_symbol;
+
+    Elf_Scn* symtab_section = find_symbol_table_section();
+    ABG_ASSERT(symtab_section);
+    GElf_Shdr symtab_sheader_mem;
+    GElf_Shdr* symtab_sheader = gelf_getshdr(symtab_section,
+					     &symtab_sheader_mem);
+
     for (unsigned int i = 0; i < reloc_count; i++)
       {
+	size_t symbol_index;
 	if (is_relasec)
 	  {
 	    GElf_Rela rela;
 	    gelf_getrela(reloc_section_data, i, &rela);
-	    symbol = lookup_elf_symbol_from_index(GELF_R_SYM(rela.r_info),
-						  native_symbol);
+	    symbol_index = GELF_R_SYM(rela.r_info);
 	  }
 	else
 	  {
 	    GElf_Rel rel;
 	    gelf_getrel(reloc_section_data, i, &rel);
-	    symbol = lookup_elf_symbol_from_index(GELF_R_SYM(rel.r_info),
-						  native_symbol);
+	    symbol_index = GELF_R_SYM(rel.r_info);
 	  }
 
+	// If the symbol was suppressed by a suppression
+	// specification then drop it on the floor, before building
+	// its elf_symbol.
+	if (lookup_native_elf_symbol_from_index(symbol_index, native_symbol)
+	    && is_elf_symbol_suppressed(elf_strptr(elf_handle(),
+						   symtab_sheader->sh_link,
+						   native_symbol.st_name),
+					stt_to_elf_symbol_type
+					(GELF_ST_TYPE(native_symbol.st_info))))
+	  continue;
+
+	symbol = lookup_elf_symbol_from_index(symbol_index, native_symbol);
 	ABG_ASSERT(symbol);
 
         // If the symbol is a linux string constant then ignore it.
@@ -6937,11 +7081,6 @@ public:
 	    continue;
 	  }
 
-	// If the symbol was suppressed by a suppression
-	// specification then drop it on the floor.
-	if (is_elf_symbol_suppressed(symbol))
-	  continue;
-
 	// If we are looking at an ET_REL (relocatable) binary, then
 	// the symbol value of native_symbol is relative to the
 	// section that symbol is defined in.  We need to translate it
@@ -15395,6 +15534,54 @@ build_var_decl(read_context&	ctxt,
   return result;
 }
 
+/// Test if the symbol of the function denoted by a given DIE was
+/// dropped on the floor while loading the symbol maps, because it's
+/// suppressed by a suppression specification.
+///
+/// Such a function is going to be suppressed as well, so the reader
+/// can skip the DIE without looking at its name or type.
+///
+/// @param ctxt the ELF/DWARF reading context of interest.
+///
+/// @param function_die the DIE representing the function.
+///
+/// @return true iff the symbol of @p function_die was dropped.
+static bool
+function_die_symbol_is_dropped(const read_context& ctxt,
+			       Dwarf_Die *function_die)
+{
+  if (ctxt.get_suppressions().empty())
+    return false;
+
+  Dwarf_Addr fn_addr;
+  return (ctxt.get_function_address(function_die, fn_addr)
+	  && ctxt.function_symbol_is_dropped(fn_addr));
+}
+
+/// Test if the symbol of the variable denoted by a given DIE was
+/// dropped on the floor while loading the symbol maps, because it's
+/// suppressed by a suppression specification.
+///
+/// Such a variable is going to be suppressed as well, so the reader
+/// can skip the DIE without looking at its name or type.
+///
+/// @param ctxt the ELF/DWARF reading context of interest.
+///
+/// @param variable_die the DIE representing the variable.
+///
+/// @return true iff the symbol of @p variable_die was dropped.
+static bool
+variable_die_symbol_is_dropped(const read_context& ctxt,
+			       Dwarf_Die *variable_die)
+{
+  if (ctxt.get_suppressions().empty())
+    return false;
+
+  Dwarf_Addr var_addr;
+  return (ctxt.get_variable_address(variable_die, var_addr)
+	  && ctxt.variable_symbol_is_dropped(var_addr));
+}
+
 /// Test if a given function denoted by its DIE and its scope is
 /// suppressed by any of the suppression specifications associated to
 /// a given context of ELF/DWARF reading.
@@ -15423,6 +15610,9 @@ function_is_suppressed(const read_context& ctxt,
       || dwarf_tag(function_die) != DW_TAG_subprogram)
     return false;
 
+  if (function_die_symbol_is_dropped(ctxt, function_die))
+    return true;
+
   string fname = die_string_attribute(function_die, DW_AT_name);
   string flinkage_name = die_linkage_name(function_die);
   if (flinkage_name.empty() && ctxt.die_is_in_c(function_die))
@@ -15540,6 +15730,9 @@ variable_is_suppressed(const read_context& ctxt,
 	  && dwarf_tag(variable_die) != DW_TAG_member))
     return false;
 
+  if (variable_die_symbol_is_dropped(ctxt, variable_die))
+    return true;
+
   string name = die_string_attribute(variable_die, DW_AT_name);
   string linkage_name = die_linkage_name(variable_die);
   if (linkage_name.empty() && ctxt.die_is_in_c(variable_die))
@@ -16788,6 +16981,12 @@ build_ir_node_from_die(read_context&	ctxt,
 	if (tag == DW_TAG_member)
 	  ABG_ASSERT(!is_c_language(ctxt.cur_transl_unit()->get_language()));
 
+	// If the symbol of the variable was dropped because it's
+	// suppressed, then do not even build the declaration this
+	// DIE is the definition of.
+	if (tag == DW_TAG_variable && variable_die_symbol_is_dropped(ctxt, die))
+	  break;
+
 	if (die_die_attribute(die, DW_AT_specification, spec_die, false)
 	    || (var_is_cloned = die_die_attribute(die, DW_AT_abstract_origin,
 						  spec_die, false)))
@@ -16854,6 +17053,12 @@ build_ir_node_from_die(read_context&	ctxt,
 	if (die_is_artificial(die))
 	  break;
 
+	// If the symbol of the function was dropped because it's
+	// suppressed, then do not even build the declaration this
+	// DIE is the definition of, nor the types it refers to.
+	if (function_die_symbol_is_dropped(ctxt, die))
+	  break;
+
 	function_decl_sptr fn;
 	bool has_spec = die_die_attribute(die, DW_AT_specification,
 					  spec_die, true);
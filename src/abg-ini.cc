@@ -10,11 +10,17 @@
 /// This file contains the definitions for the ini file reader used in
 /// the libabigail library.
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
 #include <utility>
 #include <memory>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 
 #include "abg-fwd.h"
@@ -168,6 +174,15 @@ static bool
 char_is_white_space(int b)
 {return b == ' ' || b == '\t' || b == '\n';}
 
+/// Test if a character is not the end of a line.
+///
+/// @param b the character to test against.
+///
+/// @return true iff @p b is not a new line character.
+static bool
+char_is_not_end_of_line(int b)
+{return b != '\n';}
+
 /// Remove the spaces at the begining and at the end of a given string.
 ///
 /// @param str the string to remove leading and trailing white spaces from.
@@ -863,10 +878,20 @@ config::section::~section()
 ///
 /// This is a private type that is used only in the internals of the
 /// ini file parsing.
+///
+/// The ini file is parsed from a buffer holding its whole content,
+/// usually a memory mapping of the file.  The names and values are
+/// copied from the buffer in one go, unless they contain escaped
+/// characters.
 class read_context
 {
-  /// The input stream we are parsing from.
-  istream& in_;
+  /// The next character to parse.
+  const char* cur_;
+  /// The end of the buffer we are parsing from.
+  const char* end_;
+  /// True iff there was an attempt to read past the end of the
+  /// buffer.
+  bool eof_;
   /// The current line being parsed.
   unsigned cur_line_;
   /// The current column on the current line.
@@ -876,13 +901,114 @@ class read_context
   // Forbid this;
   read_context();
 
+  /// Get the next character of the buffer, without handling escaped
+  /// characters.
+  ///
+  /// @return the next character of the buffer, as an unsigned char
+  /// so that a 0xFF byte is not mistaken for EOF, or EOF if the end
+  /// of the buffer was reached.
+  int
+  raw_get()
+  {
+    if (cur_ == end_)
+      {
+	eof_ = true;
+	return EOF;
+      }
+    return static_cast<unsigned char>(*cur_++);
+  }
+
+  /// Update the current line/column number after some characters
+  /// got read.
+  ///
+  /// @param c the character that got read.
+  void
+  update_position(char c)
+  {
+    if (cur_line_ == 0)
+      cur_line_ = 1;
+
+    if (c == '\n')
+      {
+	++cur_line_;
+	cur_column_ = 0;
+      }
+    else
+      ++cur_column_;
+  }
+
+  /// Skip the contiguous characters that satisfy a predicate and that
+  /// can be read straight from the buffer, that is, those that are
+  /// neither escaped nor put back.
+  ///
+  /// @param is_accepted the predicate the characters must satisfy.
+  ///
+  /// @return the beginning of the characters that got skipped.
+  const char*
+  skip_raw_chars(bool (*is_accepted)(int))
+  {
+    const char* start = cur_;
+    if (!buf_.empty())
+      return start;
+
+    for (; cur_ != end_ && *cur_ != '\\' && is_accepted(*cur_); ++cur_)
+      update_position(*cur_);
+
+    return start;
+  }
+
+  /// Read the contiguous characters that satisfy a predicate.
+  ///
+  /// @param is_accepted the predicate the characters must satisfy.
+  ///
+  /// @param accept_escaped_chars if true, escaped characters are read
+  /// even if they don't satisfy @p is_accepted.
+  ///
+  /// @param s output parameter.  The characters read are appended to
+  /// this.
+  ///
+  /// @return true iff at least one character was read.
+  bool
+  read_chars(bool (*is_accepted)(int),
+	     bool accept_escaped_chars,
+	     string& s)
+  {
+    bool read_some = false;
+    for (;;)
+      {
+	const char* start = skip_raw_chars(is_accepted);
+	if (cur_ != start)
+	  {
+	    s.append(start, cur_);
+	    read_some = true;
+	  }
+
+	// We reached either the end of the characters to read, an
+	// escaped character or a character that was put back.
+	bool escaped = false;
+	char c = peek(escaped);
+	if (!good()
+	    || !((accept_escaped_chars && escaped) || is_accepted(c)))
+	  break;
+	ABG_ASSERT(read_next_char(c));
+	s += c;
+	read_some = true;
+      }
+    return read_some;
+  }
+
 public:
 
   /// The constructor of @ref read_context.
   ///
-  /// @param in the input stream to parse from.
-  read_context(istream& in)
-    : in_(in),
+  /// @param buf the buffer to parse from.  It must outlive the
+  /// context.
+  ///
+  /// @param size the size of @p buf.
+  read_context(const char* buf, size_t size)
+    : cur_(buf),
+      end_(buf + size),
+      eof_(false),
       cur_line_(0),
       cur_column_(0)
   {}
@@ -904,10 +1030,18 @@ public:
   peek(bool& escaped)
   {
     if (!buf_.empty())
-      return buf_.back();
+      {
+	// Only escaped characters are put back.
+	escaped = true;
+	return buf_.back();
+      }
 
     escaped = false;
-    char c = in_.peek();
+    char c = EOF;
+    if (cur_ == end_)
+      eof_ = true;
+    else
+      c = *cur_;
     if (handle_escape(c, /*peek=*/true))
       {
 	put_back(c);
@@ -952,7 +1086,7 @@ public:
       }
     else
       {
-	result = in_.get();
+	result = raw_get();
 	if (do_handle_escape)
 	  handle_escape(result);
       }
@@ -970,13 +1104,16 @@ public:
 
   /// Test if the status of the input stream is good.
   ///
+  /// Just like for std::istream, the status remains good until there
+  /// is an attempt to read past the end of the input.
+  ///
   /// @return true iff the status of the input stream is good.
   bool
   good() const
   {
     if (!buf_.empty())
       return true;
-    return in_.good();
+    return !eof_;
   }
 
   /// Tests if the input stream has reached end of file.
@@ -987,7 +1124,7 @@ public:
   {
     if (!buf_.empty())
       return false;
-    return in_.eof();
+    return eof_;
   }
 
   /// Handles the escaping of a character.
@@ -1084,17 +1221,7 @@ public:
       return false;
 
     c = b;
-
-    if (cur_line_ == 0)
-      cur_line_ = 1;
-
-    if (b == '\n')
-      {
-	++cur_line_;
-	cur_column_ = 0;
-      }
-    else
-      ++cur_column_;
+    update_position(b);
 
     return true;
   }
@@ -1110,6 +1237,8 @@ public:
   bool
   skip_line()
   {
+    skip_raw_chars(char_is_not_end_of_line);
+
     char c = 0;
     for (bool is_ok = read_next_char(c);
 	 is_ok;
@@ -1127,6 +1256,8 @@ public:
   bool
   skip_white_spaces()
   {
+    skip_raw_chars(char_is_white_space);
+
     for (char c = peek(); good(); c = peek())
       if (char_is_white_space(c))
 	ABG_ASSERT(read_next_char(c));
@@ -1184,22 +1315,9 @@ public:
   bool
   read_property_name(string& name)
   {
-    char c = peek();
-    if (!good() || !char_is_property_name_char(c))
-      return false;
-
-    ABG_ASSERT(read_next_char(c));
-    name += c;
-
-    for (c = peek(); good(); c = peek())
-      {
-	if (!char_is_property_name_char(c))
-	  break;
-	ABG_ASSERT(read_next_char(c));
-	name += c;
-      }
-
-    return true;
+    return read_chars(char_is_property_name_char,
+		      /*accept_escaped_chars=*/false,
+		      name);
   }
 
   /// Read a function name.
@@ -1213,22 +1331,9 @@ public:
   bool
   read_function_name(string& name)
   {
-    char c = peek();
-    if (!good() || !char_is_function_name_char(c))
-      return false;
-
-    ABG_ASSERT(read_next_char(c));
-    name += c;
-
-    for (c = peek(); good(); c = peek())
-      {
-	if (!char_is_function_name_char(c))
-	  break;
-	ABG_ASSERT(read_next_char(c));
-	name += c;
-      }
-
-    return true;
+    return read_chars(char_is_function_name_char,
+		      /*accept_escaped_chars=*/false,
+		      name);
   }
 
   /// Read a function argument.
@@ -1241,22 +1346,9 @@ public:
   bool
   read_function_argument(string& argument)
   {
-    char c = peek();
-    if (!good() || !char_is_function_argument_char(c))
-      return false;
-
-    ABG_ASSERT(read_next_char(c));
-    argument += c;
-
-    for (c = peek(); good(); c = peek())
-      {
-	if (!char_is_function_argument_char(c))
-	  break;
-	ABG_ASSERT(read_next_char(c));
-	argument += c;
-      }
-
-    return true;
+    return read_chars(char_is_function_argument_char,
+		      /*accept_escaped_chars=*/false,
+		      argument);
   }
 
   /// Read a function call expression.
@@ -1382,18 +1474,13 @@ public:
       // Empty property value.  This is accepted.
       return "";
 
+    // If the current character is not suitable to be a in string,
+    // then we reached the end of the string.  Note that espaced
+    // characters are always suitable to be a string.
     string v;
-    for (b = peek(escaped); good(); b = peek(escaped))
-      {
-	// If the current character is not suitable to be a in string,
-	// then we reached the end of the string.  Note that espaced
-	// characters are always suitable to be a string.
-	if (!escaped && !char_is_property_value_char(b))
-	  break;
-	char c = 0;
-	ABG_ASSERT(read_next_char(c));
-	v += c;
-      }
+    read_chars(char_is_property_value_char,
+	       /*accept_escaped_chars=*/true,
+	       v);
     return trim_white_space(v);
   }
 
@@ -1505,23 +1592,9 @@ public:
   bool
   read_section_name(string& name)
   {
-    int b = peek();
-    if (!good() || !char_is_section_name_char(b))
-      return false;
-
-    char c = 0;
-    ABG_ASSERT(read_next_char(c) || char_is_section_name_char(b));
-    name += c;
-
-    for (b = peek(); good(); b = peek())
-      {
-	if (!char_is_section_name_char(b))
-	  break;
-	ABG_ASSERT(read_next_char(c));
-	name += c;
-      }
-
-    return true;
+    return read_chars(char_is_section_name_char,
+		      /*accept_escaped_chars=*/false,
+		      name);
   }
 
   /// Read a property (<name> = <value>).
@@ -1604,18 +1677,17 @@ public:
     if (!skip_white_spaces_or_comments())
       return nil;
 
-    config::properties_type properties;
+    // The properties are added to the section as they are read, rather
+    // than copied into it afterwards.
+    config::section_sptr section(new config::section(name));
     while (property_sptr prop = read_property())
       {
-	properties.push_back(prop);
+	section->add_property(prop);
 	skip_white_spaces_or_comments();
       }
 
-    if (!properties.empty())
-      {
-	config::section_sptr section(new config::section(name, properties));
-	return section;
-      }
+    if (!section->get_properties().empty())
+      return section;
 
     return nil;
   }
@@ -1687,8 +1759,35 @@ config::set_sections(const sections_type& sections)
 
 // <config reader stuff>
 
+/// Parse the sections of an *.ini file held in a buffer.
+///
+/// @param buf the buffer holding the content of the ini file.
+///
+/// @param size the size of @p buf.
+///
+/// @param section out parameter.  This is set to the vector of
+/// sections that have been parsed from the buffer.
+static void
+read_sections(const char* buf, size_t size,
+	      config::sections_type& sections)
+{
+  read_context ctxt(buf, size);
+
+  while (ctxt.good())
+    {
+      ctxt.skip_white_spaces_or_comments();
+      if (config::section_sptr section = ctxt.read_section())
+	sections.push_back(section);
+      else
+	break;
+    }
+}
+
 /// Parse the sections of an *.ini file.
 ///
+/// The content of the input stream is read in one go before being
+/// parsed.
+///
 /// @param input the input stream to parse the ini file from.
 ///
 /// @param section out parameter.  This is set to the vector of
@@ -1700,22 +1799,20 @@ bool
 read_sections(std::istream& input,
 	      config::sections_type& sections)
 {
-  read_context ctxt(input);
+  if (!input.good())
+    return input.eof();
 
-  while (input.good())
-    {
-      ctxt.skip_white_spaces_or_comments();
-      if (config::section_sptr section = ctxt.read_section())
-	sections.push_back(section);
-      else
-	break;
-    }
+  string content((std::istreambuf_iterator<char>(input)),
+		 std::istreambuf_iterator<char>());
+  read_sections(content.data(), content.size(), sections);
 
-  return input.good() || input.eof();
+  return !input.bad();
 }
 
 /// Parse the sections of an *.ini file.
 ///
+/// The file is memory-mapped, and parsed right from the mapping.
+///
 /// @param path the path of the ini file to parse.
 ///
 /// @param section out parameter.  This is set to the vector of
@@ -1727,14 +1824,43 @@ bool
 read_sections(const string& path,
 	      config::sections_type& sections)
 {
-  std::ifstream in(path.c_str(), std::ifstream::binary);
-  if (!in.good())
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
     return false;
 
-  bool is_ok = read_sections(in, sections);
-  in.close();
+  struct stat s;
+  if (fstat(fd, &s) != 0)
+    {
+      close(fd);
+      return false;
+    }
 
-  return is_ok;
+  if (S_ISDIR(s.st_mode))
+    {
+      close(fd);
+      return false;
+    }
+
+  if (!S_ISREG(s.st_mode) || s.st_size == 0)
+    {
+      // Not something we can map, e.g, a pipe.  Let's read it as a
+      // stream.
+      close(fd);
+      std::ifstream in(path.c_str(), std::ifstream::binary);
+      if (!in.good())
+	return false;
+      return read_sections(in, sections);
+    }
+
+  void* buf = mmap(0, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (buf == MAP_FAILED)
+    return false;
+
+  read_sections(static_cast<const char*>(buf), s.st_size, sections);
+  munmap(buf, s.st_size);
+
+  return true;
 }
 
 /// Parse an ini config file from an input stream.
@@ -2002,8 +2128,42 @@ vector<string>&
 function_call_expr::get_arguments()
 {return priv_->arguments_;}
 
+/// Read the characters of a function call expression from an input
+/// stream, up to the closing parenthesis of the call.
+///
+/// Comments are read up to the end of their line, so that a closing
+/// parenthesis in a comment doesn't end the expression.  The
+/// characters that follow the expression are left in the stream.
+///
+/// @param input the input stream to read from.
+///
+/// @param chars output parameter.  The characters read are appended
+/// to this.
+static void
+read_function_call_expr_chars(std::istream& input, string& chars)
+{
+  bool in_comment = false;
+  for (int b = input.get(); b != EOF; b = input.get())
+    {
+      char c = b;
+      chars += c;
+      if (in_comment)
+	{
+	  if (c == '\n')
+	    in_comment = false;
+	}
+      else if (char_is_comment_start(c))
+	in_comment = true;
+      else if (c == ')')
+	break;
+    }
+}
+
 /// Read a function call expression and build its representation.
 ///
+/// Only the characters of the expression are consumed from the
+/// stream; the characters that follow it are left there.
+///
 /// @param input the input stream where to read the function call
 /// expression from.
 ///
@@ -2016,8 +2176,9 @@ bool
 read_function_call_expr(std::istream& input,
 			function_call_expr_sptr& expr)
 {
-  read_context ctxt(input);
-  return ctxt.read_function_call_expr(expr);
+  string content;
+  read_function_call_expr_chars(input, content);
+  return read_function_call_expr(content, expr);
 }
 
 /// Read a function call expression and build its representation.
@@ -2034,8 +2195,8 @@ bool
 read_function_call_expr(const string& input,
 			function_call_expr_sptr& expr)
 {
-  std::istringstream in(input);
-  return read_function_call_expr(in, expr);
+  read_context ctxt(input.data(), input.size());
+  return ctxt.read_function_call_expr(expr);
 }
 
 /// Read a function call expression and build its representation.
@@ -260,9 +260,12 @@ hash_as_canonical_type_or_constant(const type_base *t);
 /// @brief the location of a token represented in its simplest form.
 /// Instances of this type are to be stored in a sorted vector, so the
 /// type must have proper relational operators.
+///
+/// The file path of the location is interned by the @ref
+/// location_manager, as many locations share the same file path.
 class expanded_location
 {
-  string	path_;
+  const string*	path_;
   unsigned	line_;
   unsigned	column_;
 
@@ -272,14 +275,14 @@ public:
 
   friend class location_manager;
 
-  expanded_location(const string& path, unsigned line, unsigned column)
+  expanded_location(const string* path, unsigned line, unsigned column)
   : path_(path), line_(line), column_(column)
   {}
 
   bool
   operator==(const expanded_location& l) const
   {
-    return (path_ == l.path_
+    return (*path_ == *l.path_
 	    && line_ == l.line_
 	    && column_ && l.column_);
   }
@@ -287,9 +290,9 @@ public:
   bool
   operator<(const expanded_location& l) const
   {
-    if (path_ < l.path_)
+    if (*path_ < *l.path_)
       return true;
-    else if (path_ > l.path_)
+    else if (*path_ > *l.path_)
       return false;
 
     if (line_ < l.line_)
@@ -334,6 +337,19 @@ location::expand(void) const
   return o.str();
 }
 
+/// Expand the location into its file path.
+///
+/// Unlike location::expand(), this doesn't copy the file path.
+///
+/// @return the file path of the location, or an empty string if the
+/// location is empty.
+const std::string&
+location::expand_path() const
+{
+  ABG_ASSERT(get_location_manager());
+  return get_location_manager()->expand_location_path(*this);
+}
+
 struct location_manager::priv
 {
   /// This sorted vector contains the expanded locations of the tokens
@@ -341,6 +357,13 @@ struct location_manager::priv
   /// location in the table gives us an integer that is used to build
   /// instance of location types.
   std::vector<expanded_location> locs;
+
+  /// The set of the file paths of the locations above.  Each file
+  /// path is stored once, however many locations refer to it.
+  unordered_set<string> paths;
+
+  /// The empty file path of empty locations.
+  string empty_path;
 };
 
 location_manager::location_manager()
@@ -359,7 +382,8 @@ location_manager::create_new_location(const std::string&	file_path,
 				      size_t			line,
 				      size_t			col)
 {
-  expanded_location l(file_path, line, col);
+  const string* path = &*priv_->paths.insert(file_path).first;
+  expanded_location l(path, line, col);
 
   // Just append the new expanded location to the end of the vector
   // and return its index.  Note that indexes start at 1.
@@ -386,11 +410,30 @@ location_manager::expand_location(const location&	location,
   if (location.value_ == 0)
     return;
   expanded_location &l = priv_->locs[location.value_ - 1];
-  path = l.path_;
+  path = *l.path_;
   line = l.line_;
   column = l.column_;
 }
 
+/// Given an instance of location type, return the file path of the
+/// source locus.
+///
+/// The returned string is owned by the current location manager.
+/// The same string is returned for all the locations of a given file
+/// path, so its address can be used to identify the file path.
+///
+/// @param location the instance of location type to consider.
+///
+/// @return the file path of the source locus, or an empty string if
+/// @p location is empty.
+const std::string&
+location_manager::expand_location_path(const location& location) const
+{
+  if (location.value_ == 0)
+    return priv_->empty_path;
+  return *priv_->locs[location.value_ - 1].path_;
+}
+
 typedef unordered_map<function_type_sptr,
 		      bool,
 		      function_type::hash,
@@ -0,0 +1,798 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2020 Red Hat, Inc.
+
+
+/// @file
+///
+/// This is the implementation of the
+/// abigail::comparison::json_reporter type.
+
+#include <unordered_set>
+#include "abg-comparison-priv.h"
+#include "abg-reporter.h"
+#include "abg-reporter-priv.h"
+#include "abg-tools-utils.h"
+
+namespace abigail
+{
+namespace comparison
+{
+
+/// Emit a JSON member whose value is a string.
+///
+/// @param name the name of the member.
+///
+/// @param value the value of the member.
+///
+/// @param out the output stream to emit the member to.
+static void
+emit_json_member(const char* name, const string& value, ostream& out)
+{
+  out << ",\"" << name << "\":";
+  tools_utils::emit_json_string(value, out);
+}
+
+/// Get the kind of a diff node, as emitted in the JSON records.
+///
+/// @param d the diff node to consider.
+///
+/// @return the kind of @p d.
+static const char*
+get_json_diff_kind(const diff* d)
+{
+  if (is_class_diff(d))
+    return "class";
+  if (is_union_diff(d))
+    return "union";
+  if (is_enum_diff(d))
+    return "enum";
+  if (is_typedef_diff(d))
+    return "typedef";
+  if (is_array_diff(d))
+    return "array";
+  if (is_pointer_diff(d))
+    return "pointer";
+  if (is_reference_diff(d))
+    return "reference";
+  if (is_qualified_type_diff(d))
+    return "qualified";
+  if (is_function_type_diff(d))
+    return "function-type";
+  if (is_distinct_diff(d))
+    return "distinct";
+  if (dynamic_cast<const type_decl_diff*>(d))
+    return "basic-type";
+  if (is_function_decl_diff(d))
+    return "function";
+  if (is_var_diff(d))
+    return "variable";
+  if (is_fn_parm_diff(d))
+    return "parameter";
+  if (is_base_diff(d))
+    return "base";
+  if (dynamic_cast<const translation_unit_diff*>(d))
+    return "translation-unit";
+  if (dynamic_cast<const scope_diff*>(d))
+    return "scope";
+  return "unknown";
+}
+
+/// Emit the record of a function or variable that got removed or
+/// added.
+///
+/// @param kind the kind of the record, that is "function" or
+/// "variable".
+///
+/// @param change the change carried by the record, that is "removed"
+/// or "added".
+///
+/// @param decl the function or variable to consider.
+///
+/// @param sym the ELF symbol of @p decl.  Can be nil.
+///
+/// @param out the output stream to emit the record to.
+static void
+emit_decl_record(const char* kind, const char* change,
+		 const decl_base& decl, const elf_symbol_sptr& sym,
+		 ostream& out)
+{
+  out << "{\"record\":\"" << kind << "\",\"change\":\"" << change << "\"";
+  emit_json_member("name", decl.get_pretty_representation(), out);
+  if (sym)
+    emit_json_member("symbol", sym->get_id_string(), out);
+  out << "}\n";
+}
+
+/// Emit the record of an ELF symbol, not referenced by debug info,
+/// that got removed or added.
+///
+/// @param kind the kind of the record, that is "function-symbol" or
+/// "variable-symbol".
+///
+/// @param change the change carried by the record, that is "removed"
+/// or "added".
+///
+/// @param sym the symbol to consider.
+///
+/// @param out the output stream to emit the record to.
+static void
+emit_symbol_record(const char* kind, const char* change,
+		   const elf_symbol& sym, ostream& out)
+{
+  out << "{\"record\":\"" << kind << "\",\"change\":\"" << change << "\"";
+  emit_json_member("symbol", sym.get_id_string(), out);
+  out << "}\n";
+}
+
+/// Emit the record of a type that got removed or added.
+///
+/// @param change the change carried by the record, that is "removed"
+/// or "added".
+///
+/// @param t the type to consider.
+///
+/// @param out the output stream to emit the record to.
+static void
+emit_type_record(const char* change, const type_base_sptr& t, ostream& out)
+{
+  out << "{\"record\":\"type\",\"change\":\"" << change << "\"";
+  emit_json_member("name", get_pretty_representation(t), out);
+  out << "}\n";
+}
+
+/// Emit the record of a changed type.
+///
+/// @param d the diff node of the changed type.
+///
+/// @param out the output stream to emit the record to.
+static void
+emit_changed_type_record(const diff& d, ostream& out)
+{
+  string first_name = d.first_subject()->get_pretty_representation();
+  string second_name = d.second_subject()->get_pretty_representation();
+
+  out << "{\"record\":\"type\",\"change\":\"changed\"";
+  emit_json_member("kind", get_json_diff_kind(&d), out);
+  emit_json_member("name", first_name, out);
+  if (second_name != first_name)
+    emit_json_member("new_name", second_name, out);
+
+  type_base_sptr f = is_type(d.first_subject()),
+    s = is_type(d.second_subject());
+  if (f && s && f->get_size_in_bits() != s->get_size_in_bits())
+    out << ",\"size_in_bits\":["
+	<< f->get_size_in_bits() << "," << s->get_size_in_bits() << "]";
+  out << "}\n";
+}
+
+/// A visitor that collects the type diff nodes carrying local
+/// changes that are to be reported, in a given diff sub-tree.
+///
+/// Only the canonical diff node of each class of equivalence is
+/// collected.
+struct json_leaf_type_collector : public diff_node_visitor
+{
+  vector<const diff*> types_;
+
+  virtual bool
+  visit(diff* d, bool pre)
+  {
+    if (pre
+	&& is_type_diff(d)
+	&& d->has_local_changes()
+	&& d->to_be_reported())
+      {
+	diff* canonical = d->get_canonical_diff();
+	types_.push_back(canonical ? canonical : d);
+      }
+    return true;
+  }
+}; // end struct json_leaf_type_collector
+
+/// Emit the records of a changed function or variable, as well as
+/// the records of the changed types that were not emitted yet.
+///
+/// @param d the diff node of the function or variable to consider.
+///
+/// @param emitted_types the set of changed types that were already
+/// emitted.  It's updated by this function.
+///
+/// @param out the output stream to emit the records to.
+static void
+emit_changed_decl_records(diff& d,
+			  std::unordered_set<const diff*>& emitted_types,
+			  ostream& out)
+{
+  json_leaf_type_collector v;
+  const diff_context_sptr& ctxt = d.context();
+  bool s = ctxt->visiting_a_node_twice_is_forbidden();
+  ctxt->forbid_visiting_a_node_twice(true);
+  ctxt->forget_visited_diffs();
+  d.traverse(v);
+  ctxt->forbid_visiting_a_node_twice(s);
+
+  // First emit the records of the types that are not known yet, so
+  // that the record of the declaration can refer to them.
+  for (vector<const diff*>::const_iterator i = v.types_.begin();
+       i != v.types_.end();
+       ++i)
+    if (emitted_types.insert(*i).second)
+      emit_changed_type_record(**i, out);
+
+  string first_name = d.first_subject()->get_pretty_representation();
+  string second_name = d.second_subject()->get_pretty_representation();
+
+  out << "{\"record\":\"" << get_json_diff_kind(&d)
+      << "\",\"change\":\"changed\"";
+  emit_json_member("name", first_name, out);
+  if (second_name != first_name)
+    emit_json_member("new_name", second_name, out);
+
+  elf_symbol_sptr sym;
+  if (const function_decl_diff* fn_diff = is_function_decl_diff(&d))
+    sym = fn_diff->first_function_decl()->get_symbol();
+  else if (const var_diff* v_diff = is_var_diff(&d))
+    sym = v_diff->first_var()->get_symbol();
+  if (sym)
+    emit_json_member("symbol", sym->get_id_string(), out);
+
+  out << ",\"local_changes\":"
+      << (d.has_local_changes() ? "true" : "false");
+
+  out << ",\"changed_types\":[";
+  for (vector<const diff*>::const_iterator i = v.types_.begin();
+       i != v.types_.end();
+       ++i)
+    {
+      if (i != v.types_.begin())
+	out << ",";
+      tools_utils::emit_json_string
+	((*i)->first_subject()->get_pretty_representation(), out);
+    }
+  out << "]}\n";
+}
+
+/// Emit the record of a diff node that is being reported on its own,
+/// rather than as part of a @ref corpus_diff.
+///
+/// Type diff nodes are emitted as "type" records, the other ones are
+/// emitted as records of changed declarations, along with the
+/// records of their changed sub-types.
+///
+/// @param d the diff node to report about.
+///
+/// @param out the output stream to emit the record(s) to.
+static void
+emit_diff_node_records(const diff& d, ostream& out)
+{
+  if (!d.to_be_reported())
+    return;
+
+  diff& n = const_cast<diff&>(d);
+  if (is_type_diff(&d))
+    emit_changed_type_record(d, out);
+  else if (dynamic_cast<const scope_diff*>(&d))
+    {
+      std::unordered_set<const diff*> emitted_types;
+      for (vector<diff*>::const_iterator i = d.children_nodes().begin();
+	   i != d.children_nodes().end();
+	   ++i)
+	if ((*i)->to_be_reported())
+	  {
+	    if (is_type_diff(*i))
+	      {
+		diff* canonical = (*i)->get_canonical_diff();
+		if (emitted_types.insert(canonical ? canonical : *i).second)
+		  emit_changed_type_record(**i, out);
+	      }
+	    else
+	      emit_changed_decl_records(**i, emitted_types, out);
+	  }
+    }
+  else
+    {
+      std::unordered_set<const diff*> emitted_types;
+      emit_changed_decl_records(n, emitted_types, out);
+    }
+}
+
+/// Test if a given instance of @ref corpus_diff carries changes whose
+/// reports are not suppressed by any suppression specification.  In
+/// effect, these are deemed incompatible ABI changes.
+///
+/// @param d the @ref corpus_diff to consider
+///
+/// @return true iff @p d carries subtype changes that are deemed
+/// incompatible ABI changes.
+bool
+json_reporter::diff_has_net_changes(const corpus_diff *d) const
+{
+  if (!d)
+    return false;
+
+  const corpus_diff::diff_stats& stats = const_cast<corpus_diff*>(d)->
+    apply_filters_and_suppressions_before_reporting();
+
+  return (d->architecture_changed()
+	  || d->soname_changed()
+	  || stats.net_num_func_removed()
+	  || stats.net_num_func_changed()
+	  || stats.net_num_func_added()
+	  || stats.net_num_vars_removed()
+	  || stats.net_num_vars_changed()
+	  || stats.net_num_vars_added()
+	  || stats.net_num_removed_unreachable_types()
+	  || stats.net_num_changed_unreachable_types()
+	  || stats.net_num_added_unreachable_types()
+	  || stats.net_num_removed_func_syms()
+	  || stats.net_num_added_func_syms()
+	  || stats.net_num_removed_var_syms()
+	  || stats.net_num_added_var_syms());
+}
+
+/// Report the changes carried by a @ref type_decl_diff node as a JSON
+/// record.
+///
+/// @param d the @ref type_decl_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const type_decl_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref enum_diff node as a JSON
+/// record.
+///
+/// @param d the @ref enum_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const enum_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref typedef_diff node as a JSON
+/// record.
+///
+/// @param d the @ref typedef_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const typedef_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref qualified_type_diff node as a
+/// JSON record.
+///
+/// @param d the @ref qualified_type_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const qualified_type_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref distinct_diff node as a JSON
+/// record.
+///
+/// @param d the @ref distinct_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const distinct_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref pointer_diff node as a JSON
+/// record.
+///
+/// @param d the @ref pointer_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const pointer_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref reference_diff node as a JSON
+/// record.
+///
+/// @param d the @ref reference_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const reference_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref array_diff node as a JSON
+/// record.
+///
+/// @param d the @ref array_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const array_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref base_diff node as JSON
+/// records.
+///
+/// @param d the @ref base_diff node to consider.
+///
+/// @param out the output stream to emit the records to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const base_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref class_or_union_diff node as a
+/// JSON record.
+///
+/// @param d the @ref class_or_union_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const class_or_union_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref class_diff node as a JSON
+/// record.
+///
+/// @param d the @ref class_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const class_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref union_diff node as a JSON
+/// record.
+///
+/// @param d the @ref union_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const union_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref scope_diff node as JSON
+/// records; one per changed member of the scope.
+///
+/// @param d the @ref scope_diff node to consider.
+///
+/// @param out the output stream to emit the records to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const scope_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref fn_parm_diff node as JSON
+/// records.
+///
+/// @param d the @ref fn_parm_diff node to consider.
+///
+/// @param out the output stream to emit the records to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const fn_parm_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref function_type_diff node as a
+/// JSON record.
+///
+/// @param d the @ref function_type_diff node to consider.
+///
+/// @param out the output stream to emit the record to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const function_type_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref function_decl_diff node as
+/// JSON records.
+///
+/// @param d the @ref function_decl_diff node to consider.
+///
+/// @param out the output stream to emit the records to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const function_decl_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref var_diff node as JSON
+/// records.
+///
+/// @param d the @ref var_diff node to consider.
+///
+/// @param out the output stream to emit the records to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const var_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref translation_unit_diff node as
+/// JSON records; one per changed member of the translation unit.
+///
+/// @param d the @ref translation_unit_diff node to consider.
+///
+/// @param out the output stream to emit the records to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const translation_unit_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{emit_diff_node_records(d, out);}
+
+/// Report the changes carried by a @ref corpus_diff node as a stream
+/// of JSON records, one per line.
+///
+/// The first record summarizes the changes and names the two
+/// corpora, by the base names of their paths.  Then comes one record
+/// per removed, added or changed function, variable, symbol or type.
+/// The record of a changed type is emitted once, before the record
+/// of the first changed function or variable it impacts.  Each
+/// record is written to @p out as soon as it's built.
+///
+/// @param d the @ref corpus_diff node to consider.
+///
+/// @param out the output stream to emit the records to.
+///
+/// @param indent this is ignored.
+void
+json_reporter::report(const corpus_diff& d, ostream& out,
+		      const string& /*indent*/) const
+{
+  const corpus_diff::diff_stats &s =
+    const_cast<corpus_diff&>(d).
+    apply_filters_and_suppressions_before_reporting();
+
+  const diff_context_sptr& ctxt = d.context();
+
+  out << "{\"record\":\"summary\"";
+  string name;
+  if (!d.first_corpus()->get_path().empty()
+      && tools_utils::base_name(d.first_corpus()->get_path(), name))
+    emit_json_member("first", name, out);
+  if (!d.second_corpus()->get_path().empty()
+      && tools_utils::base_name(d.second_corpus()->get_path(), name))
+    emit_json_member("second", name, out);
+  out << ",\"functions\":{\"removed\":" << s.net_num_func_removed()
+      << ",\"changed\":" << s.net_num_func_changed()
+      << ",\"added\":" << s.net_num_func_added() << "}"
+      << ",\"variables\":{\"removed\":" << s.net_num_vars_removed()
+      << ",\"changed\":" << s.net_num_vars_changed()
+      << ",\"added\":" << s.net_num_vars_added() << "}"
+      << ",\"function_symbols\":{\"removed\":" << s.net_num_removed_func_syms()
+      << ",\"added\":" << s.net_num_added_func_syms() << "}"
+      << ",\"variable_symbols\":{\"removed\":" << s.net_num_removed_var_syms()
+      << ",\"added\":" << s.net_num_added_var_syms() << "}"
+      << ",\"unreachable_types\":{\"removed\":"
+      << s.net_num_removed_unreachable_types()
+      << ",\"changed\":" << s.net_num_changed_unreachable_types()
+      << ",\"added\":" << s.net_num_added_unreachable_types() << "}"
+      << "}\n";
+
+  if (ctxt->show_stats_only())
+    return;
+
+  if (ctxt->show_soname_change() && !d.priv_->sonames_equal_)
+    {
+      out << "{\"record\":\"soname\",\"change\":\"changed\"";
+      emit_json_member("name", d.first_corpus()->get_soname(), out);
+      emit_json_member("new_name", d.second_corpus()->get_soname(), out);
+      out << "}\n";
+    }
+
+  if (ctxt->show_architecture_change() && !d.priv_->architectures_equal_)
+    {
+      out << "{\"record\":\"architecture\",\"change\":\"changed\"";
+      emit_json_member("name",
+		       d.first_corpus()->get_architecture_name(), out);
+      emit_json_member("new_name",
+		       d.second_corpus()->get_architecture_name(), out);
+      out << "}\n";
+    }
+
+  if (ctxt->show_deleted_fns())
+    {
+      vector<function_decl*> sorted_deleted_fns;
+      sort_string_function_ptr_map(d.priv_->deleted_fns_, sorted_deleted_fns);
+      for (vector<function_decl*>::const_iterator i =
+	     sorted_deleted_fns.begin();
+	   i != sorted_deleted_fns.end();
+	   ++i)
+	if (!d.priv_->deleted_function_is_suppressed(*i))
+	  emit_decl_record("function", "removed", **i,
+			   (*i)->get_symbol(), out);
+    }
+
+  if (ctxt->show_added_fns())
+    {
+      vector<function_decl*> sorted_added_fns;
+      sort_string_function_ptr_map(d.priv_->added_fns_, sorted_added_fns);
+      for (vector<function_decl*>::const_iterator i = sorted_added_fns.begin();
+	   i != sorted_added_fns.end();
+	   ++i)
+	if (!d.priv_->added_function_is_suppressed(*i))
+	  emit_decl_record("function", "added", **i,
+			   (*i)->get_symbol(), out);
+    }
+
+  // The set of changed types which records were emitted already.
+  std::unordered_set<const diff*> emitted_types;
+
+  if (ctxt->show_changed_fns())
+    {
+      vector<function_decl_diff_sptr> sorted_changed_fns;
+      sort_string_function_decl_diff_sptr_map(d.priv_->changed_fns_map_,
+					      sorted_changed_fns);
+      for (vector<function_decl_diff_sptr>::const_iterator i =
+	     sorted_changed_fns.begin();
+	   i != sorted_changed_fns.end();
+	   ++i)
+	if (*i && (*i)->to_be_reported())
+	  emit_changed_decl_records(**i, emitted_types, out);
+    }
+
+  if (ctxt->show_deleted_vars())
+    {
+      vector<var_decl*> sorted_deleted_vars;
+      sort_string_var_ptr_map(d.priv_->deleted_vars_, sorted_deleted_vars);
+      for (vector<var_decl*>::const_iterator i =
+	     sorted_deleted_vars.begin();
+	   i != sorted_deleted_vars.end();
+	   ++i)
+	if (!d.priv_->deleted_variable_is_suppressed(*i))
+	  emit_decl_record("variable", "removed", **i,
+			   (*i)->get_symbol(), out);
+    }
+
+  if (ctxt->show_added_vars())
+    {
+      vector<var_decl*> sorted_added_vars;
+      sort_string_var_ptr_map(d.priv_->added_vars_, sorted_added_vars);
+      for (vector<var_decl*>::const_iterator i = sorted_added_vars.begin();
+	   i != sorted_added_vars.end();
+	   ++i)
+	if (!d.priv_->added_variable_is_suppressed(*i))
+	  emit_decl_record("variable", "added", **i,
+			   (*i)->get_symbol(), out);
+    }
+
+  if (ctxt->show_changed_vars())
+    {
+      for (var_diff_sptrs_type::const_iterator i =
+	     d.priv_->sorted_changed_vars_.begin();
+	   i != d.priv_->sorted_changed_vars_.end();
+	   ++i)
+	if (*i && (*i)->to_be_reported())
+	  emit_changed_decl_records(**i, emitted_types, out);
+    }
+
+  if (ctxt->show_symbols_unreferenced_by_debug_info())
+    {
+      vector<elf_symbol_sptr> sorted_syms;
+      sort_string_elf_symbol_map(d.priv_->deleted_unrefed_fn_syms_,
+				 sorted_syms);
+      for (vector<elf_symbol_sptr>::const_iterator i = sorted_syms.begin();
+	   i != sorted_syms.end();
+	   ++i)
+	if (!d.priv_->deleted_unrefed_fn_sym_is_suppressed((*i).get()))
+	  emit_symbol_record("function-symbol", "removed", **i, out);
+
+      if (ctxt->show_added_symbols_unreferenced_by_debug_info())
+	{
+	  sorted_syms.clear();
+	  sort_string_elf_symbol_map(d.priv_->added_unrefed_fn_syms_,
+				     sorted_syms);
+	  for (vector<elf_symbol_sptr>::const_iterator i = sorted_syms.begin();
+	       i != sorted_syms.end();
+	       ++i)
+	    if (!d.priv_->added_unrefed_fn_sym_is_suppressed((*i).get()))
+	      emit_symbol_record("function-symbol", "added", **i, out);
+	}
+
+      sorted_syms.clear();
+      sort_string_elf_symbol_map(d.priv_->deleted_unrefed_var_syms_,
+				 sorted_syms);
+      for (vector<elf_symbol_sptr>::const_iterator i = sorted_syms.begin();
+	   i != sorted_syms.end();
+	   ++i)
+	if (!d.priv_->deleted_unrefed_var_sym_is_suppressed((*i).get()))
+	  emit_symbol_record("variable-symbol", "removed", **i, out);
+
+      if (ctxt->show_added_symbols_unreferenced_by_debug_info())
+	{
+	  sorted_syms.clear();
+	  sort_string_elf_symbol_map(d.priv_->added_unrefed_var_syms_,
+				     sorted_syms);
+	  for (vector<elf_symbol_sptr>::const_iterator i = sorted_syms.begin();
+	       i != sorted_syms.end();
+	       ++i)
+	    if (!d.priv_->added_unrefed_var_sym_is_suppressed((*i).get()))
+	      emit_symbol_record("variable-symbol", "added", **i, out);
+	}
+    }
+
+  if (ctxt->show_unreachable_types())
+    {
+      vector<type_base_sptr> sorted_types;
+      sort_string_type_base_sptr_map(d.priv_->deleted_unreachable_types_,
+				     sorted_types);
+      for (vector<type_base_sptr>::const_iterator i = sorted_types.begin();
+	   i != sorted_types.end();
+	   ++i)
+	if (!d.priv_->deleted_unreachable_type_is_suppressed((*i).get()))
+	  emit_type_record("removed", *i, out);
+
+      diff_sptrs_type sorted_diffs;
+      sort_string_diff_sptr_map(d.priv_->changed_unreachable_types_,
+				sorted_diffs);
+      for (diff_sptrs_type::const_iterator i = sorted_diffs.begin();
+	   i != sorted_diffs.end();
+	   ++i)
+	if (*i && (*i)->to_be_reported())
+	  {
+	    diff* canonical = (*i)->get_canonical_diff();
+	    if (emitted_types.insert(canonical ? canonical : i->get()).second)
+	      emit_changed_type_record(**i, out);
+	  }
+
+      sorted_types.clear();
+      sort_string_type_base_sptr_map(d.priv_->added_unreachable_types_,
+				     sorted_types);
+      for (vector<type_base_sptr>::const_iterator i = sorted_types.begin();
+	   i != sorted_types.end();
+	   ++i)
+	if (!d.priv_->added_unreachable_type_is_suppressed((*i).get()))
+	  emit_type_record("added", *i, out);
+    }
+
+  d.priv_->maybe_dump_diff_tree();
+}
+
+} // end namespace comparison
+} // end namespace abigail
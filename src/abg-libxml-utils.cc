@@ -5,14 +5,21 @@
 
 /// @file
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <string>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
+#include <zlib.h>
 
 #include "abg-internal.h"
 // <headers defining libabigail's API go under here>
 ABG_BEGIN_EXPORT_DECLARATIONS
 
 #include "abg-libxml-utils.h"
+#include "abg-tools-utils.h"
 
 ABG_END_EXPORT_DECLARATIONS
 // </headers defining libabigail's API>
@@ -44,16 +51,67 @@ namespace xml
 {
 using std::istream;
 
+/// This is an xmlInputReadCallback, meant to be passed to
+/// xmlReaderForIO.  It reads a number of bytes from a gzip-compressed
+/// file and decompresses them.
+///
+/// @param context the gzFile to read from, cast into a void*.
+///
+/// @param buffer the buffer where to copy the decompressed data.
+///
+/// @param len the number of decompressed bytes to copy into @p
+/// buffer.
+///
+/// @return the number of bytes copied or -1 in case of error.
+static int
+xml_gzfile_input_read(void*	context,
+		      char*	buffer,
+		      int	len)
+{
+  gzFile f = static_cast<gzFile>(context);
+  return gzread(f, buffer, len);
+}
+
+/// This is an xmlInputCloseCallback, meant to be passed to
+/// xmlReaderForIO.  It closes the gzip-compressed file the
+/// xmlTextReader is reading from.
+///
+/// @param context the gzFile to close, cast into a void*.
+///
+/// @return 0 upon successful completion, -1 otherwise.
+static int
+xml_gzfile_input_close(void* context)
+{
+  gzFile f = static_cast<gzFile>(context);
+  return gzclose(f) == Z_OK ? 0 : -1;
+}
+
 /// Instantiate an xmlTextReader that parses the content of an on-disk
 /// file, wrap it into a smart pointer and return it.
 ///
+/// If the file is compressed in the gzip format, it's decompressed on
+/// the fly, as the xmlTextReader parses it.
+///
 /// @param path the path to the file to be parsed by the returned
 /// instance of xmlTextReader.
 reader_sptr
 new_reader_from_file(const std::string& path)
 {
+  if (tools_utils::file_is_compressed(path))
+    {
+      gzFile f = gzopen(path.c_str(), "rb");
+      if (!f)
+	return reader_sptr();
+      gzbuffer(f, 128 * 1024);
+      // The reader closes the file, even if it fails to be created.
+      return build_sptr(xmlReaderForIO(&xml_gzfile_input_read,
+				       &xml_gzfile_input_close,
+				       f, path.c_str(), 0,
+				       XML_PARSE_COMPACT));
+    }
+
   reader_sptr p =
-    build_sptr(xmlNewTextReaderFilename (path.c_str()));
+    build_sptr(xmlReaderForFile(path.c_str(), 0, XML_PARSE_COMPACT));
 
   return p;
 }
@@ -69,7 +127,7 @@ new_reader_from_buffer(const std::string& buffer)
   reader_sptr p =
     build_sptr(xmlReaderForMemory(buffer.c_str(),
 				  buffer.length(),
-				  "", 0, 0));
+				  "", 0, XML_PARSE_COMPACT));
   return p;
 }
 
@@ -119,7 +177,7 @@ new_reader_from_istream(std::istream* in)
   reader_sptr p =
     build_sptr(xmlReaderForIO(&xml_istream_input_read,
 			      &xml_istream_input_close,
-			      in, "", 0, 0));
+			      in, "", 0, XML_PARSE_COMPACT));
   return p;
 }
 
@@ -433,6 +491,37 @@ go_to_next_sibling_element_or_stay(xmlNodePtr node)
   return n ? n : node;
 }
 
+/// Get the value of an attribute of an XML element node.
+///
+/// Unlike xmlGetProp(), this doesn't copy the value of the attribute
+/// when it's held by a single text node, which is the common case.
+/// The returned pointer then points into the tree of @p node and is
+/// valid as long as @p node is.
+///
+/// @param node the element node to consider.
+///
+/// @param name the name of the attribute to get.
+///
+/// @return the value of the attribute or nil if @p node has no
+/// attribute named @p name.
+xml_char_sptr
+get_node_attribute(xmlNodePtr node, const xmlChar* name)
+{
+  xmlAttrPtr a = xmlHasProp(node, name);
+  if (!a)
+    return xml_char_sptr();
+
+  if (a->type == XML_ATTRIBUTE_NODE
+      && a->children
+      && a->children->next == 0
+      && a->children->type == XML_TEXT_NODE
+      && a->children->content)
+    // Share the value held by the tree, without owning it.
+    return xml_char_sptr(xml_char_sptr(), a->children->content);
+
+  return build_sptr(xmlGetProp(node, name));
+}
+
 /// Get the next sibling element node of an XML node.
 ///
 /// If there is no next sibling xml element node, the function returns nil.
@@ -449,5 +538,395 @@ advance_to_next_sibling_element(xmlNodePtr node)
   return n;
 }
 
+// <binary tree format>
+//
+// A binary tree is a compact encoding of a tree of XML elements and
+// of their attributes, meant to be decoded faster than the XML text
+// it comes from.  Text, comment and other non-element nodes are not
+// encoded.  All the integers are unsigned LEB128 numbers.
+//
+// Note that this is an encoding of the XML tree, not of the IR: there
+// are no tables of types, declarations or symbols, and decoding it
+// yields an XML tree that is then read like an ABIXML one.  What it
+// saves is the tokenizing of the XML text and the allocation of a
+// copy of each string for each node.
+//
+//   magic       the 8 bytes of binary_tree_magic.
+//   version     the version of the format, binary_tree_version.
+//   strings     the number of strings, then each string as its length,
+//               its bytes and a terminating NUL byte.
+//   root        the root element.
+//
+// An element is encoded as the index of its name in the strings, the
+// number of its attributes, the index of the name then of the value
+// of each attribute in the strings, the number of its children
+// elements, then each of these children elements.
+
+/// The magic number that starts a binary tree.
+static const char binary_tree_magic[8] =
+  {0x7f, 'a', 'b', 'i', 'b', 'i', 'n', 0};
+
+/// The version of the binary tree format.
+static const size_t binary_tree_version = 1;
+
+/// Test if a buffer starts like a binary tree.
+///
+/// @param buf the buffer to consider.
+///
+/// @param size the size of @p buf.
+///
+/// @return true iff @p buf starts with the magic number of binary
+/// trees.
+bool
+is_binary_tree(const char* buf, size_t size)
+{
+  return (size >= sizeof(binary_tree_magic)
+	  && memcmp(buf, binary_tree_magic, sizeof(binary_tree_magic)) == 0);
+}
+
+/// Emit an unsigned LEB128 number.
+///
+/// @param n the number to emit.
+///
+/// @param out the output stream to emit @p n to.
+static void
+write_uleb128(size_t n, std::ostream& out)
+{
+  do
+    {
+      unsigned char byte = n & 0x7f;
+      n >>= 7;
+      if (n)
+	byte |= 0x80;
+      out.put(byte);
+    }
+  while (n);
+}
+
+/// A table of the strings of a binary tree being written.
+///
+/// Each string is designated by its index in the table.
+struct binary_tree_strings
+{
+  std::unordered_map<std::string, size_t> index;
+  std::vector<const std::string*> strings;
+
+  /// Get the index of a string, adding the string to the table if
+  /// needed.
+  ///
+  /// @param s the string to consider.
+  ///
+  /// @return the index of @p s.
+  size_t
+  get_index(const std::string& s)
+  {
+    std::pair<std::unordered_map<std::string, size_t>::iterator, bool> r =
+      index.insert(std::make_pair(s, strings.size()));
+    if (r.second)
+      strings.push_back(&r.first->first);
+    return r.first->second;
+  }
+}; // end struct binary_tree_strings
+
+/// Get the value of an attribute of an XML element node.
+///
+/// @param a the attribute to consider.
+///
+/// @return the value of @p a.
+static std::string
+get_attribute_value(xmlAttrPtr a)
+{
+  xml_char_sptr v = build_sptr(xmlNodeListGetString(a->doc, a->children, 1));
+  std::string result;
+  xml_char_sptr_to_string(v, result);
+  return result;
+}
+
+/// Add the names and the attribute values of an XML element and of
+/// its descendant elements to the strings of a binary tree.
+///
+/// @param node the element node to consider.
+///
+/// @param strings the table of strings to add the strings to.
+static void
+collect_binary_tree_strings(xmlNodePtr node, binary_tree_strings& strings)
+{
+  strings.get_index(reinterpret_cast<const char*>(node->name));
+  for (xmlAttrPtr a = node->properties; a; a = a->next)
+    {
+      strings.get_index(reinterpret_cast<const char*>(a->name));
+      strings.get_index(get_attribute_value(a));
+    }
+  for (xmlNodePtr n = node->children; n; n = n->next)
+    if (n->type == XML_ELEMENT_NODE)
+      collect_binary_tree_strings(n, strings);
+}
+
+/// Emit an XML element and its descendant elements in the binary
+/// tree format.
+///
+/// @param node the element node to emit.
+///
+/// @param strings the table of strings of the binary tree.
+///
+/// @param out the output stream to emit to.
+static void
+write_binary_tree_element(xmlNodePtr node,
+			  binary_tree_strings& strings,
+			  std::ostream& out)
+{
+  write_uleb128(strings.get_index(reinterpret_cast<const char*>(node->name)),
+		out);
+
+  size_t nb_attributes = 0;
+  for (xmlAttrPtr a = node->properties; a; a = a->next)
+    ++nb_attributes;
+  write_uleb128(nb_attributes, out);
+  for (xmlAttrPtr a = node->properties; a; a = a->next)
+    {
+      write_uleb128(strings.get_index(reinterpret_cast<const char*>(a->name)),
+		    out);
+      write_uleb128(strings.get_index(get_attribute_value(a)), out);
+    }
+
+  size_t nb_children = 0;
+  for (xmlNodePtr n = node->children; n; n = n->next)
+    if (n->type == XML_ELEMENT_NODE)
+      ++nb_children;
+  write_uleb128(nb_children, out);
+  for (xmlNodePtr n = node->children; n; n = n->next)
+    if (n->type == XML_ELEMENT_NODE)
+      write_binary_tree_element(n, strings, out);
+}
+
+/// Emit a tree of XML elements in the binary tree format.
+///
+/// @param root the root element of the tree to emit.
+///
+/// @param out the output stream to emit to.
+///
+/// @return true upon successful completion.
+bool
+write_binary_tree(xmlNodePtr root, std::ostream& out)
+{
+  if (!root || root->type != XML_ELEMENT_NODE)
+    return false;
+
+  binary_tree_strings strings;
+  collect_binary_tree_strings(root, strings);
+
+  out.write(binary_tree_magic, sizeof(binary_tree_magic));
+  write_uleb128(binary_tree_version, out);
+  write_uleb128(strings.strings.size(), out);
+  for (std::vector<const std::string*>::const_iterator i =
+	 strings.strings.begin();
+       i != strings.strings.end();
+       ++i)
+    {
+      write_uleb128((*i)->size(), out);
+      out.write((*i)->c_str(), (*i)->size() + 1);
+    }
+  write_binary_tree_element(root, strings, out);
+
+  return out.good();
+}
+
+/// The state of the decoding of a binary tree.
+struct binary_tree_decoder
+{
+  const char*			cur;
+  const char*			end;
+  std::vector<const xmlChar*>	strings;
+  const xmlChar*		blank;
+  xmlDocPtr			doc;
+
+  binary_tree_decoder(const char* buf, size_t size)
+    : cur(buf), end(buf + size), blank(), doc()
+  {}
+
+  /// Decode an unsigned LEB128 number.
+  ///
+  /// @param n output parameter.  The decoded number.
+  ///
+  /// @return true iff the number could be decoded.
+  bool
+  read_uleb128(size_t& n)
+  {
+    n = 0;
+    for (unsigned shift = 0; cur < end && shift < 64; shift += 7)
+      {
+	unsigned char byte = *cur++;
+	n |= static_cast<size_t>(byte & 0x7f) << shift;
+	if (!(byte & 0x80))
+	  return true;
+      }
+    return false;
+  }
+
+  /// Decode the index of a string and get the string.
+  ///
+  /// @param s output parameter.  The string.
+  ///
+  /// @return true iff the string could be decoded.
+  bool
+  read_string(const xmlChar*& s)
+  {
+    size_t i = 0;
+    if (!read_uleb128(i) || i >= strings.size())
+      return false;
+    s = strings[i];
+    return true;
+  }
+
+  /// Decode the table of strings.
+  ///
+  /// The strings are interned in the dictionary of the document being
+  /// decoded, once and for all.  The names of the elements and
+  /// attributes, and the values of the attributes, then point into
+  /// that dictionary rather than being copied for each node.
+  ///
+  /// @return true iff the table could be decoded.
+  bool
+  read_strings()
+  {
+    size_t nb_strings = 0;
+    if (!read_uleb128(nb_strings))
+      return false;
+    strings.reserve(std::min(nb_strings, static_cast<size_t>(end - cur)));
+    for (size_t i = 0; i < nb_strings; ++i)
+      {
+	size_t len = 0;
+	if (!read_uleb128(len)
+	    || len >= static_cast<size_t>(end - cur)
+	    || len > INT_MAX
+	    || cur[len] != 0)
+	  return false;
+	const xmlChar* s =
+	  xmlDictLookup(doc->dict, reinterpret_cast<const xmlChar*>(cur), len);
+	if (!s)
+	  return false;
+	strings.push_back(s);
+	cur += len + 1;
+      }
+    blank = xmlDictLookup(doc->dict, BAD_CAST("\n"), 1);
+    return blank;
+  }
+
+  /// Create a text node which content is a string of the dictionary
+  /// of the document being decoded.
+  ///
+  /// The content is not copied.  As it's owned by the dictionary, it
+  /// is not freed with the node.
+  ///
+  /// @param content the content of the node.
+  ///
+  /// @return the new text node.
+  xmlNodePtr
+  new_text(const xmlChar* content)
+  {
+    xmlNodePtr text = xmlNewDocText(doc, 0);
+    text->content = const_cast<xmlChar*>(content);
+    return text;
+  }
+
+  /// Decode an element and its descendant elements.
+  ///
+  /// Elements that have children elements get a leading blank text
+  /// node, like the ones of the indented XML text the tree comes
+  /// from.
+  ///
+  /// @return the decoded element or nil if the element could not be
+  /// decoded.
+  xmlNodePtr
+  read_element()
+  {
+    const xmlChar* name = 0;
+    size_t nb_attributes = 0;
+    if (!read_string(name) || !read_uleb128(nb_attributes))
+      return 0;
+
+    xmlNodePtr node = xmlNewDocNode(doc, 0, name, 0);
+    for (size_t i = 0; i < nb_attributes; ++i)
+      {
+	const xmlChar *attr_name = 0, *value = 0;
+	if (!read_string(attr_name) || !read_string(value))
+	  {
+	    xmlFreeNode(node);
+	    return 0;
+	  }
+	xmlAttrPtr attr = xmlNewProp(node, attr_name, 0);
+	xmlNodePtr text = new_text(value);
+	attr->children = attr->last = text;
+	text->parent = reinterpret_cast<xmlNodePtr>(attr);
+      }
+
+    size_t nb_children = 0;
+    if (!read_uleb128(nb_children))
+      {
+	xmlFreeNode(node);
+	return 0;
+      }
+    if (nb_children)
+      xmlAddChild(node, new_text(blank));
+    for (size_t i = 0; i < nb_children; ++i)
+      {
+	xmlNodePtr child = read_element();
+	if (!child)
+	  {
+	    xmlFreeNode(node);
+	    return 0;
+	  }
+	xmlAddChild(node, child);
+      }
+    return node;
+  }
+}; // end struct binary_tree_decoder
+
+/// Decode a tree of XML elements from the binary tree format.
+///
+/// @param buf the buffer containing the binary tree.
+///
+/// @param size the size of @p buf.
+///
+/// @return the resulting XML document, or nil if @p buf doesn't
+/// contain a valid binary tree.  The caller owns the document.
+xmlDocPtr
+read_binary_tree(const char* buf, size_t size)
+{
+  if (!is_binary_tree(buf, size))
+    return 0;
+
+  binary_tree_decoder decoder(buf + sizeof(binary_tree_magic),
+			      size - sizeof(binary_tree_magic));
+  size_t version = 0;
+  if (!decoder.read_uleb128(version)
+      || version != binary_tree_version)
+    return 0;
+
+  decoder.doc = xmlNewDoc(BAD_CAST("1.0"));
+  // The strings of the tree are interned in the dictionary of the
+  // document rather than being copied for each node.
+  decoder.doc->dict = xmlDictCreate();
+  if (!decoder.read_strings())
+    {
+      xmlFreeDoc(decoder.doc);
+      return 0;
+    }
+
+  xmlNodePtr root = decoder.read_element();
+  if (!root || decoder.cur != decoder.end)
+    {
+      if (root)
+	xmlFreeNode(root);
+      xmlFreeDoc(decoder.doc);
+      return 0;
+    }
+  xmlDocSetRootElement(decoder.doc, root);
+
+  return decoder.doc;
+}
+
+// </binary tree format>
+
 }//end namespace xml
 }//end namespace abigail
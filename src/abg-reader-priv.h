@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2013-2020 Red Hat, Inc.
+//
+// Author: Dodji Seketeli
+
+/// @file
+///
+/// This file contains the declarations of the entry points to read
+/// an abixml corpus file lazily, through an index.
+///
+/// These are not part of the installed API yet, as no tool uses them.
+
+#ifndef __ABG_READER_PRIV_H__
+#define __ABG_READER_PRIV_H__
+
+#include "abg-reader.h"
+
+namespace abigail
+{
+
+namespace xml_reader
+{
+
+corpus_sptr
+read_indexed_corpus_from_input(read_context& ctxt);
+
+function_decl_sptr
+lookup_function_from_index(read_context& ctxt, const string& symbol_id);
+
+var_decl_sptr
+lookup_variable_from_index(read_context& ctxt, const string& symbol_id);
+
+type_base_sptr
+lookup_type_from_index(read_context& ctxt, const string& type_id);
+
+}//end xml_reader
+}//end namespace abigail
+
+#endif // __ABG_READER_PRIV_H__
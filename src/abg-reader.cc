@@ -12,12 +12,21 @@
 
 #include "config.h"
 #include <assert.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <libxml/parser.h>
 #include <libxml/xmlreader.h>
 #include <libxml/xmlstring.h>
+#include <algorithm>
+#include <cctype>
 #include <cerrno>
+#include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <deque>
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <unordered_map>
@@ -32,7 +41,9 @@ ABG_BEGIN_EXPORT_DECLARATIONS
 
 #include "abg-libxml-utils.h"
 #include "abg-reader.h"
+#include "abg-reader-priv.h"
 #include "abg-corpus.h"
+#include "abg-workers.h"
 
 #ifdef WITH_ZIP_ARCHIVE
 #include "abg-libzip-utils.h"
@@ -70,6 +81,152 @@ static bool	read_is_non_reachable_type(xmlNodePtr, bool&);
 
 class read_context;
 
+struct corpus_index;
+
+/// A convenience typedef for a shared pointer to @ref corpus_index.
+typedef shared_ptr<corpus_index> corpus_index_sptr;
+
+static xmlNodePtr
+load_type_node_from_corpus_index(read_context&, const string&);
+
+/// A map of the IDs of an ABI file to values of type T.
+///
+/// The IDs emitted by the writer are of the form <prefix><number>,
+/// e.g. "type-id-1234".  The IDs with the prefix of the map are
+/// parsed into their number, which indexes a flat sequence of values.
+/// This avoids hashing and copying the IDs, which are looked up a
+/// lot.  The other IDs, e.g. those emitted with the hash type id
+/// style, are interned into integers first, which index a second
+/// sequence.
+///
+/// A value-initialized value of type T denotes an ID that is not
+/// mapped.  The values are stored in deques, so that mapping a new ID
+/// doesn't invalidate the references to the values of the other IDs,
+/// like with an unordered_map.
+template<typename T>
+class id_map
+{
+  /// The numbers greater than this are not used as indexes, to avoid
+  /// allocating a huge sequence for an unusual ID.
+  static const size_t	max_number = 1 << 22;
+
+  const char*				m_prefix;
+  size_t				m_prefix_len;
+  deque<T>				m_numbered_values;
+  unordered_map<string, size_t>		m_other_keys;
+  deque<T>				m_other_values;
+
+  // Forbid default construction.
+  id_map();
+
+  /// Parse the number of an ID of the form <prefix><number>.
+  ///
+  /// @param id the ID to consider.
+  ///
+  /// @param n output parameter.  This is set to the number of @p id
+  /// iff the function returns true.
+  ///
+  /// @return true iff @p id is of the form <prefix><number>, where
+  /// the number has no leading zero and is not too big.
+  bool
+  get_number(const string& id, size_t& n) const
+  {
+    size_t len = id.size();
+    if (len <= m_prefix_len
+	|| len > m_prefix_len + 7
+	|| id.compare(0, m_prefix_len, m_prefix) != 0
+	|| (id[m_prefix_len] == '0' && len > m_prefix_len + 1))
+      return false;
+
+    size_t result = 0;
+    for (size_t i = m_prefix_len; i < len; ++i)
+      {
+	char c = id[i];
+	if (c < '0' || c > '9')
+	  return false;
+	result = result * 10 + (c - '0');
+      }
+
+    if (result > max_number)
+      return false;
+
+    n = result;
+    return true;
+  }
+
+public:
+
+  /// Constructor of @ref id_map.
+  ///
+  /// @param prefix the prefix of the IDs that are parsed into
+  /// numbers, e.g. "type-id-".
+  id_map(const char* prefix)
+    : m_prefix(prefix),
+      m_prefix_len(strlen(prefix))
+  {}
+
+  /// Get the value mapped to an ID.
+  ///
+  /// @param id the ID to consider.
+  ///
+  /// @return the value mapped to @p id, or a value-initialized value
+  /// if @p id is not mapped.
+  const T&
+  get(const string& id) const
+  {
+    static const T nil = T();
+
+    size_t n = 0;
+    if (get_number(id, n))
+      return n < m_numbered_values.size() ? m_numbered_values[n] : nil;
+
+    unordered_map<string, size_t>::const_iterator i = m_other_keys.find(id);
+    if (i == m_other_keys.end())
+      return nil;
+    return m_other_values[i->second];
+  }
+
+  /// Get the value mapped to an ID, mapping a value-initialized value
+  /// to it first if it's not mapped yet.
+  ///
+  /// @param id the ID to consider.
+  ///
+  /// @return the value mapped to @p id.
+  T&
+  operator[](const string& id)
+  {
+    size_t n = 0;
+    if (get_number(id, n))
+      {
+	if (n >= m_numbered_values.size())
+	  m_numbered_values.resize(n + 1);
+	return m_numbered_values[n];
+      }
+
+    std::pair<unordered_map<string, size_t>::iterator, bool> i =
+      m_other_keys.insert(std::make_pair(id, m_other_values.size()));
+    if (i.second)
+      m_other_values.push_back(T());
+    return m_other_values[i.first->second];
+  }
+
+  /// Test if no ID is mapped.
+  ///
+  /// @return true iff no ID is mapped.
+  bool
+  empty() const
+  {return m_numbered_values.empty() && m_other_values.empty();}
+
+  /// Unmap all the IDs.
+  void
+  clear()
+  {
+    deque<T>().swap(m_numbered_values);
+    m_other_keys.clear();
+    deque<T>().swap(m_other_values);
+  }
+}; // end class id_map
+
 /// This abstracts the context in which the current ABI
 /// instrumentation dump is being de-serialized.  It carries useful
 /// information needed during the de-serialization, but that does not
@@ -79,34 +236,24 @@ class read_context
 {
 public:
 
-  typedef unordered_map<string,
-			vector<type_base_sptr> >::const_iterator
-  const_types_map_it;
+  typedef id_map<vector<type_base_sptr> > types_map;
 
-  typedef unordered_map<string,
-			vector<type_base_sptr> >::iterator
-  types_map_it;
+  typedef id_map<shared_ptr<function_tdecl> > fn_tmpl_map;
 
-  typedef unordered_map<string,
-			shared_ptr<function_tdecl> >::const_iterator
-  const_fn_tmpl_map_it;
+  typedef id_map<shared_ptr<class_tdecl> > class_tmpl_map;
 
-  typedef unordered_map<string,
-			shared_ptr<class_tdecl> >::const_iterator
-  const_class_tmpl_map_it;
-
-  typedef unordered_map<string, xmlNodePtr> string_xml_node_map;
+  typedef id_map<xmlNodePtr> id_xml_node_map;
 
   typedef unordered_map<xmlNodePtr, decl_base_sptr> xml_node_decl_base_sptr_map;
 
 private:
   string						m_path;
   environment*						m_env;
-  unordered_map<string, vector<type_base_sptr> >	m_types_map;
-  unordered_map<string, shared_ptr<function_tdecl> >	m_fn_tmpl_map;
-  unordered_map<string, shared_ptr<class_tdecl> >	m_class_tmpl_map;
+  types_map						m_types_map;
+  fn_tmpl_map						m_fn_tmpl_map;
+  class_tmpl_map					m_class_tmpl_map;
   vector<type_base_sptr>				m_types_to_canonicalize;
-  string_xml_node_map					m_id_xml_node_map;
+  id_xml_node_map					m_id_xml_node_map;
   xml_node_decl_base_sptr_map				m_xml_node_decl_map;
   xml::reader_sptr					m_reader;
   xmlNodePtr						m_corp_node;
@@ -115,8 +262,11 @@ private:
   corpus_group_sptr					m_corpus_group;
   corpus::exported_decls_builder*			m_exported_decls_builder;
   suppr::suppressions_type				m_supprs;
+  mutable suppr::suppressions_index			m_supprs_index;
   bool							m_tracking_non_reachable_types;
   bool							m_drop_undefined_syms;
+  bool							m_parsing_tus_concurrently;
+  corpus_index_sptr					m_corpus_index;
 
   read_context();
 
@@ -124,11 +274,16 @@ public:
   read_context(xml::reader_sptr reader,
 	       environment*	env)
     : m_env(env),
+      m_types_map("type-id-"),
+      m_fn_tmpl_map("fn-tmpl-id-"),
+      m_class_tmpl_map("class-tmpl-id-"),
+      m_id_xml_node_map("type-id-"),
       m_reader(reader),
       m_corp_node(),
       m_exported_decls_builder(),
       m_tracking_non_reachable_types(),
-      m_drop_undefined_syms()
+      m_drop_undefined_syms(),
+      m_parsing_tus_concurrently()
   {}
 
   /// Getter for the flag that tells us if we are tracking types that
@@ -166,6 +321,23 @@ public:
   drop_undefined_syms(bool f)
   {m_drop_undefined_syms = f;}
 
+  /// Getter for the flag that tells us if the translation units of
+  /// the ABI file are parsed concurrently.
+  ///
+  /// @return true iff the translation units of the ABI file are
+  /// parsed concurrently.
+  bool
+  parsing_translation_units_concurrently() const
+  {return m_parsing_tus_concurrently;}
+
+  /// Setter for the flag that tells us if the translation units of
+  /// the ABI file are parsed concurrently.
+  ///
+  /// @param f the new value of the flag.
+  void
+  parsing_translation_units_concurrently(bool f)
+  {m_parsing_tus_concurrently = f;}
+
   /// Getter of the path to the ABI file.
   ///
   /// @return the path to the native xml abi file.
@@ -205,6 +377,32 @@ public:
   get_reader() const
   {return m_reader;}
 
+  /// Drop the xmlTextReader of this context.
+  ///
+  /// This is done once the whole input has been read without
+  /// resorting to the reader, so that subsequent reads see the end
+  /// of the input.
+  void
+  reset_reader()
+  {m_reader.reset();}
+
+  /// Getter of the index of the ABI file, when the corpus is read
+  /// lazily.
+  ///
+  /// @return the index of the ABI file, or nil if the corpus is not
+  /// read lazily.
+  const corpus_index_sptr&
+  get_corpus_index() const
+  {return m_corpus_index;}
+
+  /// Setter of the index of the ABI file, when the corpus is read
+  /// lazily.
+  ///
+  /// @param i the new index of the ABI file.
+  void
+  set_corpus_index(const corpus_index_sptr& i)
+  {m_corpus_index = i;}
+
   xmlNodePtr
   get_corpus_node() const
   {return m_corp_node;}
@@ -213,11 +411,11 @@ public:
   set_corpus_node(xmlNodePtr node)
   {m_corp_node = node;}
 
-  const string_xml_node_map&
+  const id_xml_node_map&
   get_id_xml_node_map() const
   {return m_id_xml_node_map;}
 
-  string_xml_node_map&
+  id_xml_node_map&
   get_id_xml_node_map()
   {return m_id_xml_node_map;}
 
@@ -264,26 +462,21 @@ public:
     if (!node)
       return;
 
-    string_xml_node_map::iterator i = get_id_xml_node_map().find(id);
-    if (i != get_id_xml_node_map().end())
+    xmlNodePtr& n = get_id_xml_node_map()[id];
+    if (n)
       {
 	bool is_declaration = false;
 	read_is_declaration_only(node, is_declaration);
 	if (is_declaration)
-	  i->second = node;
+	  n = node;
       }
     else
-      get_id_xml_node_map()[id] = node;
+      n = node;
   }
 
   xmlNodePtr
   get_xml_node_from_id(const string& id) const
-  {
-    string_xml_node_map::const_iterator i = get_id_xml_node_map().find(id);
-    if (i != get_id_xml_node_map().end())
-     return i->second;
-    return 0;
-  }
+  {return get_id_xml_node_map().get(id);}
 
   scope_decl_sptr
   get_scope_for_node(xmlNodePtr node,
@@ -309,10 +502,10 @@ public:
   type_base_sptr
   get_type_decl(const string& id) const
   {
-    const_types_map_it i = m_types_map.find(id);
-    if (i == m_types_map.end())
+    const vector<type_base_sptr>& types = m_types_map.get(id);
+    if (types.empty())
       return type_base_sptr();
-    type_base_sptr result = i->second[0];
+    type_base_sptr result = types[0];
     return result;
   }
 
@@ -331,11 +524,11 @@ public:
   const vector<type_base_sptr>*
   get_all_type_decls(const string& id) const
   {
-    const_types_map_it i = m_types_map.find(id);
-    if (i == m_types_map.end())
+    const vector<type_base_sptr>& types = m_types_map.get(id);
+    if (types.empty())
       return 0;
     else
-      return &i->second;
+      return &types;
   }
 
   /// Return the function template that is identified by a unique ID.
@@ -351,12 +544,7 @@ public:
   /// id before.
   shared_ptr<function_tdecl>
   get_fn_tmpl_decl(const string& id) const
-  {
-    const_fn_tmpl_map_it i = m_fn_tmpl_map.find(id);
-    if (i == m_fn_tmpl_map.end())
-      return shared_ptr<function_tdecl>();
-    return i->second;
-  }
+  {return m_fn_tmpl_map.get(id);}
 
   /// Return the class template that is identified by a unique ID.
   ///
@@ -370,12 +558,7 @@ public:
   /// if no class template has ever been associated with id before.
   shared_ptr<class_tdecl>
   get_class_tmpl_decl(const string& id) const
-  {
-    const_class_tmpl_map_it i = m_class_tmpl_map.find(id);
-    if (i == m_class_tmpl_map.end())
-      return shared_ptr<class_tdecl>();
-    return i->second;
-  }
+  {return m_class_tmpl_map.get(id);}
 
   /// Return the current lexical scope.
   scope_decl*
@@ -563,11 +746,11 @@ public:
   {
     ABG_ASSERT(fn_tmpl_decl);
 
-    const_fn_tmpl_map_it i = m_fn_tmpl_map.find(id);
-    if (i != m_fn_tmpl_map.end())
+    shared_ptr<function_tdecl>& f = m_fn_tmpl_map[id];
+    if (f)
       return false;
 
-    m_fn_tmpl_map[id] = fn_tmpl_decl;
+    f = fn_tmpl_decl;
     return true;
   }
 
@@ -586,11 +769,11 @@ public:
   {
     ABG_ASSERT(class_tmpl_decl);
 
-    const_class_tmpl_map_it i = m_class_tmpl_map.find(id);
-    if (i != m_class_tmpl_map.end())
+    shared_ptr<class_tdecl>& c = m_class_tmpl_map[id];
+    if (c)
       return false;
 
-    m_class_tmpl_map[id] = class_tmpl_decl;
+    c = class_tmpl_decl;
     return true;
   }
 
@@ -697,7 +880,12 @@ public:
   /// @return the vector of suppression specifications.
   suppr::suppressions_type&
   get_suppressions()
-  {return m_supprs;}
+  {
+    // The caller might modify the suppression specifications so the
+    // index of the suppression specifications needs to be updated.
+    m_supprs_index.invalidate();
+    return m_supprs;
+  }
 
   /// Getter of the vector of the suppression specifications
   /// associated to the current read context.
@@ -705,7 +893,18 @@ public:
   /// @return the vector of suppression specifications.
   const suppr::suppressions_type&
   get_suppressions() const
-  {return const_cast<read_context*>(this)->get_suppressions();}
+  {return m_supprs;}
+
+  /// Getter of the index of the suppression specifications
+  /// associated to the current read context.
+  ///
+  /// @return the index of the suppression specifications.
+  const suppr::suppressions_index&
+  get_suppressions_index() const
+  {
+    m_supprs_index.update(m_supprs);
+    return m_supprs_index;
+  }
 
   /// Test if there are suppression specifications (associated to the
   /// current corpus) that match a given SONAME or file name.
@@ -1279,6 +1478,10 @@ read_context::build_or_get_type_decl(const string& id,
   if (!t)
     {
       xmlNodePtr n = get_xml_node_from_id(id);
+      if (!n && get_corpus_index())
+	// The corpus is read lazily and the XML node of the type
+	// hasn't been loaded yet.
+	n = load_type_node_from_corpus_index(*this, id);
       ABG_ASSERT(n);
 
       scope_decl_sptr scope;
@@ -1755,216 +1958,1467 @@ add_read_context_suppressions(read_context& ctxt,
       ctxt.get_suppressions().push_back(*i);
 }
 
-/// Configure the @ref read_context so that types not reachable from
-/// public interface are taken into account when the abixml file is
-/// read.
+/// Configure the @ref read_context so that types not reachable from
+/// public interface are taken into account when the abixml file is
+/// read.
+///
+/// @param ctxt the @read_context to consider.
+///
+/// @param flag if yes, then types not reachable from public interface
+/// are taken into account when the abixml file is read.
+void
+consider_types_not_reachable_from_public_interfaces(read_context& ctxt,
+						    bool flag)
+{ctxt.tracking_non_reachable_types(flag);}
+
+/// Configure the @ref read_context so that the translation units of
+/// the abixml file are parsed concurrently.
+///
+/// In that mode, the file is split at the boundaries of its
+/// 'abi-instr' elements and the resulting pieces are parsed into XML
+/// trees by several worker threads.  The trees are then put back
+/// together before the ABI artifacts are built from them.  The
+/// resulting corpus is the same as in the default mode.
+///
+/// This only applies to read contexts created from a file path and
+/// to files which root element is 'abi-corpus'.  Other inputs are
+/// read as usual.
+///
+/// @param ctxt the @ref read_context to consider.
+///
+/// @param flag if yes, then the translation units of the abixml file
+/// are parsed concurrently.
+void
+parse_translation_units_concurrently(read_context& ctxt, bool flag)
+{ctxt.parsing_translation_units_concurrently(flag);}
+
+/// The content of a file, mapped in memory.
+///
+/// A gzip-compressed file can't be mapped; it's decompressed in
+/// memory instead.
+class mapped_file
+{
+  const char*	buf_;
+  size_t	size_;
+  string	content_;
+
+  // Forbid copy.
+  mapped_file(const mapped_file&);
+  mapped_file& operator=(const mapped_file&);
+
+public:
+  mapped_file()
+    : buf_(), size_()
+  {}
+
+  /// Map a file in memory.
+  ///
+  /// @param path the path to the file to map.
+  ///
+  /// @return true iff the file could be mapped.  An empty file can't
+  /// be mapped.
+  bool
+  map(const string& path)
+  {
+    unmap();
+
+    if (tools_utils::file_is_compressed(path))
+      {
+	if (!tools_utils::read_file_content(path, content_)
+	    || content_.empty())
+	  return false;
+	buf_ = content_.data();
+	size_ = content_.size();
+	return true;
+      }
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat s;
+    if (fstat(fd, &s) != 0 || s.st_size == 0)
+      {
+	close(fd);
+	return false;
+      }
+
+    void* b = mmap(0, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (b == MAP_FAILED)
+      return false;
+
+    buf_ = static_cast<const char*>(b);
+    size_ = s.st_size;
+    return true;
+  }
+
+  /// Release the memory holding the content of the file.
+  void
+  unmap()
+  {
+    if (buf_ && content_.empty())
+      munmap(const_cast<char*>(buf_), size_);
+    string().swap(content_);
+    buf_ = 0;
+    size_ = 0;
+  }
+
+  /// Getter of the content of the file.
+  ///
+  /// @return the content of the file, or nil if it's not mapped.
+  const char*
+  data() const
+  {return buf_;}
+
+  /// Getter of the size of the content of the file.
+  ///
+  /// @return the size of the content of the file.
+  size_t
+  size() const
+  {return size_;}
+
+  ~mapped_file()
+  {unmap();}
+}; // end class mapped_file
+
+/// A task that parses an in-memory XML document.
+///
+/// Instances of this type are performed by a @ref workers::queue to
+/// parse the pieces of an abixml file concurrently.
+class xml_document_parsing_task : public workers::task
+{
+  const char*	buffer_;
+  int		size_;
+  string	owned_buffer_;
+  xmlDocPtr	doc_;
+
+public:
+  xml_document_parsing_task(const char* buffer, int size)
+    : buffer_(buffer), size_(size), doc_()
+  {}
+
+  /// Constructor of a task that parses a document it owns.
+  ///
+  /// The content of the document is freed as soon as it's parsed.
+  ///
+  /// @param buffer the document to parse.  It's swapped with the
+  /// buffer of the task, so it's empty upon return.
+  xml_document_parsing_task(string& buffer)
+    : buffer_(), size_(), doc_()
+  {
+    owned_buffer_.swap(buffer);
+    buffer_ = owned_buffer_.data();
+    size_ = owned_buffer_.size();
+  }
+
+  /// Parse the document.
+  ///
+  /// The names of the nodes are not put in a dictionary shared by
+  /// the nodes of the document so that the nodes can later be moved
+  /// to another document.
+  virtual void
+  perform()
+  {
+    doc_ = xmlReadMemory(buffer_, size_, "", 0,
+			 XML_PARSE_NODICT | XML_PARSE_COMPACT);
+    string().swap(owned_buffer_);
+    buffer_ = 0;
+  }
+
+  /// Getter of the parsed document.
+  ///
+  /// @return the parsed document, or nil if the parsing failed.
+  xmlDocPtr
+  get_document() const
+  {return doc_;}
+
+  /// Release the parsed document.
+  ///
+  /// @return the parsed document, which now belongs to the caller.
+  xmlDocPtr
+  release_document()
+  {
+    xmlDocPtr doc = doc_;
+    doc_ = 0;
+    return doc;
+  }
+
+  virtual ~xml_document_parsing_task()
+  {
+    if (doc_)
+      xmlFreeDoc(doc_);
+  }
+}; // end class xml_document_parsing_task
+
+/// Convenience typedef for a shared pointer to @ref
+/// xml_document_parsing_task.
+typedef shared_ptr<xml_document_parsing_task> xml_document_parsing_task_sptr;
+
+/// Test if a range of a buffer is made of white spaces only.
+///
+/// @param buf the buffer to consider.
+///
+/// @param begin the beginning of the range.
+///
+/// @param end the end of the range.
+///
+/// @return true iff the characters of @p buf in [begin, end) are all
+/// white spaces.
+static bool
+is_blank(const char* buf, size_t begin, size_t end)
+{
+  for (size_t i = begin; i < end; ++i)
+    if (!isspace(static_cast<unsigned char>(buf[i])))
+      return false;
+  return true;
+}
+
+/// Find a string in a buffer.
+///
+/// @param buf the buffer to search.
+///
+/// @param size the size of @p buf.
+///
+/// @param from the offset from which to search.
+///
+/// @param str the string to search for.
+///
+/// @return the offset of the first occurrence of @p str at or after
+/// @p from, or string::npos if there is none.
+static size_t
+find_in_buffer(const char* buf, size_t size, size_t from, const string& str)
+{
+  if (from >= size)
+    return string::npos;
+  const char* end = buf + size;
+  const char* p = std::search(buf + from, end, str.begin(), str.end());
+  return p == end ? string::npos : p - buf;
+}
+
+/// Test if a string appears at a given offset of a buffer.
+///
+/// @param buf the buffer to consider.
+///
+/// @param size the size of @p buf.
+///
+/// @param pos the offset to consider.
+///
+/// @param str the string to look for.
+///
+/// @return true iff @p str appears at offset @p pos of @p buf.
+static bool
+buffer_has_string_at(const char* buf, size_t size,
+		     size_t pos, const string& str)
+{
+  return (pos <= size
+	  && size - pos >= str.size()
+	  && !memcmp(buf + pos, str.data(), str.size()));
+}
+
+/// Split the text of an abixml corpus at the boundaries of its
+/// 'abi-instr' elements.
+///
+/// @param text the text of the abixml document.
+///
+/// @param size the size of @p text.
+///
+/// @param tus output parameter.  The [begin, end) ranges of the
+/// 'abi-instr' elements in @p text, in the order of the document.
+///
+/// @return true iff @p text is an 'abi-corpus' document which
+/// translation units follow each other, only separated by white
+/// spaces.
+static bool
+split_corpus_text_at_translation_units(const char* text, size_t size,
+				       vector<std::pair<size_t, size_t> >& tus)
+{
+  static const string lt = "<", gt = ">";
+  static const string pi_start = "<?", decl_start = "<!";
+
+  // Find the root element, skipping the XML declaration and the
+  // comments that might precede it.
+  size_t pos = 0;
+  for (pos = find_in_buffer(text, size, 0, lt);
+       pos != string::npos;
+       pos = find_in_buffer(text, size, pos, lt))
+    {
+      if (!buffer_has_string_at(text, size, pos, pi_start)
+	  && !buffer_has_string_at(text, size, pos, decl_start))
+	break;
+      pos = find_in_buffer(text, size, pos, gt);
+    }
+  static const string corpus_start = "<abi-corpus";
+  if (pos == string::npos
+      || !buffer_has_string_at(text, size, pos, corpus_start)
+      || pos + corpus_start.size() >= size)
+    return false;
+  char c = text[pos + corpus_start.size()];
+  if (!isspace(static_cast<unsigned char>(c)) && c != '>')
+    return false;
+
+  static const string tu_start = "<abi-instr", tu_end = "</abi-instr>";
+  for (pos = find_in_buffer(text, size, pos, tu_start);
+       pos != string::npos;
+       pos = find_in_buffer(text, size, pos, tu_start))
+    {
+      if (pos + tu_start.size() >= size)
+	return false;
+      c = text[pos + tu_start.size()];
+      if (!isspace(static_cast<unsigned char>(c)) && c != '>' && c != '/')
+	{
+	  pos += tu_start.size();
+	  continue;
+	}
+
+      if (!tus.empty() && !is_blank(text, tus.back().second, pos))
+	return false;
+
+      size_t end = find_in_buffer(text, size, pos, gt);
+      if (end == string::npos)
+	return false;
+      if (text[end - 1] == '/')
+	// This is an empty translation unit.
+	++end;
+      else
+	{
+	  end = find_in_buffer(text, size, end, tu_end);
+	  if (end == string::npos)
+	    return false;
+	  end += tu_end.size();
+	}
+      tus.push_back(std::make_pair(pos, end));
+      pos = end;
+    }
+
+  return !tus.empty();
+}
+
+/// Read the corpus file of a @ref read_context, if it's in the
+/// binary corpus format.
+///
+/// A binary corpus file is an abixml corpus encoded in the binary
+/// tree format of xml::write_binary_tree().  The file is mapped in
+/// memory and decoded straight into an XML tree, without going
+/// through the XML parser.  If the file is gzip-compressed, it's
+/// decompressed in memory instead.
+///
+/// @param ctxt the read context to consider.
+///
+/// @return the resulting document, or nil if the file is not a valid
+/// binary corpus file.  The caller owns the document.
+static xmlDocPtr
+read_binary_corpus_file(read_context& ctxt)
+{
+  const string& path = ctxt.get_path();
+  if (path.empty())
+    return 0;
+
+  xmlDocPtr doc = 0;
+  if (tools_utils::file_is_compressed(path))
+    {
+      if (tools_utils::guess_file_type(path)
+	  != tools_utils::FILE_TYPE_BINARY_CORPUS)
+	return 0;
+      string content;
+      if (!tools_utils::read_file_content(path, content))
+	return 0;
+      doc = xml::read_binary_tree(content.data(), content.size());
+    }
+  else
+    {
+      int fd = open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+	return 0;
+
+      struct stat s;
+      char magic[8];
+      if (fstat(fd, &s) != 0
+	  || read(fd, magic, sizeof(magic)) != sizeof(magic)
+	  || !xml::is_binary_tree(magic, sizeof(magic)))
+	{
+	  close(fd);
+	  return 0;
+	}
+
+      void* buf = mmap(0, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (buf == MAP_FAILED)
+	return 0;
+
+      doc = xml::read_binary_tree(static_cast<const char*>(buf), s.st_size);
+      munmap(buf, s.st_size);
+    }
+
+  xmlNodePtr root = doc ? xmlDocGetRootElement(doc) : 0;
+  if (root && !xmlStrEqual(root->name, BAD_CAST("abi-corpus")))
+    {
+      xmlFreeDoc(doc);
+      doc = 0;
+    }
+
+  return doc;
+}
+
+/// Parse the abixml corpus file of a @ref read_context, parsing its
+/// translation units concurrently.
+///
+/// The translation units are parsed into separate XML documents by a
+/// @ref workers::queue, and so is the rest of the corpus.  The trees
+/// of the translation units are then moved under the 'abi-corpus'
+/// element, in the order of the file, so that the resulting document
+/// is the one a sequential parsing would have produced, modulo the
+/// white spaces between translation units.
+///
+/// @param ctxt the read context to consider.
+///
+/// @return the resulting document, or nil if the file couldn't be
+/// split or parsed that way.  The caller owns the document.
+static xmlDocPtr
+parse_corpus_file_concurrently(read_context& ctxt)
+{
+  const string& path = ctxt.get_path();
+  if (path.empty())
+    return 0;
+
+  mapped_file file;
+  if (!file.map(path))
+    return 0;
+  const char* text = file.data();
+
+  vector<std::pair<size_t, size_t> > tus;
+  if (!split_corpus_text_at_translation_units(text, file.size(), tus))
+    return 0;
+
+  // The corpus without its translation units.  It's freed by the
+  // task that parses it, as soon as it's parsed.
+  string skeleton(text, tus.front().first);
+  skeleton.append(text + tus.back().second,
+		  file.size() - tus.back().second);
+
+  if (skeleton.size() > INT_MAX)
+    return 0;
+
+  vector<xml_document_parsing_task_sptr> tasks;
+  workers::queue::tasks_type scheduled_tasks;
+  xml_document_parsing_task_sptr skeleton_task
+    (new xml_document_parsing_task(skeleton));
+  scheduled_tasks.push_back(skeleton_task);
+  for (vector<std::pair<size_t, size_t> >::const_iterator i = tus.begin();
+       i != tus.end();
+       ++i)
+    {
+      size_t size = i->second - i->first;
+      if (size > INT_MAX)
+	return 0;
+      xml_document_parsing_task_sptr t
+	(new xml_document_parsing_task(text + i->first, size));
+      tasks.push_back(t);
+      scheduled_tasks.push_back(t);
+    }
+
+  // libxml2 must be initialized by the main thread before it's used
+  // by several threads.
+  xmlInitParser();
+
+  size_t num_workers = std::min(workers::get_number_of_threads(),
+				scheduled_tasks.size());
+  if (num_workers < 2)
+    for (workers::queue::tasks_type::const_iterator i =
+	   scheduled_tasks.begin();
+	 i != scheduled_tasks.end();
+	 ++i)
+      (*i)->perform();
+  else
+    {
+      workers::queue q(num_workers);
+      q.schedule_tasks(scheduled_tasks);
+      q.wait_for_workers_to_complete();
+    }
+
+  // The text of the file isn't needed anymore; don't keep it around
+  // while the trees are put together and read.
+  file.unmap();
+
+  xmlDocPtr doc = skeleton_task->get_document();
+  xmlNodePtr corpus_node = doc ? xmlDocGetRootElement(doc) : 0;
+  if (!corpus_node
+      || !xmlStrEqual(corpus_node->name, BAD_CAST("abi-corpus")))
+    return 0;
+
+  for (vector<xml_document_parsing_task_sptr>::const_iterator i =
+	 tasks.begin();
+       i != tasks.end();
+       ++i)
+    if (!(*i)->get_document())
+      return 0;
+
+  for (vector<xml_document_parsing_task_sptr>::const_iterator i =
+	 tasks.begin();
+       i != tasks.end();
+       ++i)
+    {
+      xmlNodePtr tu_node = xmlDocGetRootElement((*i)->get_document());
+      xmlUnlinkNode(tu_node);
+      xmlAddChild(corpus_node, tu_node);
+    }
+
+  return skeleton_task->release_document();
+}
+
+/// Parse the input XML document containing an ABI corpus, represented
+/// by an 'abi-corpus' element node, associated to the current
+/// context.
+///
+/// @param ctxt the current input context.
+///
+/// @return the corpus resulting from the parsing
+corpus_sptr
+read_corpus_from_input(read_context& ctxt)
+{
+  corpus_sptr nil;
+
+  xml::reader_sptr reader = ctxt.get_reader();
+  if (!reader)
+    return nil;
+
+  bool call_reader_next = false;
+
+  xmlNodePtr node = ctxt.get_corpus_node();
+
+  // This is the document of the whole corpus file when it's read
+  // from a binary corpus file or parsed by
+  // parse_corpus_file_concurrently().
+  xmlDocPtr doc = 0;
+  if (!node && !ctxt.get_corpus_group())
+    {
+      doc = read_binary_corpus_file(ctxt);
+      if (!doc && ctxt.parsing_translation_units_concurrently())
+	doc = parse_corpus_file_concurrently(ctxt);
+      if (doc)
+	node = xmlDocGetRootElement(doc);
+    }
+
+  if (!node)
+    {
+      // The document must start with the abi-corpus node.
+      int status = 1;
+      while (status == 1
+	     && XML_READER_GET_NODE_TYPE(reader) != XML_READER_TYPE_ELEMENT)
+	status = advance_cursor (ctxt);
+
+      if (status != 1 || !xmlStrEqual (XML_READER_GET_NODE_NAME(reader).get(),
+				       BAD_CAST("abi-corpus")))
+	return nil;
+
+      if (!ctxt.get_corpus())
+	{
+	  corpus_sptr c(new corpus(ctxt.get_environment(), ""));
+	  ctxt.set_corpus(c);
+	}
+
+      if (!ctxt.get_corpus_group())
+	ctxt.clear_per_corpus_data();
+
+      corpus& corp = *ctxt.get_corpus();
+      ctxt.set_exported_decls_builder(corp.get_exported_decls_builder().get());
+
+      xml::xml_char_sptr path_str = XML_READER_GET_ATTRIBUTE(reader, "path");
+      string path;
+
+      if (path_str)
+	{
+	  path = reinterpret_cast<char*>(path_str.get());
+	  corp.set_path(path);
+	}
+
+      xml::xml_char_sptr architecture_str =
+	XML_READER_GET_ATTRIBUTE(reader, "architecture");
+      if (architecture_str)
+	corp.set_architecture_name
+	  (reinterpret_cast<char*>(architecture_str.get()));
+
+      xml::xml_char_sptr soname_str =
+	XML_READER_GET_ATTRIBUTE(reader, "soname");
+      string soname;
+
+      if (soname_str)
+	{
+	  soname = reinterpret_cast<char*>(soname_str.get());
+	  corp.set_soname(soname);
+	}
+
+      // Apply suppression specifications here to honour:
+      //
+      //   [suppress_file]
+      //     (soname_regexp
+      //      |soname_not_regexp
+      //      |file_name_regexp
+      //      |file_name_not_regexp) = <soname-or-file-name>
+      if ((!soname.empty() || !path.empty())
+	  && ctxt.corpus_is_suppressed_by_soname_or_filename(soname, path))
+	return nil;
+
+      node = xmlTextReaderExpand(reader.get());
+      if (!node)
+	return nil;
+
+      call_reader_next = true;
+    }
+  else
+    {
+      if (!ctxt.get_corpus())
+	{
+	  corpus_sptr c(new corpus(ctxt.get_environment(), ""));
+	  ctxt.set_corpus(c);
+	}
+
+      if (!ctxt.get_corpus_group())
+	ctxt.clear_per_corpus_data();
+
+      corpus& corp = *ctxt.get_corpus();
+      ctxt.set_exported_decls_builder(corp.get_exported_decls_builder().get());
+
+      xml::xml_char_sptr path_str = XML_NODE_GET_ATTRIBUTE(node, "path");
+      string path;
+      if (path_str)
+	{
+	  path = reinterpret_cast<char*>(path_str.get());
+	  corp.set_path(path);
+	}
+
+      xml::xml_char_sptr architecture_str =
+	XML_NODE_GET_ATTRIBUTE(node, "architecture");
+      if (architecture_str)
+	corp.set_architecture_name
+	  (reinterpret_cast<char*>(architecture_str.get()));
+
+      xml::xml_char_sptr soname_str =
+	XML_NODE_GET_ATTRIBUTE(node, "soname");
+      string soname;
+      if (soname_str)
+	{
+	  soname = reinterpret_cast<char*>(soname_str.get());
+	  corp.set_soname(soname);
+	}
+
+      // When the corpus is read from the document of the whole
+      // corpus file, apply the suppression specifications on the
+      // soname and the file name, just like when the corpus is read
+      // through the xmlTextReader.
+      if (doc
+	  && (!soname.empty() || !path.empty())
+	  && ctxt.corpus_is_suppressed_by_soname_or_filename(soname, path))
+	{
+	  xmlFreeDoc(doc);
+	  return nil;
+	}
+    }
+
+  if (!node->children)
+    {
+      if (doc)
+	xmlFreeDoc(doc);
+      return nil;
+    }
+
+  ctxt.set_corpus_node(node->children);
+
+  corpus& corp = *ctxt.get_corpus();
+
+  walk_xml_node_to_map_type_ids(ctxt, node);
+
+  // Read the needed element
+  vector<string> needed;
+  read_elf_needed_from_input(ctxt, needed);
+  if (!needed.empty())
+    corp.set_needed(needed);
+
+  string_elf_symbols_map_sptr fn_sym_db, var_sym_db;
+
+  // Read the symbol databases.
+  bool is_ok = read_symbol_db_from_input(ctxt, fn_sym_db, var_sym_db);
+  if (is_ok)
+    {
+      // Note that it's possible that both fn_sym_db and var_sym_db
+      // are nil, due to potential suppression specifications.  That's
+      // fine.
+      if (fn_sym_db)
+	{
+	  corp.set_fun_symbol_map(fn_sym_db);
+	  fn_sym_db.reset();
+	}
+      if (var_sym_db)
+	{
+	  corp.set_var_symbol_map(var_sym_db);
+	  var_sym_db.reset();
+	}
+    }
+
+  ctxt.get_environment()->canonicalization_is_done(false);
+
+  // Read the translation units.
+  do
+    {
+      translation_unit_sptr tu = read_translation_unit_from_input(ctxt);
+      is_ok = bool(tu);
+    }
+  while (is_ok);
+
+  if (ctxt.tracking_non_reachable_types())
+    {
+      bool is_tracking_non_reachable_types = false;
+      read_tracking_non_reachable_types(node, is_tracking_non_reachable_types);
+
+      ABG_ASSERT
+	(corp.recording_types_reachable_from_public_interface_supported()
+	 == is_tracking_non_reachable_types);
+    }
+
+  // All the ABI artifacts of the corpus have been built, so the XML
+  // tree of the corpus is not needed anymore.  Release it before
+  // canonicalizing the types, to lower the peak memory usage.
+  if (call_reader_next)
+    {
+      // This is the necessary counter-part of the xmlTextReaderExpand()
+      // call at the beginning of the function.  It frees the tree of
+      // the corpus.
+      xmlTextReaderNext(reader.get());
+      ctxt.clear_id_xml_node_map();
+    }
+  else if (doc)
+    {
+      // The whole file has been read without using the reader.
+      xmlFreeDoc(doc);
+      ctxt.clear_id_xml_node_map();
+      ctxt.set_corpus_node(0);
+      ctxt.reset_reader();
+    }
+  else
+    {
+      node = ctxt.get_corpus_node();
+      node = xml::advance_to_next_sibling_element(node);
+      if (!node)
+	{
+	  node = ctxt.get_corpus_node();
+	  node = xml::advance_to_next_sibling_element(node->parent);
+	}
+      ctxt.set_corpus_node(node);
+    }
+
+  ctxt.perform_late_type_canonicalizing();
+
+  ctxt.get_environment()->canonicalization_is_done(true);
+
+  corp.set_origin(corpus::NATIVE_XML_ORIGIN);
+
+  return ctxt.get_corpus();
+}
+
+// <corpus index>
+
+/// The index of the elements of an abixml corpus file.
+///
+/// The index is used to read a corpus lazily: the IR of the
+/// functions, variables and types of the corpus is built only when
+/// they are looked up.  See read_indexed_corpus_from_input().
+///
+/// The corpus file is mapped in memory and scanned once to record
+/// the byte range of each element that can be loaded on its own.
+/// These are the children of the 'abi-corpus', 'abi-instr' and
+/// 'namespace-decl' elements.  The type ids and the ELF symbols ids
+/// that appear in an element are mapped to that element.  The XML
+/// node of an element is then built, by parsing its text, only when
+/// it's needed.
+struct corpus_index
+{
+  /// An element of the corpus file.
+  struct element
+  {
+    /// The offset of the start tag of the element.
+    size_t	begin;
+    /// The offset of the end of the start tag of the element.
+    size_t	start_tag_end;
+    /// The offset of the end of the element.
+    size_t	end;
+    /// The index of the parent element, or npos for the
+    /// 'abi-corpus' element.
+    size_t	parent;
+    /// Whether the element is an 'abi-corpus', an 'abi-instr' or a
+    /// 'namespace-decl' element, which children are indexed.
+    bool	is_scope;
+    /// The XML node of the element, once it's loaded.
+    xmlNodePtr	node;
+
+    element(size_t b, size_t p)
+      : begin(b), start_tag_end(), end(), parent(p), is_scope(), node()
+    {}
+  }; // end struct element
+
+  typedef unordered_map<string, size_t> string_element_map;
+  typedef unordered_map<string, decl_base_sptr> string_decl_map;
+
+  static const size_t	npos = static_cast<size_t>(-1);
+
+  mapped_file		file;
+  const char*		buf;
+  size_t		size;
+  vector<element>	elements;
+  string_element_map	type_ids;
+  string_element_map	fn_symbol_ids;
+  string_element_map	var_symbol_ids;
+  size_t		needed;
+  size_t		fn_symbols;
+  size_t		var_symbols;
+  string_decl_map	fn_decls;
+  string_decl_map	var_decls;
+  xmlDocPtr		doc;
+
+  corpus_index()
+    : buf(), size(), needed(npos), fn_symbols(npos), var_symbols(npos),
+      doc()
+  {}
+
+  ~corpus_index()
+  {
+    if (doc)
+      xmlFreeDoc(doc);
+  }
+
+  /// Map a corpus file in memory.
+  ///
+  /// @param path the path to the corpus file.
+  ///
+  /// @return true iff the file could be mapped.
+  bool
+  map_file(const string& path)
+  {
+    if (!file.map(path))
+      return false;
+    buf = file.data();
+    size = file.size();
+    return true;
+  }
+
+  /// Test if the name of an element is a given string.
+  ///
+  /// @param name the name of the element.  It's not NUL-terminated.
+  ///
+  /// @param len the length of @p name.
+  ///
+  /// @param s the string to compare @p name to.
+  ///
+  /// @return true iff @p name equals @p s.
+  static bool
+  name_is(const char* name, size_t len, const char* s)
+  {return strlen(s) == len && !memcmp(name, s, len);}
+
+  /// Map an id to an element of the index.
+  ///
+  /// Like read_context::map_id_and_node(), a subsequent element that
+  /// is a declaration takes over the id.
+  ///
+  /// @param ids the map of ids to update.
+  ///
+  /// @param id the id to map.  It's not unescaped yet.
+  ///
+  /// @param e the index of the element to map @p id to.
+  ///
+  /// @param is_declaration whether the element is a declaration.
+  static void
+  map_id(string_element_map& ids, string& id, size_t e, bool is_declaration)
+  {
+    if (id.find('&') != string::npos)
+      id = xml::unescape_xml_string(id);
+    std::pair<string_element_map::iterator, bool> r =
+      ids.insert(std::make_pair(id, e));
+    if (!r.second && is_declaration)
+      r.first->second = e;
+  }
+
+  /// Index the elements of the corpus file mapped in memory.
+  ///
+  /// This doesn't parse the file, it only recognizes the tags of its
+  /// elements and their attributes.
+  ///
+  /// @return true iff the file is an abixml corpus file that could
+  /// be indexed.
+  bool
+  scan()
+  {
+    // The elements that are open at the current point of the text.
+    // Each one is represented by the index of the element of the
+    // index it belongs to, and by whether it is that element.
+    vector<std::pair<size_t, bool> > open_elements;
+    const char* end = buf + size;
+    const char* p = buf;
+    string id, symbol_id;
+
+    while ((p = static_cast<const char*>(memchr(p, '<', end - p))))
+      {
+	const char* tag = p;
+	if (end - p >= 4 && !memcmp(p, "<!--", 4))
+	  {
+	    // Skip the comment.
+	    for (p += 4; p + 2 < end; ++p)
+	      if (p[0] == '-' && p[1] == '-' && p[2] == '>')
+		break;
+	    if (p + 2 >= end)
+	      return false;
+	    p += 3;
+	    continue;
+	  }
+
+	if (p + 1 < end && (p[1] == '?' || p[1] == '!' || p[1] == '/'))
+	  {
+	    bool is_end_tag = p[1] == '/';
+	    if (!(p = static_cast<const char*>(memchr(p, '>', end - p))))
+	      return false;
+	    ++p;
+	    if (!is_end_tag)
+	      continue;
+	    if (open_elements.empty())
+	      return false;
+	    if (open_elements.back().second)
+	      elements[open_elements.back().first].end = p - buf;
+	    open_elements.pop_back();
+	    if (open_elements.empty())
+	      // The 'abi-corpus' element is closed.
+	      return true;
+	    continue;
+	  }
+
+	// This is a start tag.  Read its name and its attributes.
+	const char* name = ++p;
+	while (p < end
+	       && !isspace(static_cast<unsigned char>(*p))
+	       && *p != '/'
+	       && *p != '>')
+	  ++p;
+	size_t name_len = p - name;
+
+	id.clear();
+	symbol_id.clear();
+	bool is_declaration = false;
+	for (;;)
+	  {
+	    while (p < end && isspace(static_cast<unsigned char>(*p)))
+	      ++p;
+	    if (p >= end)
+	      return false;
+	    if (*p == '/' || *p == '>')
+	      break;
+
+	    const char* attr = p;
+	    while (p < end
+		   && *p != '='
+		   && !isspace(static_cast<unsigned char>(*p)))
+	      ++p;
+	    size_t attr_len = p - attr;
+	    while (p < end && *p != '\'' && *p != '"')
+	      ++p;
+	    if (p >= end)
+	      return false;
+	    char quote = *p++;
+	    const char* value = p;
+	    if (!(p = static_cast<const char*>(memchr(p, quote, end - p))))
+	      return false;
+	    size_t value_len = p++ - value;
+
+	    if (name_is(attr, attr_len, "id"))
+	      id.assign(value, value_len);
+	    else if (name_is(attr, attr_len, "elf-symbol-id"))
+	      symbol_id.assign(value, value_len);
+	    else if (name_is(attr, attr_len, "is-declaration-only"))
+	      is_declaration = name_is(value, value_len, "yes");
+	  }
+
+	bool is_empty = *p == '/';
+	if (!(p = static_cast<const char*>(memchr(p, '>', end - p))))
+	  return false;
+	++p;
+
+	size_t parent = open_elements.empty()
+	  ? npos
+	  : open_elements.back().first;
+	size_t e = parent;
+	bool is_indexed = false;
+	if (parent == npos)
+	  {
+	    if (!elements.empty() || !name_is(name, name_len, "abi-corpus"))
+	      return false;
+	    elements.push_back(element(tag - buf, npos));
+	    elements.back().is_scope = true;
+	    e = 0;
+	    is_indexed = true;
+	  }
+	else if (elements[parent].is_scope)
+	  {
+	    elements.push_back(element(tag - buf, parent));
+	    e = elements.size() - 1;
+	    is_indexed = true;
+	    if (parent == 0)
+	      {
+		if (name_is(name, name_len, "abi-instr"))
+		  elements.back().is_scope = !is_empty;
+		else if (name_is(name, name_len, "elf-needed"))
+		  needed = e;
+		else if (name_is(name, name_len, "elf-function-symbols"))
+		  fn_symbols = e;
+		else if (name_is(name, name_len, "elf-variable-symbols"))
+		  var_symbols = e;
+	      }
+	    else if (name_is(name, name_len, "namespace-decl"))
+	      elements.back().is_scope = !is_empty;
+	  }
+
+	if (is_indexed)
+	  {
+	    elements[e].start_tag_end = p - buf;
+	    if (is_empty)
+	      elements[e].end = p - buf;
+	  }
+
+	if (!elements[e].is_scope)
+	  {
+	    if (!id.empty())
+	      map_id(type_ids, id, e, is_declaration);
+	    if (!symbol_id.empty())
+	      {
+		if (name_is(name, name_len, "function-decl"))
+		  map_id(fn_symbol_ids, symbol_id, e, is_declaration);
+		else if (name_is(name, name_len, "var-decl"))
+		  map_id(var_symbol_ids, symbol_id, e, is_declaration);
+	      }
+	  }
+
+	if (!is_empty)
+	  open_elements.push_back(std::make_pair(e, is_indexed));
+	else if (open_elements.empty())
+	  // The 'abi-corpus' element is empty.
+	  return true;
+      }
+
+    // The 'abi-corpus' element is not closed.
+    return false;
+  }
+}; // end struct corpus_index
+
+/// Load the XML node of an element of the index of a corpus file.
+///
+/// The XML node of the parent element is loaded first, if need be.
+/// The XML node of a scope element is loaded without its children,
+/// and the IR node of the scope is built right away.  That way, the
+/// children of the scope that are loaded later are built one at a
+/// time, as they are looked up.
+///
+/// @param ctxt the read context to consider.
+///
+/// @param index the index of the corpus file of @p ctxt.
+///
+/// @param e the index of the element to load in @p index.
+///
+/// @return the XML node of the element, or nil if it couldn't be
+/// loaded.
+static xmlNodePtr
+load_corpus_index_element(read_context& ctxt, corpus_index& index, size_t e)
+{
+  corpus_index::element& elem = index.elements[e];
+  if (elem.node)
+    return elem.node;
+
+  const char* text = index.buf + elem.begin;
+  size_t len = elem.end - elem.begin;
+  string scope_text;
+  if (elem.is_scope)
+    {
+      // Load the start tag of the scope, followed by its end tag.
+      const char* name_end = text + 1;
+      while (!isspace(static_cast<unsigned char>(*name_end))
+	     && *name_end != '>')
+	++name_end;
+      scope_text.assign(text, elem.start_tag_end - elem.begin);
+      scope_text += "</" + string(text + 1, name_end) + ">";
+      text = scope_text.c_str();
+      len = scope_text.size();
+    }
+
+  if (len > INT_MAX)
+    return 0;
+
+  if (elem.parent == corpus_index::npos)
+    {
+      index.doc = xmlReadMemory(text, len, "", 0, XML_PARSE_COMPACT);
+      if (!index.doc)
+	return 0;
+      elem.node = xmlDocGetRootElement(index.doc);
+      return elem.node;
+    }
+
+  xmlNodePtr parent = load_corpus_index_element(ctxt, index, elem.parent);
+  if (!parent)
+    return 0;
+
+  xmlNodePtr node = 0;
+  if (xmlParseInNodeContext(parent, text, len, XML_PARSE_COMPACT, &node)
+      != XML_ERR_OK
+      || !node)
+    {
+      if (node)
+	xmlFreeNodeList(node);
+      return 0;
+    }
+  xmlAddChild(parent, node);
+  elem.node = node;
+
+  if (elem.is_scope)
+    {
+      if (xmlStrEqual(node->name, BAD_CAST("abi-instr")))
+	get_or_read_and_add_translation_unit(ctxt, node);
+      else
+	{
+	  access_specifier access = no_access;
+	  scope_decl_sptr scope = ctxt.get_scope_for_node(node, access);
+	  ctxt.push_decl(scope);
+	  handle_element_node(ctxt, node, /*add_to_current_scope=*/true);
+	  ctxt.pop_scope_or_abort(scope);
+	}
+    }
+  else
+    walk_xml_node_to_map_type_ids(ctxt, node);
+
+  return node;
+}
+
+/// Load the XML node of a type from the index of the corpus file of
+/// a read context.
+///
+/// @param ctxt the read context to consider.
+///
+/// @param id the id of the type to consider.
+///
+/// @return the XML node of the type, or nil if it's not in the
+/// corpus file.
+static xmlNodePtr
+load_type_node_from_corpus_index(read_context& ctxt, const string& id)
+{
+  const corpus_index_sptr& index = ctxt.get_corpus_index();
+  ABG_ASSERT(index);
+
+  corpus_index::string_element_map::const_iterator i =
+    index->type_ids.find(id);
+  if (i == index->type_ids.end()
+      || !load_corpus_index_element(ctxt, *index, i->second))
+    return 0;
+
+  return ctxt.get_xml_node_from_id(id);
+}
+
+/// Find the 'function-decl' or 'var-decl' XML element node that
+/// refers to a given ELF symbol, in a given XML sub-tree.
 ///
-/// @param ctxt the @read_context to consider.
+/// @param node the XML sub-tree to consider.
 ///
-/// @param flag if yes, then types not reachable from public interface
-/// are taken into account when the abixml file is read.
-void
-consider_types_not_reachable_from_public_interfaces(read_context& ctxt,
-						    bool flag)
-{ctxt.tracking_non_reachable_types(flag);}
-
-/// Parse the input XML document containing an ABI corpus, represented
-/// by an 'abi-corpus' element node, associated to the current
-/// context.
+/// @param element_name the name of the element to look for.
 ///
-/// @param ctxt the current input context.
+/// @param symbol_id the id of the ELF symbol to consider.
 ///
-/// @return the corpus resulting from the parsing
-corpus_sptr
-read_corpus_from_input(read_context& ctxt)
+/// @return the XML element node found, or nil.
+static xmlNodePtr
+find_decl_node_with_symbol(xmlNodePtr		node,
+			   const char*		element_name,
+			   const string&	symbol_id)
 {
-  corpus_sptr nil;
+  if (node->type != XML_ELEMENT_NODE)
+    return 0;
 
-  xml::reader_sptr reader = ctxt.get_reader();
-  if (!reader)
-    return nil;
+  if (xmlStrEqual(node->name, BAD_CAST(element_name)))
+    if (xml_char_sptr s = XML_NODE_GET_ATTRIBUTE(node, "elf-symbol-id"))
+      if (symbol_id == CHAR_STR(s))
+	return node;
 
-  bool call_reader_next = false;
+  for (xmlNodePtr n = node->children; n; n = n->next)
+    if (xmlNodePtr result = find_decl_node_with_symbol(n, element_name,
+						       symbol_id))
+      return result;
 
-  xmlNodePtr node = ctxt.get_corpus_node();
-  if (!node)
-    {
-      // The document must start with the abi-corpus node.
-      int status = 1;
-      while (status == 1
-	     && XML_READER_GET_NODE_TYPE(reader) != XML_READER_TYPE_ELEMENT)
-	status = advance_cursor (ctxt);
+  return 0;
+}
 
-      if (status != 1 || !xmlStrEqual (XML_READER_GET_NODE_NAME(reader).get(),
-				       BAD_CAST("abi-corpus")))
-	return nil;
+/// Build the IR of the function or of the variable that refers to a
+/// given ELF symbol, from the index of the corpus file of a read
+/// context.
+///
+/// @param ctxt the read context to consider.
+///
+/// @param symbol_id the id of the ELF symbol to consider.
+///
+/// @param is_function true if a function is to be built, false if a
+/// variable is.
+///
+/// @return the function or variable built, or nil if there is no
+/// such function or variable in the corpus file, or if it's
+/// suppressed.
+static decl_base_sptr
+build_decl_from_corpus_index(read_context&	ctxt,
+			     const string&	symbol_id,
+			     bool		is_function)
+{
+  decl_base_sptr nil;
 
-      if (!ctxt.get_corpus())
-	{
-	  corpus_sptr c(new corpus(ctxt.get_environment(), ""));
-	  ctxt.set_corpus(c);
-	}
+  const corpus_index_sptr& index = ctxt.get_corpus_index();
+  if (!index)
+    return nil;
 
-      if (!ctxt.get_corpus_group())
-	ctxt.clear_per_corpus_data();
+  corpus_index::string_decl_map& decls =
+    is_function ? index->fn_decls : index->var_decls;
+  corpus_index::string_decl_map::const_iterator d = decls.find(symbol_id);
+  if (d != decls.end())
+    return d->second;
 
-      corpus& corp = *ctxt.get_corpus();
-      ctxt.set_exported_decls_builder(corp.get_exported_decls_builder().get());
+  const corpus_index::string_element_map& ids =
+    is_function ? index->fn_symbol_ids : index->var_symbol_ids;
+  corpus_index::string_element_map::const_iterator i = ids.find(symbol_id);
+  if (i == ids.end())
+    return nil;
 
-      xml::xml_char_sptr path_str = XML_READER_GET_ATTRIBUTE(reader, "path");
-      string path;
+  ctxt.get_environment()->canonicalization_is_done(false);
 
-      if (path_str)
+  xmlNodePtr root = load_corpus_index_element(ctxt, *index, i->second);
+  xmlNodePtr node =
+    root
+    ? find_decl_node_with_symbol(root,
+				 is_function ? "function-decl" : "var-decl",
+				 symbol_id)
+    : 0;
+
+  decl_base_sptr decl;
+  if (node && node == root)
+    {
+      access_specifier access = no_access;
+      scope_decl_sptr scope = ctxt.get_scope_for_node(node, access);
+      ctxt.push_decl(scope);
+      decl = is_decl(handle_element_node(ctxt, node,
+					 /*add_to_current_scope=*/true));
+      ctxt.pop_scope_or_abort(scope);
+    }
+  else if (node)
+    {
+      // The function or variable is a member of a class or union.
+      // Build the element it belongs to, and look it up among the
+      // members of the innermost class or union it belongs to.
+      if (!ctxt.get_decl_for_xml_node(root))
 	{
-	  path = reinterpret_cast<char*>(path_str.get());
-	  corp.set_path(path);
+	  access_specifier access = no_access;
+	  scope_decl_sptr scope = ctxt.get_scope_for_node(root, access);
+	  ctxt.push_decl(scope);
+	  handle_element_node(ctxt, root, /*add_to_current_scope=*/true);
+	  ctxt.pop_scope_or_abort(scope);
 	}
 
-      xml::xml_char_sptr architecture_str =
-	XML_READER_GET_ATTRIBUTE(reader, "architecture");
-      if (architecture_str)
-	corp.set_architecture_name
-	  (reinterpret_cast<char*>(architecture_str.get()));
-
-      xml::xml_char_sptr soname_str =
-	XML_READER_GET_ATTRIBUTE(reader, "soname");
-      string soname;
+      class_or_union_sptr type;
+      for (xmlNodePtr n = node->parent; n && !type; n = n->parent)
+	type = is_class_or_union_type(ctxt.get_decl_for_xml_node(n));
 
-      if (soname_str)
+      if (type && is_function)
 	{
-	  soname = reinterpret_cast<char*>(soname_str.get());
-	  corp.set_soname(soname);
+	  for (class_or_union::member_functions::const_iterator f =
+		 type->get_member_functions().begin();
+	       f != type->get_member_functions().end() && !decl;
+	       ++f)
+	    if ((*f)->get_symbol()
+		&& (*f)->get_symbol()->get_id_string() == symbol_id)
+	      decl = *f;
 	}
-
-      // Apply suppression specifications here to honour:
-      //
-      //   [suppress_file]
-      //     (soname_regexp
-      //      |soname_not_regexp
-      //      |file_name_regexp
-      //      |file_name_not_regexp) = <soname-or-file-name>
-      if ((!soname.empty() || !path.empty())
-	  && ctxt.corpus_is_suppressed_by_soname_or_filename(soname, path))
-	return nil;
-
-      node = xmlTextReaderExpand(reader.get());
-      if (!node)
-	return nil;
-
-      call_reader_next = true;
-    }
-  else
-    {
-      if (!ctxt.get_corpus())
+      else if (type)
 	{
-	  corpus_sptr c(new corpus(ctxt.get_environment(), ""));
-	  ctxt.set_corpus(c);
+	  for (class_or_union::data_members::const_iterator v =
+		 type->get_data_members().begin();
+	       v != type->get_data_members().end() && !decl;
+	       ++v)
+	    if ((*v)->get_symbol()
+		&& (*v)->get_symbol()->get_id_string() == symbol_id)
+	      decl = *v;
 	}
+    }
 
-      if (!ctxt.get_corpus_group())
-	ctxt.clear_per_corpus_data();
+  ctxt.perform_late_type_canonicalizing();
+  ctxt.clear_types_to_canonicalize();
+  ctxt.get_environment()->canonicalization_is_done(true);
 
-      corpus& corp = *ctxt.get_corpus();
-      ctxt.set_exported_decls_builder(corp.get_exported_decls_builder().get());
+  if (decl)
+    decls[symbol_id] = decl;
 
-      xml::xml_char_sptr path_str = XML_NODE_GET_ATTRIBUTE(node, "path");
-      if (path_str)
-	corp.set_path(reinterpret_cast<char*>(path_str.get()));
+  return decl;
+}
 
-      xml::xml_char_sptr architecture_str =
-	XML_NODE_GET_ATTRIBUTE(node, "architecture");
-      if (architecture_str)
-	corp.set_architecture_name
-	  (reinterpret_cast<char*>(architecture_str.get()));
+// </corpus index>
 
-      xml::xml_char_sptr soname_str =
-	XML_NODE_GET_ATTRIBUTE(node, "soname");
-      if (soname_str)
-	corp.set_soname(reinterpret_cast<char*>(soname_str.get()));
-    }
+/// Read an ABI corpus lazily, from an abixml corpus file.
+///
+/// Only the properties of the corpus and its ELF symbols are read
+/// right away.  The corpus file is indexed and the IR of its
+/// functions, variables and types is built only when it's looked up
+/// by lookup_function_from_index(), lookup_variable_from_index() or
+/// lookup_type_from_index().  The functions and variables that are
+/// looked up are added to the corpus.  This makes point queries
+/// against big corpus files much cheaper than reading the whole
+/// corpus.
+///
+/// @param ctxt the read context to use.  It must have been created
+/// with create_native_xml_read_context() from the path to an abixml
+/// corpus file.  It must be kept alive as long as the corpus is
+/// looked up.
+///
+/// @return the corpus read, or nil if the file is not an abixml
+/// corpus file or if the corpus is suppressed.
+corpus_sptr
+read_indexed_corpus_from_input(read_context& ctxt)
+{
+  corpus_sptr nil;
 
-  if (!node->children)
+  if (ctxt.get_path().empty() || ctxt.get_corpus_group())
     return nil;
 
-  ctxt.set_corpus_node(node->children);
-
-  corpus& corp = *ctxt.get_corpus();
-
-  walk_xml_node_to_map_type_ids(ctxt, node);
+  corpus_index_sptr index(new corpus_index);
+  if (!index->map_file(ctxt.get_path()) || !index->scan())
+    return nil;
 
-  // Read the needed element
-  vector<string> needed;
-  read_elf_needed_from_input(ctxt, needed);
-  if (!needed.empty())
-    corp.set_needed(needed);
+  corpus_sptr corp(new corpus(ctxt.get_environment(), ""));
+  ctxt.set_corpus(corp);
+  ctxt.clear_per_corpus_data();
+  ctxt.set_exported_decls_builder(corp->get_exported_decls_builder().get());
+  ctxt.set_corpus_index(index);
 
-  string_elf_symbols_map_sptr fn_sym_db, var_sym_db;
+  xmlNodePtr node = load_corpus_index_element(ctxt, *index, 0);
+  if (!node)
+    {
+      ctxt.set_corpus_index(corpus_index_sptr());
+      return nil;
+    }
 
-  // Read the symbol databases.
-  bool is_ok = read_symbol_db_from_input(ctxt, fn_sym_db, var_sym_db);
-  if (is_ok)
+  string path;
+  if (xml_char_sptr s = XML_NODE_GET_ATTRIBUTE(node, "path"))
     {
-      // Note that it's possible that both fn_sym_db and var_sym_db
-      // are nil, due to potential suppression specifications.  That's
-      // fine.
-      if (fn_sym_db)
-	{
-	  corp.set_fun_symbol_map(fn_sym_db);
-	  fn_sym_db.reset();
-	}
-      if (var_sym_db)
-	{
-	  corp.set_var_symbol_map(var_sym_db);
-	  var_sym_db.reset();
-	}
+      path = CHAR_STR(s);
+      corp->set_path(path);
     }
 
-  ctxt.get_environment()->canonicalization_is_done(false);
+  if (xml_char_sptr s = XML_NODE_GET_ATTRIBUTE(node, "architecture"))
+    corp->set_architecture_name(CHAR_STR(s));
 
-  // Read the translation units.
-  do
+  string soname;
+  if (xml_char_sptr s = XML_NODE_GET_ATTRIBUTE(node, "soname"))
     {
-      translation_unit_sptr tu = read_translation_unit_from_input(ctxt);
-      is_ok = bool(tu);
+      soname = CHAR_STR(s);
+      corp->set_soname(soname);
     }
-  while (is_ok);
 
-  if (ctxt.tracking_non_reachable_types())
+  if ((!soname.empty() || !path.empty())
+      && ctxt.corpus_is_suppressed_by_soname_or_filename(soname, path))
     {
-      bool is_tracking_non_reachable_types = false;
-      read_tracking_non_reachable_types(node, is_tracking_non_reachable_types);
+      ctxt.set_corpus_index(corpus_index_sptr());
+      return nil;
+    }
 
-      ABG_ASSERT
-	(corp.recording_types_reachable_from_public_interface_supported()
-	 == is_tracking_non_reachable_types);
+  if (index->needed != corpus_index::npos)
+    {
+      vector<string> needed;
+      build_needed(load_corpus_index_element(ctxt, *index, index->needed),
+		   needed);
+      if (!needed.empty())
+	corp->set_needed(needed);
     }
 
+  if (index->fn_symbols != corpus_index::npos)
+    if (string_elf_symbols_map_sptr symdb =
+	build_elf_symbol_db(ctxt,
+			    load_corpus_index_element(ctxt, *index,
+						      index->fn_symbols),
+			    /*function_syms=*/true))
+      corp->set_fun_symbol_map(symdb);
 
-  ctxt.perform_late_type_canonicalizing();
+  if (index->var_symbols != corpus_index::npos)
+    if (string_elf_symbols_map_sptr symdb =
+	build_elf_symbol_db(ctxt,
+			    load_corpus_index_element(ctxt, *index,
+						      index->var_symbols),
+			    /*function_syms=*/false))
+      corp->set_var_symbol_map(symdb);
 
-  ctxt.get_environment()->canonicalization_is_done(true);
+  ctxt.set_corpus_node(0);
 
-  corp.set_origin(corpus::NATIVE_XML_ORIGIN);
+  corp->set_origin(corpus::NATIVE_XML_ORIGIN);
 
-  if (call_reader_next)
-    {
-      // This is the necessary counter-part of the xmlTextReaderExpand()
-      // call at the beginning of the function.
-      xmlTextReaderNext(reader.get());
-    }
-  else
-    {
-      node = ctxt.get_corpus_node();
-      node = xml::advance_to_next_sibling_element(node);
-      if (!node)
-	{
-	  node = ctxt.get_corpus_node();
-	  node = xml::advance_to_next_sibling_element(node->parent);
-	}
-      ctxt.set_corpus_node(node);
-    }
+  return corp;
+}
 
-  return ctxt.get_corpus();
+/// Look up a function of a corpus read by
+/// read_indexed_corpus_from_input(), building its IR if needed.
+///
+/// @param ctxt the read context the corpus was read with.
+///
+/// @param symbol_id the id of the ELF symbol of the function, as
+/// returned by elf_symbol::get_id_string().
+///
+/// @return the function found, or nil if there is no function for
+/// @p symbol_id in the corpus.
+function_decl_sptr
+lookup_function_from_index(read_context& ctxt, const string& symbol_id)
+{
+  return is_function_decl(build_decl_from_corpus_index(ctxt, symbol_id,
+						       /*is_function=*/true));
+}
+
+/// Look up a variable of a corpus read by
+/// read_indexed_corpus_from_input(), building its IR if needed.
+///
+/// @param ctxt the read context the corpus was read with.
+///
+/// @param symbol_id the id of the ELF symbol of the variable, as
+/// returned by elf_symbol::get_id_string().
+///
+/// @return the variable found, or nil if there is no variable for
+/// @p symbol_id in the corpus.
+var_decl_sptr
+lookup_variable_from_index(read_context& ctxt, const string& symbol_id)
+{
+  return is_var_decl(build_decl_from_corpus_index(ctxt, symbol_id,
+						  /*is_function=*/false));
+}
+
+/// Look up a type of a corpus read by
+/// read_indexed_corpus_from_input(), building its IR if needed.
+///
+/// @param ctxt the read context the corpus was read with.
+///
+/// @param type_id the id of the type in the corpus file.
+///
+/// @return the type found, or nil if there is no type with id @p
+/// type_id in the corpus file.
+type_base_sptr
+lookup_type_from_index(read_context& ctxt, const string& type_id)
+{
+  type_base_sptr nil;
+
+  const corpus_index_sptr& index = ctxt.get_corpus_index();
+  if (!index)
+    return nil;
+
+  if (type_base_sptr t = ctxt.get_type_decl(type_id))
+    return t;
+
+  if (!ctxt.get_xml_node_from_id(type_id)
+      && index->type_ids.find(type_id) == index->type_ids.end())
+    return nil;
+
+  ctxt.get_environment()->canonicalization_is_done(false);
+  type_base_sptr t = ctxt.build_or_get_type_decl(type_id, true);
+  ctxt.perform_late_type_canonicalizing();
+  ctxt.clear_types_to_canonicalize();
+  ctxt.get_environment()->canonicalization_is_done(true);
+
+  return t;
 }
 
 /// Parse the input XML document containing an ABI corpus group,
@@ -5942,6 +7396,9 @@ read_corpus_from_file(const string& path)
 
 /// Create an xml_reader::read_context to read a native XML ABI file.
 ///
+/// The file can also be a corpus in the binary corpus format, as
+/// emitted by xml_writer::write_corpus_to_binary().
+///
 /// @param path the path to the native XML file to read.
 ///
 /// @param env the environment to use.
@@ -6003,9 +7460,63 @@ read_corpus_from_native_xml(std::istream* in,
   return read_corpus_from_input(*read_ctxt);
 }
 
+/// De-serialize an ABI corpus from an in-memory XML document which
+/// root node is 'abi-corpus'.
+///
+/// The buffer can also hold a corpus in the binary corpus format, as
+/// emitted by xml_writer::write_corpus_to_binary().
+///
+/// This is useful to read back a corpus that was just serialized in
+/// memory, without going through a file.
+///
+/// @param buffer the buffer holding the XML document.
+///
+/// @param env the environment to use.  Note that the life time of
+/// this environment must be greater than the lifetime of the
+/// resulting corpus as the corpus uses resources that are allocated
+/// in the environment.
+///
+/// @return the resulting corpus de-serialized from the parsing.  This
+/// is non-null iff the parsing resulted in a valid corpus.
+corpus_sptr
+read_corpus_from_native_xml_buffer(const string& buffer,
+				   environment* env)
+{
+  corpus_sptr corp;
+
+  xmlDocPtr doc = 0;
+  if (xml::is_binary_tree(buffer.data(), buffer.size()))
+    {
+      doc = xml::read_binary_tree(buffer.data(), buffer.size());
+      xmlNodePtr root = doc ? xmlDocGetRootElement(doc) : 0;
+      if (!root || !xmlStrEqual(root->name, BAD_CAST("abi-corpus")))
+	{
+	  if (doc)
+	    xmlFreeDoc(doc);
+	  return corp;
+	}
+    }
+
+  {
+    read_context ctxt(xml::new_reader_from_buffer(buffer), env);
+    ctxt.set_corpus(corpus_sptr(new corpus(env, "")));
+    if (doc)
+      ctxt.set_corpus_node(xmlDocGetRootElement(doc));
+    corp = read_corpus_from_input(ctxt);
+  }
+
+  if (doc)
+    xmlFreeDoc(doc);
+
+  return corp;
+}
+
 /// De-serialize an ABI corpus from an XML document file which root
 /// node is 'abi-corpus'.
 ///
+/// The file can also be a corpus in the binary corpus format, as
+/// emitted by xml_writer::write_corpus_to_binary().
+///
 /// @param path the path to the input file to read the XML document
 /// from.
 ///
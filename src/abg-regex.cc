@@ -10,8 +10,13 @@
 
 #include "config.h"
 
+#include <pthread.h>
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <ostream>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "abg-internal.h"
 
@@ -53,6 +58,371 @@ sptr_utils::build_sptr<regex_t>()
 namespace regex
 {
 
+/// The characters that have a special meaning in a POSIX extended
+/// regular expression.
+static const char special_chars[] = "^.[]$()|*+?{}\\";
+
+/// Matches strings against a compiled regular expression.
+///
+/// Most of the regular expressions found in suppression
+/// specifications are either of the form "^prefix.*", "foo.*bar",
+/// "(^std::.*|WebKit::.*)", or are alternations of exact names like
+/// the ones generated by generate_from_strings().  Strings are
+/// matched against these without going through regexec, which is
+/// comparatively slow.
+///
+/// A regular expression that doesn't belong to that subset is
+/// matched using regexec, and the result of the match is cached, as
+/// the same strings (type names, symbol names, etc) tend to be
+/// matched against a given regular expression again and again.
+class matcher
+{
+  /// A branch of an alternation of the subset of regular
+  /// expressions handled without regexec.
+  ///
+  /// The branch is made of literal strings separated by ".*".
+  struct branch
+  {
+    /// Whether the branch must match at the start of the string.
+    bool			anchored_at_start;
+    /// Whether the branch must match at the end of the string.
+    bool			anchored_at_end;
+    /// The literal strings separated by ".*".
+    std::vector<std::string>	parts;
+
+    branch()
+      : anchored_at_start(),
+	anchored_at_end()
+    {}
+  }; // end struct branch
+
+  /// The maximum number of entries of the cache of results of
+  /// regexec.
+  static const size_t max_cache_size = 4096;
+
+  bool					is_simple_;
+  std::unordered_set<std::string>	exact_strings_;
+  std::vector<branch>			branches_;
+  std::unordered_map<std::string, bool>	cache_;
+  // Protects @ref cache_, as a regex can be shared by several
+  // threads; e.g, by the comparison tasks of abipkgdiff.
+  pthread_mutex_t			cache_mutex_;
+
+  static bool
+  is_special(char c)
+  {return c && strchr(special_chars, c);}
+
+  static bool
+  ends_with_anchor(const std::string& str);
+
+  static bool
+  parse_branch(const std::string& str,
+	       bool anchored_at_start,
+	       bool anchored_at_end,
+	       branch& result);
+
+  bool
+  parse_alternation(const std::string& str,
+		    bool anchored_at_start,
+		    bool anchored_at_end);
+
+  static bool
+  match_branch(const branch& b, const std::string& str);
+
+public:
+
+  matcher(const std::string& pattern);
+
+  ~matcher()
+  {pthread_mutex_destroy(&cache_mutex_);}
+
+  bool
+  match(const regex_t& r, const std::string& str);
+}; // end class matcher
+
+/// Test if a regular expression ends with a non-escaped '$'.
+///
+/// @param str the regular expression to consider.
+///
+/// @return true iff @p str ends with a '$' anchor.
+bool
+matcher::ends_with_anchor(const std::string& str)
+{
+  if (str.empty() || str[str.size() - 1] != '$')
+    return false;
+
+  size_t num_backslashes = 0;
+  for (size_t i = str.size() - 1; i > 0 && str[i - 1] == '\\'; --i)
+    ++num_backslashes;
+  return num_backslashes % 2 == 0;
+}
+
+/// Parse a branch of an alternation, if it's made of literal strings
+/// separated by ".*".
+///
+/// @param str the text of the branch.
+///
+/// @param anchored_at_start whether the branch is anchored at the
+/// start of the string by the enclosing regular expression.
+///
+/// @param anchored_at_end whether the branch is anchored at the end
+/// of the string by the enclosing regular expression.
+///
+/// @param result output parameter.  This is set to the parsed
+/// branch.
+///
+/// @return true iff @p str could be parsed.
+bool
+matcher::parse_branch(const std::string& str,
+		      bool anchored_at_start,
+		      bool anchored_at_end,
+		      branch& result)
+{
+  std::string text = str;
+  if (!text.empty() && text[0] == '^')
+    {
+      anchored_at_start = true;
+      text.erase(0, 1);
+    }
+  if (ends_with_anchor(text))
+    {
+      anchored_at_end = true;
+      text.erase(text.size() - 1);
+    }
+  if (text.empty())
+    return false;
+
+  result = branch();
+  result.anchored_at_start = anchored_at_start;
+  result.anchored_at_end = anchored_at_end;
+
+  std::string part;
+  bool leading_wildcard = false, trailing_wildcard = false;
+  for (size_t i = 0; i < text.size(); ++i)
+    {
+      char c = text[i];
+      trailing_wildcard = false;
+      if (c == '\\')
+	{
+	  // Only escaped special characters are known to stand for
+	  // themselves.
+	  if (!is_special(text[i + 1]))
+	    return false;
+	  part += text[++i];
+	}
+      else if (c == '.' && text[i + 1] == '*')
+	{
+	  ++i;
+	  if (!part.empty())
+	    {
+	      result.parts.push_back(part);
+	      part.clear();
+	    }
+	  else if (result.parts.empty())
+	    leading_wildcard = true;
+	  trailing_wildcard = true;
+	}
+      else if (is_special(c))
+	return false;
+      else
+	part += c;
+    }
+  if (!part.empty())
+    result.parts.push_back(part);
+
+  if (leading_wildcard)
+    result.anchored_at_start = false;
+  if (trailing_wildcard)
+    result.anchored_at_end = false;
+
+  return true;
+}
+
+/// Parse an alternation of branches made of literal strings
+/// separated by ".*".
+///
+/// @param str the text of the alternation.
+///
+/// @param anchored_at_start whether the alternation is anchored at
+/// the start of the string by the enclosing regular expression.
+///
+/// @param anchored_at_end whether the alternation is anchored at the
+/// end of the string by the enclosing regular expression.
+///
+/// @return true iff @p str could be parsed.
+bool
+matcher::parse_alternation(const std::string& str,
+			   bool anchored_at_start,
+			   bool anchored_at_end)
+{
+  std::string text;
+  for (size_t i = 0; i <= str.size(); ++i)
+    {
+      if (i < str.size() && str[i] == '\\')
+	{
+	  text += str[i];
+	  if (++i < str.size())
+	    text += str[i];
+	  continue;
+	}
+
+      if (i < str.size() && str[i] != '|')
+	{
+	  text += str[i];
+	  continue;
+	}
+
+      branch b;
+      if (!parse_branch(text, anchored_at_start, anchored_at_end, b))
+	return false;
+      text.clear();
+
+      if (b.anchored_at_start && b.anchored_at_end && b.parts.size() == 1)
+	exact_strings_.insert(b.parts[0]);
+      else
+	branches_.push_back(b);
+    }
+  return true;
+}
+
+/// Test if a string matches a branch made of literal strings
+/// separated by ".*".
+///
+/// @param b the branch to consider.
+///
+/// @param str the string to consider.
+///
+/// @return true iff @p str matches @p b.
+bool
+matcher::match_branch(const branch& b, const std::string& str)
+{
+  size_t begin = 0, end = str.size();
+  size_t first = 0, last = b.parts.size();
+
+  if (b.parts.empty())
+    return !(b.anchored_at_start && b.anchored_at_end) || str.empty();
+
+  if (b.anchored_at_start)
+    {
+      const std::string& part = b.parts[first++];
+      if (str.compare(0, part.size(), part) != 0)
+	return false;
+      begin = part.size();
+    }
+
+  if (b.anchored_at_end)
+    {
+      if (first == last)
+	// The only literal string of the branch must then be the
+	// whole string.
+	return begin == end;
+      const std::string& part = b.parts[--last];
+      if (part.size() > end - begin
+	  || str.compare(end - part.size(), part.size(), part) != 0)
+	return false;
+      end -= part.size();
+    }
+
+  for (size_t i = first; i < last; ++i)
+    {
+      const std::string& part = b.parts[i];
+      size_t pos = str.find(part, begin);
+      if (pos == std::string::npos || pos + part.size() > end)
+	return false;
+      begin = pos + part.size();
+    }
+
+  return true;
+}
+
+/// Constructor of @ref matcher.
+///
+/// @param pattern the regular expression to match strings against.
+matcher::matcher(const std::string& pattern)
+  : is_simple_()
+{
+  pthread_mutex_init(&cache_mutex_, /*attr=*/0);
+
+  // A regular expression of the form "^(foo|bar)$" is an alternation
+  // which branches are all anchored.
+  std::string inner = pattern;
+  bool anchored_at_start = false, anchored_at_end = false;
+  if (!inner.empty() && inner[0] == '^')
+    {
+      anchored_at_start = true;
+      inner.erase(0, 1);
+    }
+  if (ends_with_anchor(inner))
+    {
+      anchored_at_end = true;
+      inner.erase(inner.size() - 1);
+    }
+
+  bool is_group = (inner.size() >= 2
+		   && inner[0] == '('
+		   && inner[inner.size() - 1] == ')'
+		   && inner[inner.size() - 2] != '\\');
+  if (is_group)
+    inner = inner.substr(1, inner.size() - 2);
+  else
+    {
+      // The anchors, if any, only apply to the first and last
+      // branches of the alternation.
+      inner = pattern;
+      anchored_at_start = anchored_at_end = false;
+    }
+
+  is_simple_ = parse_alternation(inner, anchored_at_start, anchored_at_end);
+  if (!is_simple_)
+    {
+      exact_strings_.clear();
+      branches_.clear();
+    }
+}
+
+/// Test if a string matches the regular expression of the current
+/// instance of @ref matcher.
+///
+/// @param r the compiled form of the regular expression.
+///
+/// @param str the string to consider.
+///
+/// @return true iff @p str matches the regular expression.
+bool
+matcher::match(const regex_t& r, const std::string& str)
+{
+  if (is_simple_)
+    {
+      if (!exact_strings_.empty()
+	  && exact_strings_.find(str) != exact_strings_.end())
+	return true;
+      for (std::vector<branch>::const_iterator i = branches_.begin();
+	   i != branches_.end();
+	   ++i)
+	if (match_branch(*i, str))
+	  return true;
+      return false;
+    }
+
+  pthread_mutex_lock(&cache_mutex_);
+  std::unordered_map<std::string, bool>::const_iterator i = cache_.find(str);
+  bool is_cached = i != cache_.end();
+  bool result = is_cached && i->second;
+  pthread_mutex_unlock(&cache_mutex_);
+  if (is_cached)
+    return result;
+
+  result = !regexec(&r, str.c_str(), 0, NULL, 0);
+
+  pthread_mutex_lock(&cache_mutex_);
+  if (cache_.size() >= max_cache_size)
+    cache_.clear();
+  cache_[str] = result;
+  pthread_mutex_unlock(&cache_mutex_);
+
+  return result;
+}
+
 /// Escape regex special charaters in input string.
 ///
 /// @param os the output stream being written to.
@@ -104,16 +474,180 @@ generate_from_strings(const std::vector<std::string>& strs)
 /// The result is held in a shared pointer. This will be null if regex
 /// compilation fails.
 ///
+/// The deleter of the shared pointer holds the @ref matcher that
+/// regex::match() uses to match strings against the regex.
+///
 /// @param str the string representation of the regex.
 ///
 /// @return shared pointer holder of a compiled regex object.
 regex_t_sptr
 compile(const std::string& str)
 {
-  regex_t_sptr r = sptr_utils::build_sptr(new regex_t);
-  if (regcomp(r.get(), str.c_str(), REG_EXTENDED))
-    r.reset();
-  return r;
+  regex_t* p = new regex_t;
+  if (regcomp(p, str.c_str(), REG_EXTENDED))
+    {
+      delete p;
+      return regex_t_sptr();
+    }
+  return regex_t_sptr(p, regex_t_deleter(matcher_sptr(new matcher(str))));
+}
+
+/// Test if a regular expression contains a back-reference, like
+/// "\\1".
+///
+/// @param str the regular expression to consider.
+///
+/// @return true iff @p str contains a back-reference.
+static bool
+has_back_reference(const std::string& str)
+{
+  for (size_t i = 0; i + 1 < str.size(); ++i)
+    if (str[i] == '\\')
+      {
+	if (str[i + 1] >= '1' && str[i + 1] <= '9')
+	  return true;
+	++i;
+      }
+  return false;
+}
+
+/// The maximum number of regular expressions compiled into a single
+/// alternation by compile_alternation().
+///
+/// The time regcomp takes to compile an alternation grows faster than
+/// the number of its branches.  So larger sets of regular expressions
+/// are split into several alternations of at most that many
+/// branches.
+static const size_t MAX_ALTERNATION_SIZE = 256;
+
+/// Compile a chunk of a set of regular expressions into a single
+/// alternation.
+///
+/// @param patterns the regular expressions of the chunk.  They all
+/// compile on their own.
+///
+/// @param compiled the compiled forms of @p patterns, in the same
+/// order.
+///
+/// @param result output parameter.  The resulting compiled regular
+/// expressions are added to this.
+static void
+compile_alternation_chunk(const std::vector<std::string>& patterns,
+			  const std::vector<regex_t_sptr>& compiled,
+			  std::vector<regex_t_sptr>& result)
+{
+  if (compiled.size() > 1)
+    {
+      std::ostringstream alternation;
+      for (std::vector<std::string>::const_iterator i = patterns.begin();
+	   i != patterns.end();
+	   ++i)
+	{
+	  if (i != patterns.begin())
+	    alternation << '|';
+	  alternation << *i;
+	}
+      if (regex_t_sptr r = compile(alternation.str()))
+	{
+	  result.push_back(r);
+	  return;
+	}
+    }
+
+  result.insert(result.end(), compiled.begin(), compiled.end());
+}
+
+/// Order the regular expressions that are compiled into
+/// alternations by compile_alternation().
+///
+/// The regular expressions anchored at the beginning of the string
+/// come first, and are otherwise ordered lexicographically.
+///
+/// @param l the first regular expression to consider, along with its
+/// compiled form.
+///
+/// @param r the second regular expression to consider, along with its
+/// compiled form.
+///
+/// @return true iff @p l comes before @p r.
+static bool
+alternative_precedes(const std::pair<std::string, regex_t_sptr>& l,
+		     const std::pair<std::string, regex_t_sptr>& r)
+{
+  bool l_is_anchored = l.first[0] == '^', r_is_anchored = r.first[0] == '^';
+  if (l_is_anchored != r_is_anchored)
+    return l_is_anchored;
+  return l.first < r.first;
+}
+
+/// Compile a set of regular expressions into as few compiled regular
+/// expressions as possible.
+///
+/// The regular expressions are compiled into alternations of at most
+/// MAX_ALTERNATION_SIZE branches, so that a string is matched against
+/// many of them in one go.  A string matches one of the regular
+/// expressions of the set iff it matches one of the resulting
+/// compiled regular expressions.
+///
+/// The regular expressions that don't compile are ignored.  Those
+/// that cannot be part of an alternation, e.g, because they contain
+/// back-references, are compiled on their own.
+///
+/// @param patterns the regular expressions to compile.
+///
+/// @param result output parameter.  The resulting compiled regular
+/// expressions are added to this.
+void
+compile_alternation(const std::vector<std::string>& patterns,
+		    std::vector<regex_t_sptr>& result)
+{
+  std::vector<std::pair<std::string, regex_t_sptr> > alternatives;
+  for (std::vector<std::string>::const_iterator i = patterns.begin();
+       i != patterns.end();
+       ++i)
+    {
+      regex_t_sptr r = compile(*i);
+      if (!r)
+	continue;
+
+      if (i->empty() || has_back_reference(*i))
+	{
+	  // An empty branch in an alternation is not portable, and the
+	  // groups the back-references refer to are renumbered in an
+	  // alternation.
+	  result.push_back(r);
+	  continue;
+	}
+
+      alternatives.push_back(std::make_pair(*i, r));
+    }
+
+  // Sorting the regular expressions puts those anchored at the
+  // beginning of the string together, and groups them by their
+  // leading characters.  The set of characters an alternation can
+  // start a match with is thus kept small, and regexec quickly
+  // rejects the strings that cannot match it.
+  std::sort(alternatives.begin(), alternatives.end(),
+	    alternative_precedes);
+
+  std::vector<std::string> chunk;
+  std::vector<regex_t_sptr> compiled_chunk;
+  for (std::vector<std::pair<std::string, regex_t_sptr> >::const_iterator i =
+	 alternatives.begin();
+       i != alternatives.end();
+       ++i)
+    {
+      chunk.push_back(i->first);
+      compiled_chunk.push_back(i->second);
+      if (chunk.size() == MAX_ALTERNATION_SIZE)
+	{
+	  compile_alternation_chunk(chunk, compiled_chunk, result);
+	  chunk.clear();
+	  compiled_chunk.clear();
+	}
+    }
+
+  compile_alternation_chunk(chunk, compiled_chunk, result);
 }
 
 /// See if a string matches a regex.
@@ -126,6 +660,9 @@ compile(const std::string& str)
 bool
 match(const regex_t_sptr& r, const std::string& str)
 {
+  if (regex_t_deleter* d = std::get_deleter<regex_t_deleter>(r))
+    if (d->matcher_)
+      return d->matcher_->match(*r, str);
   return !regexec(r.get(), str.c_str(), 0, NULL, 0);
 }
 
@@ -1350,30 +1350,26 @@ maybe_report_interfaces_impacted_by_diff(const diff	*d,
     return;
 
   const diff_maps &maps = corp_diff->get_leaf_diffs();
-  artifact_sptr_set_type* impacted_artifacts =
-    maps.lookup_impacted_interfaces(d);
-  if (impacted_artifacts == 0)
+  vector<size_t> impacted_interfaces;
+  size_t num_impacted_interfaces =
+    maps.lookup_impacted_interfaces(d, impacted_interfaces);
+  if (num_impacted_interfaces == 0)
     return;
 
-  if (impacted_artifacts->empty())
-    return;
-
-  vector<type_or_decl_base_sptr> sorted_impacted_interfaces;
-  sort_artifacts_set(*impacted_artifacts, sorted_impacted_interfaces);
-
-  size_t num_impacted_interfaces = impacted_artifacts->size();
   if (num_impacted_interfaces == 1)
     out << indent << "one impacted interface:\n";
   else
     out << indent << num_impacted_interfaces << " impacted interfaces:\n";
 
   string cur_indent = indent + "  ";
-  vector<type_or_decl_base_sptr>::const_iterator it;
-  for (it = sorted_impacted_interfaces.begin();
-       it != sorted_impacted_interfaces.end();
+  vector<size_t>::const_iterator it;
+  for (it = impacted_interfaces.begin();
+       it != impacted_interfaces.end();
        ++it)
     {
-      out << cur_indent << get_pretty_representation(*it) << "\n";
+      out << cur_indent
+	  << maps.get_impacted_interface_pretty_representation(*it)
+	  << "\n";
     }
 }
 
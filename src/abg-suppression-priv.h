@@ -13,6 +13,8 @@
 #ifndef __ABG_SUPPRESSION_PRIV_H__
 #define __ABG_SUPPRESSION_PRIV_H__
 
+#include <pthread.h>
+
 #include "abg-fwd.h"
 #include "abg-regex.h"
 #include "abg-sptr-utils.h"
@@ -201,6 +203,146 @@ public:
 
 // </suppression_base stuff>
 
+// <suppressions_index stuff>
+
+/// An index of the function, variable and type suppression
+/// specifications of a set of suppression specifications.
+///
+/// Each function, variable and type of the corpus being read is
+/// evaluated against the suppression specifications, to know if it's
+/// suppressed.  Evaluating all the suppression specifications for
+/// each artifact is costly when there are many of them.
+///
+/// This index thus buckets the suppression specifications by the
+/// exact name they designate artifacts with.  An artifact is then
+/// evaluated only against the suppression specifications of the
+/// bucket of its name, and against those that don't designate
+/// artifacts by an exact name, e.g, those that use a regular
+/// expression.
+class suppressions_index
+{
+public:
+  /// The positions of some suppression specifications in the indexed
+  /// set of suppression specifications, in increasing order.
+  typedef vector<size_t> positions_type;
+
+  /// An index of suppression specifications by the name of the
+  /// artifacts they can match.
+  class name_index
+  {
+    unordered_map<string, positions_type>	buckets_;
+    positions_type				others_;
+
+  public:
+
+    /// Add a suppression specification that can only match artifacts
+    /// of a given name.
+    ///
+    /// @param name the name of the artifacts the suppression
+    /// specification can match.
+    ///
+    /// @param position the position of the suppression specification.
+    void
+    add(const string& name, size_t position)
+    {buckets_[name].push_back(position);}
+
+    /// Add a suppression specification that can match artifacts of
+    /// any name.
+    ///
+    /// @param position the position of the suppression specification.
+    void
+    add_other(size_t position)
+    {others_.push_back(position);}
+
+    void
+    finish();
+
+    /// Getter of the suppression specifications that can match an
+    /// artifact of a given name.
+    ///
+    /// @param name the name of the artifact to consider.
+    ///
+    /// @return the positions of the suppression specifications that
+    /// can match an artifact named @p name.
+    const positions_type&
+    lookup(const string& name) const
+    {
+      unordered_map<string, positions_type>::const_iterator i =
+	buckets_.find(name);
+      if (i == buckets_.end())
+	return others_;
+      return i->second;
+    }
+
+    /// Clear the index.
+    void
+    clear()
+    {
+      buckets_.clear();
+      others_.clear();
+    }
+  }; // end class name_index
+
+private:
+  suppressions_type	suppressions_;
+  name_index		function_names_;
+  name_index		function_symbol_names_;
+  name_index		variable_names_;
+  name_index		variable_symbol_names_;
+  name_index		type_names_;
+  bool			is_up_to_date_;
+
+public:
+
+  /// Default constructor of @ref suppressions_index.
+  suppressions_index()
+    : is_up_to_date_(false)
+  {}
+
+  /// Mark the index as out of date, e.g, because the indexed set of
+  /// suppression specifications changed.
+  void
+  invalidate()
+  {is_up_to_date_ = false;}
+
+  void
+  update(const suppressions_type& suppressions);
+
+  /// Getter of the indexed suppression specifications.
+  ///
+  /// @return the indexed suppression specifications.
+  const suppressions_type&
+  get_suppressions() const
+  {return suppressions_;}
+
+  /// Getter of the index of function suppressions by function name.
+  const name_index&
+  get_function_names_index() const
+  {return function_names_;}
+
+  /// Getter of the index of function suppressions by symbol name.
+  const name_index&
+  get_function_symbol_names_index() const
+  {return function_symbol_names_;}
+
+  /// Getter of the index of variable suppressions by variable name.
+  const name_index&
+  get_variable_names_index() const
+  {return variable_names_;}
+
+  /// Getter of the index of variable suppressions by symbol name.
+  const name_index&
+  get_variable_symbol_names_index() const
+  {return variable_symbol_names_;}
+
+  /// Getter of the index of type suppressions by type name.
+  const name_index&
+  get_type_names_index() const
+  {return type_names_;}
+}; // end class suppressions_index
+
+// </suppressions_index stuff>
+
 // <function_suppression stuff>
 
 class function_suppression::parameter_spec::priv
@@ -256,6 +398,7 @@ struct function_suppression::priv
   mutable regex::regex_t_sptr		symbol_name_regex_;
   string				symbol_name_not_regex_str_;
   mutable regex::regex_t_sptr		symbol_name_not_regex_;
+  unordered_set<string>			symbol_names_to_keep_;
   string				symbol_version_;
   string				symbol_version_regex_str_;
   mutable regex::regex_t_sptr		symbol_version_regex_;
@@ -374,6 +517,21 @@ struct function_suppression::priv
     return symbol_name_not_regex_;
   }
 
+  /// Test if a symbol name is in the set of names of symbols to keep,
+  /// i.e, in function_suppression::priv::symbol_names_to_keep_.
+  ///
+  /// @param sym_name the symbol name to consider.
+  ///
+  /// @return true iff @p sym_name is in the set of names of symbols
+  /// to keep.
+  bool
+  symbol_name_is_kept(const string& sym_name) const
+  {
+    return (!symbol_names_to_keep_.empty()
+	    && symbol_names_to_keep_.find(sym_name)
+	    != symbol_names_to_keep_.end());
+  }
+
   /// Getter for a pointer to a regular expression object built from
   /// the regular expression string
   /// function_suppression::priv::symbol_version_regex_str_.
@@ -437,22 +595,46 @@ function_is_suppressed(const ReadContextType&	ctxt,
 		       const string&		fn_linkage_name,
 		       bool			require_drop_property = false)
 {
-  for (suppr::suppressions_type::const_iterator i =
-	 ctxt.get_suppressions().begin();
-       i != ctxt.get_suppressions().end();
-       ++i)
-    if (suppr::function_suppression_sptr suppr = is_function_suppression(*i))
-      {
-	if (require_drop_property && !(*i)->get_drops_artifact_from_ir())
-	  continue;
-	if (!fn_name.empty()
-	    && ctxt.suppression_matches_function_name(*suppr, fn_name))
-	  return true;
-	if (!fn_linkage_name.empty()
-	    && ctxt.suppression_matches_function_sym_name(*suppr,
-							  fn_linkage_name))
-	  return true;
-      }
+  const suppressions_index& index = ctxt.get_suppressions_index();
+  const suppressions_type& supprs = index.get_suppressions();
+
+  if (!fn_name.empty())
+    {
+      const suppressions_index::positions_type& positions =
+	index.get_function_names_index().lookup(fn_name);
+      for (suppressions_index::positions_type::const_iterator i =
+	     positions.begin();
+	   i != positions.end();
+	   ++i)
+	{
+	  const function_suppression& suppr =
+	    static_cast<const function_suppression&>(*supprs[*i]);
+	  if (require_drop_property && !suppr.get_drops_artifact_from_ir())
+	    continue;
+	  if (ctxt.suppression_matches_function_name(suppr, fn_name))
+	    return true;
+	}
+    }
+
+  if (!fn_linkage_name.empty())
+    {
+      const suppressions_index::positions_type& positions =
+	index.get_function_symbol_names_index().lookup(fn_linkage_name);
+      for (suppressions_index::positions_type::const_iterator i =
+	     positions.begin();
+	   i != positions.end();
+	   ++i)
+	{
+	  const function_suppression& suppr =
+	    static_cast<const function_suppression&>(*supprs[*i]);
+	  if (require_drop_property && !suppr.get_drops_artifact_from_ir())
+	    continue;
+	  if (ctxt.suppression_matches_function_sym_name(suppr,
+							 fn_linkage_name))
+	    return true;
+	}
+    }
+
   return false;
 }
 // </function_suppression stuff>
@@ -475,6 +657,7 @@ struct variable_suppression::priv
   mutable regex::regex_t_sptr		symbol_name_regex_;
   string				symbol_name_not_regex_str_;
   mutable regex::regex_t_sptr		symbol_name_not_regex_;
+  unordered_set<string>			symbol_names_to_keep_;
   string				symbol_version_;
   string				symbol_version_regex_str_;
   mutable regex::regex_t_sptr		symbol_version_regex_;
@@ -569,6 +752,21 @@ struct variable_suppression::priv
     return symbol_name_not_regex_;
   }
 
+  /// Test if a symbol name is in the set of names of symbols to keep,
+  /// i.e, in variable_suppression::priv::symbol_names_to_keep_.
+  ///
+  /// @param sym_name the symbol name to consider.
+  ///
+  /// @return true iff @p sym_name is in the set of names of symbols
+  /// to keep.
+  bool
+  symbol_name_is_kept(const string& sym_name) const
+  {
+    return (!symbol_names_to_keep_.empty()
+	    && symbol_names_to_keep_.find(sym_name)
+	    != symbol_names_to_keep_.end());
+  }
+
   /// Getter for a pointer to a regular expression object built from
   /// the regular expression string
   /// variable_suppression::priv::symbol_version_regex_str_.
@@ -611,28 +809,94 @@ variable_is_suppressed(const ReadContextType&	ctxt,
 		       const string&		var_linkage_name,
 		       bool			require_drop_property = false)
 {
-  for (suppr::suppressions_type::const_iterator i =
-	 ctxt.get_suppressions().begin();
-       i != ctxt.get_suppressions().end();
-       ++i)
-    if (suppr::variable_suppression_sptr suppr = is_variable_suppression(*i))
-      {
-	if (require_drop_property && !(*i)->get_drops_artifact_from_ir())
-	  continue;
-	if (!var_name.empty()
-	    && ctxt.suppression_matches_variable_name(*suppr, var_name))
-	  return true;
-	if (!var_linkage_name.empty()
-	    && ctxt.suppression_matches_variable_sym_name(*suppr,
-							  var_linkage_name))
-	  return true;
-      }
+  const suppressions_index& index = ctxt.get_suppressions_index();
+  const suppressions_type& supprs = index.get_suppressions();
+
+  if (!var_name.empty())
+    {
+      const suppressions_index::positions_type& positions =
+	index.get_variable_names_index().lookup(var_name);
+      for (suppressions_index::positions_type::const_iterator i =
+	     positions.begin();
+	   i != positions.end();
+	   ++i)
+	{
+	  const variable_suppression& suppr =
+	    static_cast<const variable_suppression&>(*supprs[*i]);
+	  if (require_drop_property && !suppr.get_drops_artifact_from_ir())
+	    continue;
+	  if (ctxt.suppression_matches_variable_name(suppr, var_name))
+	    return true;
+	}
+    }
+
+  if (!var_linkage_name.empty())
+    {
+      const suppressions_index::positions_type& positions =
+	index.get_variable_symbol_names_index().lookup(var_linkage_name);
+      for (suppressions_index::positions_type::const_iterator i =
+	     positions.begin();
+	   i != positions.end();
+	   ++i)
+	{
+	  const variable_suppression& suppr =
+	    static_cast<const variable_suppression&>(*supprs[*i]);
+	  if (require_drop_property && !suppr.get_drops_artifact_from_ir())
+	    continue;
+	  if (ctxt.suppression_matches_variable_sym_name(suppr,
+							 var_linkage_name))
+	    return true;
+	}
+    }
+
   return false;
 }
 
 // </variable_suppression stuff>
 
 // <type_suppression stuff>
+
+/// A matcher of the file paths of the source locations of the types
+/// that a @ref type_suppression must keep.
+///
+/// Those file paths are designated by the 'source_location_not_in'
+/// property, which can hold thousands of header file names when it's
+/// generated from a headers directory, and by the
+/// 'source_location_not_regexp' property.
+///
+/// A file path matches if it or its base name is in the set of file
+/// paths, or if it matches the regular expression.  File paths are
+/// compared after normalization, e.g, "./foo//bar.h" and "foo/bar.h"
+/// are the same file path.
+///
+/// As the types of a given file are many, the verdict about a file
+/// path is cached.
+class path_set_matcher
+{
+  unordered_set<string>			paths_;
+  regex::regex_t_sptr			regex_;
+  mutable unordered_map<string, bool>	verdicts_;
+  // Protects verdicts_, as the suppression specifications can be
+  // shared by several reading threads.
+  mutable pthread_mutex_t		verdicts_mutex_;
+
+  path_set_matcher();
+  path_set_matcher(const path_set_matcher&);
+  path_set_matcher& operator=(const path_set_matcher&);
+
+public:
+  path_set_matcher(const unordered_set<string>&	paths,
+		   const regex::regex_t_sptr&	regex);
+
+  ~path_set_matcher();
+
+  bool
+  matches(const string& path) const;
+}; // end class path_set_matcher
+
+/// Convenience typedef for a shared pointer to @ref path_set_matcher.
+typedef shared_ptr<path_set_matcher> path_set_matcher_sptr;
+
 /// The private data for @ref type_suppression.
 class type_suppression::priv
 {
@@ -649,6 +913,10 @@ class type_suppression::priv
   unordered_set<string>			source_locations_to_keep_;
   string				source_location_to_keep_regex_str_;
   mutable regex::regex_t_sptr		source_location_to_keep_regex_;
+  mutable path_set_matcher_sptr		source_locations_to_keep_matcher_;
+  // Protects source_locations_to_keep_matcher_, as the suppression
+  // specifications can be shared by several reading threads.
+  mutable pthread_mutex_t		source_locations_to_keep_matcher_mutex_;
   mutable vector<string>		changed_enumerator_names_;
 
   priv();
@@ -666,7 +934,10 @@ public:
       type_kind_(type_kind),
       consider_reach_kind_(consider_reach_kind),
       reach_kind_(reach_kind)
-  {}
+  {pthread_mutex_init(&source_locations_to_keep_matcher_mutex_, /*attr=*/0);}
+
+  ~priv()
+  {pthread_mutex_destroy(&source_locations_to_keep_matcher_mutex_);}
 
   /// Get the regular expression object associated to the 'type_name_regex'
   /// property of @ref type_suppression.
@@ -734,7 +1005,8 @@ public:
 
   /// Getter for the source_location_to_keep_regex object.
   ///
-  /// This function builds the regex if it's not yet built.
+  /// This function builds the regex if it's not yet built.  It must
+  /// be called with source_locations_to_keep_matcher_mutex_ held.
   const regex::regex_t_sptr
   get_source_location_to_keep_regex() const
   {
@@ -750,7 +1022,51 @@ public:
   /// @param r the new regex object.
   void
   set_source_location_to_keep_regex(regex::regex_t_sptr r)
-  {source_location_to_keep_regex_ = r;}
+  {
+    pthread_mutex_lock(&source_locations_to_keep_matcher_mutex_);
+    source_location_to_keep_regex_ = r;
+    source_locations_to_keep_matcher_.reset();
+    pthread_mutex_unlock(&source_locations_to_keep_matcher_mutex_);
+  }
+
+  /// Discard the matcher of the file paths designated by the
+  /// source_locations_to_keep and source_location_to_keep_regex
+  /// properties, so that it's re-built from the current values of
+  /// these properties the next time it's needed.
+  void
+  invalidate_source_locations_to_keep_matcher()
+  {
+    pthread_mutex_lock(&source_locations_to_keep_matcher_mutex_);
+    source_locations_to_keep_matcher_.reset();
+    pthread_mutex_unlock(&source_locations_to_keep_matcher_mutex_);
+  }
+
+  /// Getter for the matcher of the file paths designated by the
+  /// source_locations_to_keep and source_location_to_keep_regex
+  /// properties.
+  ///
+  /// This function builds the matcher if it's not yet built.  The
+  /// setters of these properties, as well as the non-const
+  /// type_suppression::get_source_locations_to_keep() which lets the
+  /// set of file paths be modified in place, discard the matcher.
+  ///
+  /// @return the matcher, or nil if none of the two properties is
+  /// set.
+  const path_set_matcher_sptr
+  get_source_locations_to_keep_matcher() const
+  {
+    pthread_mutex_lock(&source_locations_to_keep_matcher_mutex_);
+    if (!source_locations_to_keep_matcher_)
+      {
+	regex::regex_t_sptr regex = get_source_location_to_keep_regex();
+	if (!source_locations_to_keep_.empty() || regex)
+	  source_locations_to_keep_matcher_.reset
+	    (new path_set_matcher(source_locations_to_keep_, regex));
+      }
+    path_set_matcher_sptr result = source_locations_to_keep_matcher_;
+    pthread_mutex_unlock(&source_locations_to_keep_matcher_mutex_);
+    return result;
+  }
 
   friend class type_suppression;
 }; // class type_suppression::priv
@@ -832,23 +1148,29 @@ type_is_suppressed(const ReadContextType&	ctxt,
 		   bool&			type_is_private,
 		   bool require_drop_property = false)
 {
-  for (suppr::suppressions_type::const_iterator i =
-	 ctxt.get_suppressions().begin();
-       i != ctxt.get_suppressions().end();
+  const suppressions_index& index = ctxt.get_suppressions_index();
+  const suppressions_type& supprs = index.get_suppressions();
+  const suppressions_index::positions_type& positions =
+    index.get_type_names_index().lookup(type_name);
+
+  for (suppressions_index::positions_type::const_iterator i =
+	 positions.begin();
+       i != positions.end();
        ++i)
-    if (suppr::type_suppression_sptr suppr = is_type_suppression(*i))
-      {
-	if (require_drop_property && !(*i)->get_drops_artifact_from_ir())
-	  continue;
-	if (ctxt.suppression_matches_type_name_or_location(*suppr, type_name,
-							   type_location))
-	  {
-	    if (is_private_type_suppr_spec(*suppr))
-	      type_is_private = true;
+    {
+      const type_suppression& suppr =
+	static_cast<const type_suppression&>(*supprs[*i]);
+      if (require_drop_property && !suppr.get_drops_artifact_from_ir())
+	continue;
+      if (ctxt.suppression_matches_type_name_or_location(suppr, type_name,
+							 type_location))
+	{
+	  if (is_private_type_suppr_spec(suppr))
+	    type_is_private = true;
 
-	    return true;
-	  }
-      }
+	  return true;
+	}
+    }
 
   type_is_private = false;
   return false;
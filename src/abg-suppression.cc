@@ -11,6 +11,7 @@
 /// libabigail.
 
 #include <algorithm>
+#include <iterator>
 
 #include "abg-internal.h"
 #include <memory>
@@ -399,8 +400,282 @@ read_suppressions(const string& file_path,
 }
 // </suppression_base stuff>
 
+// <suppressions_index stuff>
+
+/// Finish the construction of the current instance of @ref
+/// suppressions_index::name_index.
+///
+/// This merges the suppression specifications that can match
+/// artifacts of any name into each bucket, so that looking up a name
+/// yields all the suppression specifications that can match it, in
+/// the order in which they were added.
+void
+suppressions_index::name_index::finish()
+{
+  for (unordered_map<string, positions_type>::iterator i = buckets_.begin();
+       i != buckets_.end();
+       ++i)
+    {
+      positions_type merged;
+      merged.reserve(i->second.size() + others_.size());
+      std::merge(i->second.begin(), i->second.end(),
+		 others_.begin(), others_.end(),
+		 std::back_inserter(merged));
+      i->second.swap(merged);
+    }
+}
+
+/// Index a function suppression by the name of the functions it can
+/// match.
+///
+/// @param s the function suppression to index.
+///
+/// @param position the position of @p s in the indexed set of
+/// suppression specifications.
+///
+/// @param index the index to add @p s to.
+static void
+index_by_name(const function_suppression& s,
+	      size_t position,
+	      suppressions_index::name_index& index)
+{
+  if (!s.get_name_regex_str().empty()
+      || !s.get_name_not_regex_str().empty())
+    index.add_other(position);
+  else if (!s.get_name().empty())
+    index.add(s.get_name(), position);
+  // Otherwise, the suppression cannot match any function name.
+}
+
+/// Index a function suppression by the name of the symbols it can
+/// match.
+///
+/// @param s the function suppression to index.
+///
+/// @param position the position of @p s in the indexed set of
+/// suppression specifications.
+///
+/// @param index the index to add @p s to.
+static void
+index_by_symbol_name(const function_suppression& s,
+		     size_t position,
+		     suppressions_index::name_index& index)
+{
+  if (!s.get_symbol_name_regex_str().empty()
+      || !s.get_symbol_name_not_regex_str().empty()
+      || (s.get_symbol_name().empty()
+	  && !s.get_symbol_names_to_keep().empty()))
+    index.add_other(position);
+  else if (!s.get_symbol_name().empty())
+    index.add(s.get_symbol_name(), position);
+  // Otherwise, the suppression cannot match any symbol name.
+}
+
+/// Index a variable suppression by the name of the variables it can
+/// match.
+///
+/// @param s the variable suppression to index.
+///
+/// @param position the position of @p s in the indexed set of
+/// suppression specifications.
+///
+/// @param index the index to add @p s to.
+static void
+index_by_name(const variable_suppression& s,
+	      size_t position,
+	      suppressions_index::name_index& index)
+{
+  if (!s.get_name_regex_str().empty()
+      || !s.get_name_not_regex_str().empty())
+    index.add_other(position);
+  else if (!s.get_name().empty())
+    index.add(s.get_name(), position);
+  // Otherwise, the suppression cannot match any variable name.
+}
+
+/// Index a variable suppression by the name of the symbols it can
+/// match.
+///
+/// @param s the variable suppression to index.
+///
+/// @param position the position of @p s in the indexed set of
+/// suppression specifications.
+///
+/// @param index the index to add @p s to.
+static void
+index_by_symbol_name(const variable_suppression& s,
+		     size_t position,
+		     suppressions_index::name_index& index)
+{
+  if (!s.get_symbol_name_regex_str().empty()
+      || !s.get_symbol_name_not_regex_str().empty()
+      || (s.get_symbol_name().empty()
+	  && !s.get_symbol_names_to_keep().empty()))
+    index.add_other(position);
+  else if (!s.get_symbol_name().empty())
+    index.add(s.get_symbol_name(), position);
+  // Otherwise, the suppression cannot match any symbol name.
+}
+
+/// Update the current instance of @ref suppressions_index, if it's
+/// out of date, so that it indexes a given set of suppression
+/// specifications.
+///
+/// @param suppressions the suppression specifications to index.
+void
+suppressions_index::update(const suppressions_type& suppressions)
+{
+  if (is_up_to_date_)
+    return;
+
+  suppressions_ = suppressions;
+  function_names_.clear();
+  function_symbol_names_.clear();
+  variable_names_.clear();
+  variable_symbol_names_.clear();
+  type_names_.clear();
+
+  for (size_t i = 0; i < suppressions_.size(); ++i)
+    {
+      const suppression_sptr& s = suppressions_[i];
+      if (function_suppression_sptr fn_suppr = is_function_suppression(s))
+	{
+	  index_by_name(*fn_suppr, i, function_names_);
+	  index_by_symbol_name(*fn_suppr, i, function_symbol_names_);
+	}
+      else if (variable_suppression_sptr var_suppr =
+	       is_variable_suppression(s))
+	{
+	  index_by_name(*var_suppr, i, variable_names_);
+	  index_by_symbol_name(*var_suppr, i, variable_symbol_names_);
+	}
+      else if (type_suppression_sptr type_suppr = is_type_suppression(s))
+	{
+	  // A type suppression that doesn't designate types by an
+	  // exact name can match types of any name.
+	  if (!type_suppr->get_type_name().empty())
+	    type_names_.add(type_suppr->get_type_name(), i);
+	  else
+	    type_names_.add_other(i);
+	}
+    }
+
+  function_names_.finish();
+  function_symbol_names_.finish();
+  variable_names_.finish();
+  variable_symbol_names_.finish();
+  type_names_.finish();
+
+  is_up_to_date_ = true;
+}
+
+// </suppressions_index stuff>
+
 // <type_suppression stuff>
 
+/// Normalize a file path so that different spellings of the same
+/// file path compare equal.
+///
+/// This removes the "." components and the redundant slashes of the
+/// file path.  The ".." components are left alone as the file path
+/// might involve symbolic links.
+///
+/// @param path the file path to normalize.
+///
+/// @param result output parameter.  This is set to the normalized
+/// file path.
+static void
+normalize_file_path(const string& path, string& result)
+{
+  result.clear();
+  result.reserve(path.size());
+
+  string::size_type i = 0, len = path.size();
+  if (len && path[0] == '/')
+    {
+      result += '/';
+      ++i;
+    }
+
+  while (i < len)
+    {
+      string::size_type end = path.find('/', i);
+      if (end == string::npos)
+	end = len;
+
+      string::size_type component_len = end - i;
+      if (component_len && !(component_len == 1 && path[i] == '.'))
+	{
+	  if (!result.empty() && result[result.size() - 1] != '/')
+	    result += '/';
+	  result.append(path, i, component_len);
+	}
+      i = end + 1;
+    }
+
+  if (result.empty() && len)
+    result = ".";
+}
+
+/// Constructor of @ref path_set_matcher.
+///
+/// @param paths the set of file paths, or file base names, to match.
+///
+/// @param regex the regular expression file paths can match as well.
+/// It can be nil.
+path_set_matcher::path_set_matcher(const unordered_set<string>& paths,
+				   const regex::regex_t_sptr&	 regex)
+  : regex_(regex)
+{
+  string normalized;
+  for (unordered_set<string>::const_iterator i = paths.begin();
+       i != paths.end();
+       ++i)
+    {
+      normalize_file_path(*i, normalized);
+      paths_.insert(normalized);
+    }
+  pthread_mutex_init(&verdicts_mutex_, /*attr=*/0);
+}
+
+path_set_matcher::~path_set_matcher()
+{pthread_mutex_destroy(&verdicts_mutex_);}
+
+/// Test if a file path matches the current @ref path_set_matcher.
+///
+/// @param path the file path to consider.
+///
+/// @return true iff @p path matches the regular expression of the
+/// matcher, or if @p path or its base name is in the set of file
+/// paths of the matcher.
+bool
+path_set_matcher::matches(const string& path) const
+{
+  pthread_mutex_lock(&verdicts_mutex_);
+  unordered_map<string, bool>::const_iterator i = verdicts_.find(path);
+  bool found = i != verdicts_.end();
+  bool verdict = found ? i->second : false;
+  pthread_mutex_unlock(&verdicts_mutex_);
+  if (found)
+    return verdict;
+
+  if (regex_ && regex::match(regex_, path))
+    verdict = true;
+  else if (!paths_.empty())
+    {
+      string normalized_path, base_name;
+      normalize_file_path(path, normalized_path);
+      tools_utils::base_name(normalized_path, base_name);
+      verdict = (paths_.find(base_name) != paths_.end()
+		 || paths_.find(normalized_path) != paths_.end());
+    }
+
+  pthread_mutex_lock(&verdicts_mutex_);
+  verdicts_[path] = verdict;
+  pthread_mutex_unlock(&verdicts_mutex_);
+  return verdict;
+}
+
 /// Constructor for @ref type_suppression.
 ///
 /// @param label the label of the suppression.  This is just a free
@@ -606,11 +881,17 @@ type_suppression::get_source_locations_to_keep() const
 /// Getter for the array of source location paths of types that should
 /// *NOT* be suppressed.
 ///
+/// As the array can be modified through the returned reference, this
+/// discards the matcher built from it, if any.
+///
 /// @return the array of source locations of types that should *NOT*
 /// be supressed.
 unordered_set<string>&
 type_suppression::get_source_locations_to_keep()
-{return priv_->source_locations_to_keep_;}
+{
+  priv_->invalidate_source_locations_to_keep_matcher();
+  return priv_->source_locations_to_keep_;
+}
 
 /// Setter for the array of source location paths of types that should
 /// *NOT* be suppressed.
@@ -619,7 +900,10 @@ type_suppression::get_source_locations_to_keep()
 void
 type_suppression::set_source_locations_to_keep
 (const unordered_set<string>& l)
-{priv_->source_locations_to_keep_ = l;}
+{
+  priv_->source_locations_to_keep_ = l;
+  priv_->invalidate_source_locations_to_keep_matcher();
+}
 
 /// Getter of the regular expression string that designates the source
 /// location paths of types that should not be suppressed.
@@ -635,7 +919,12 @@ type_suppression::get_source_location_to_keep_regex_str() const
 /// @param r the new regular expression.
 void
 type_suppression::set_source_location_to_keep_regex_str(const string& r)
-{priv_->source_location_to_keep_regex_str_ = r;}
+{
+  priv_->source_location_to_keep_regex_str_ = r;
+  // Discard the regex compiled from the previous string, and the
+  // matcher that uses it.
+  priv_->set_source_location_to_keep_regex(regex_t_sptr());
+}
 
 /// Getter of the vector of the changed enumerators that are supposed
 /// to be suppressed.  Note that this will be "valid" only if the type
@@ -874,9 +1163,46 @@ type_suppression::suppresses_diff(const diff* diff) const
   return true;
 }
 
+/// Test if the verdict of a type suppression about a type only
+/// depends on the canonical type of that type and on the name of that
+/// type.
+///
+/// This is not the case if the verdict depends on the source
+/// location of the type, or on whether it's a struct or a class, as
+/// these are not taken into account by type canonicalization.
+///
+/// Note that types that have the same canonical type can have
+/// different names, e.g, anonymous types, so the name of the type
+/// must be considered separately.
+///
+/// @param s the type suppression to consider.
+///
+/// @return true iff the verdict of @p s about a type only depends on
+/// the canonical type and on the name of that type.
+static bool
+verdict_depends_only_on_canonical_type(const type_suppression& s)
+{
+  if (s.get_is_artificial()
+      || !s.get_source_locations_to_keep().empty()
+      || !s.get_source_location_to_keep_regex_str().empty())
+    return false;
+
+  if (s.get_consider_type_kind()
+      && s.get_type_kind() == type_suppression::STRUCT_TYPE_KIND)
+    return false;
+
+  return true;
+}
+
 /// Test if the current instance of @ref type_suppression suppresses a
 /// change reports about a given type.
 ///
+/// The verdict is cached in @p ctxt, so that the suppression
+/// specification is evaluated at most once per type, or per
+/// canonical type for the types that have the name of their
+/// canonical type, when the verdict only depends on the canonical
+/// type and on the name.
+///
 /// @param type the type to consider.
 ///
 /// @param ctxt the context of comparison we are involved with.
@@ -887,20 +1213,32 @@ bool
 type_suppression::suppresses_type(const type_base_sptr& type,
 				  const diff_context_sptr& ctxt) const
 {
-  if (ctxt)
-    {
-      // Check if the names of the binaries match the suppression
-      if (!names_of_binaries_match(*this, *ctxt))
-	if (has_file_name_related_property())
-	  return false;
-
-      // Check if the sonames of the binaries match the suppression
-      if (!sonames_of_binaries_match(*this, *ctxt))
-	if (has_soname_related_property())
-	  return false;
-    }
+  if (!ctxt)
+    return suppresses_type(type);
+
+  const type_base* key = type.get();
+  if (verdict_depends_only_on_canonical_type(*this))
+    if (const type_base* canonical_type = type->get_naked_canonical_type())
+      if (ir::get_type_name(canonical_type) == ir::get_type_name(type))
+	key = canonical_type;
+
+  bool verdict = false;
+  if (ctxt->get_cached_suppression_verdict(this, key, verdict))
+    return verdict;
+
+  // Check if the names of the binaries match the suppression
+  if (!names_of_binaries_match(*this, *ctxt)
+      && has_file_name_related_property())
+    verdict = false;
+  // Check if the sonames of the binaries match the suppression
+  else if (!sonames_of_binaries_match(*this, *ctxt)
+	   && has_soname_related_property())
+    verdict = false;
+  else
+    verdict = suppresses_type(type);
 
-  return suppresses_type(type);
+  ctxt->cache_suppression_verdict(this, key, verdict);
+  return verdict;
 }
 
 /// Test if an instance of @ref type_suppression matches a given type.
@@ -1049,29 +1387,17 @@ bool
 suppression_matches_type_location(const type_suppression&	s,
 				  const location&		loc)
 {
+  path_set_matcher_sptr matcher =
+    s.priv_->get_source_locations_to_keep_matcher();
   if (loc)
     {
       // Check if there is a source location related match.
-      string loc_path, loc_path_base;
-      unsigned loc_line = 0, loc_column = 0;
-      loc.expand(loc_path, loc_line, loc_column);
-
-      if (regex_t_sptr regexp = s.priv_->get_source_location_to_keep_regex())
-	if (regex::match(regexp, loc_path))
-	  return false;
-
-      tools_utils::base_name(loc_path, loc_path_base);
-      if (s.get_source_locations_to_keep().find(loc_path_base)
-	  != s.get_source_locations_to_keep().end())
-	return false;
-      if (s.get_source_locations_to_keep().find(loc_path)
-	  != s.get_source_locations_to_keep().end())
+      if (matcher && matcher->matches(loc.expand_path()))
 	return false;
     }
   else
     {
-      if (!s.get_source_locations_to_keep().empty()
-	  || s.priv_->get_source_location_to_keep_regex())
+      if (matcher)
 	// The user provided a "source_location_not_regexp" or
 	// a "source_location_not_in" property that was not
 	// triggered.  This means the current type suppression
@@ -1121,8 +1447,7 @@ suppression_matches_type_location(const type_suppression&	s,
 		return true;
 	    }
 	}
-      if (!s.get_source_locations_to_keep().empty()
-	  || s.priv_->get_source_location_to_keep_regex())
+      if (s.priv_->get_source_locations_to_keep_matcher())
 	// The user provided a "source_location_not_regexp" or
 	// a "source_location_not_in" property that was not
 	// triggered.  This means the current type suppression
@@ -2341,6 +2666,45 @@ void
 function_suppression::set_symbol_name_not_regex_str(const string& r)
 {priv_->symbol_name_not_regex_str_ = r;}
 
+/// Getter for the set of names of symbols of functions that this
+/// suppression specification is to *NOT* suppress.
+///
+/// If the name of the symbol of a function is in this set, then the
+/// suppression specification does not suppress the function.  This
+/// is like the regular expression returned by
+/// function_suppression::get_symbol_name_not_regex_str(), but the
+/// names are looked up in a hash set, rather than matched against a
+/// regular expression.  That is much faster for large sets of names,
+/// e.g, for the symbols of a Linux Kernel ABI whitelist.
+///
+/// If the symbol name as returned by
+/// function_suppression::get_symbol_name() is not empty, then this
+/// property is ignored at specification evaluation time.
+///
+/// This property might be empty, in which case it's ignored at
+/// evaluation time.
+///
+/// @return the set of names of symbols of functions to keep.
+const unordered_set<string>&
+function_suppression::get_symbol_names_to_keep() const
+{return priv_->symbol_names_to_keep_;}
+
+/// Getter for the set of names of symbols of functions that this
+/// suppression specification is to *NOT* suppress.
+///
+/// @return the set of names of symbols of functions to keep.
+unordered_set<string>&
+function_suppression::get_symbol_names_to_keep()
+{return priv_->symbol_names_to_keep_;}
+
+/// Setter for the set of names of symbols of functions that this
+/// suppression specification is to *NOT* suppress.
+///
+/// @param n the new set of names of symbols of functions to keep.
+void
+function_suppression::set_symbol_names_to_keep(const unordered_set<string>& n)
+{priv_->symbol_names_to_keep_ = n;}
+
 /// Getter for the name of the version of the symbol of the function
 /// the user wants this specification to designate.
 ///
@@ -2632,6 +2996,9 @@ function_suppression::suppresses_function(const function_decl* fn,
 	  && regex::match(symbol_name_not_regex, fn_sym_name))
 	return false;
 
+      if (priv_->symbol_name_is_kept(fn_sym_name))
+	return false;
+
       if (get_allow_other_aliases())
 	{
 	  // In this case, we want to allow the suppression of change
@@ -2650,6 +3017,9 @@ function_suppression::suppresses_function(const function_decl* fn,
 		  if (symbol_name_not_regex
 		      && regex::match(symbol_name_not_regex, a->get_name()))
 		    return false;
+
+		  if (priv_->symbol_name_is_kept(a->get_name()))
+		    return false;
 		}
 	    }
 	}
@@ -2940,6 +3310,10 @@ bool
 suppression_matches_function_sym_name(const suppr::function_suppression& s,
 				      const string& fn_linkage_name)
 {
+  if (s.priv_->symbol_name_.empty()
+      && s.priv_->symbol_name_is_kept(fn_linkage_name))
+    return false;
+
   if (regex_t_sptr regexp = s.priv_->get_symbol_name_regex())
     {
       if (!regex::match(regexp, fn_linkage_name))
@@ -2951,7 +3325,12 @@ suppression_matches_function_sym_name(const suppr::function_suppression& s,
 	return false;
     }
   else if (s.priv_->symbol_name_.empty())
-    return false;
+    {
+      // The set of names of symbols to keep, if any, was considered
+      // above.
+      if (s.priv_->symbol_names_to_keep_.empty())
+	return false;
+    }
   else // if (!s.priv_->symbol_name_.empty())
     {
       if (s.priv_->symbol_name_ != fn_linkage_name)
@@ -3007,6 +3386,10 @@ bool
 suppression_matches_variable_sym_name(const suppr::variable_suppression& s,
 				      const string& var_linkage_name)
 {
+  if (s.priv_->symbol_name_.empty()
+      && s.priv_->symbol_name_is_kept(var_linkage_name))
+    return false;
+
   if (regex_t_sptr regexp = s.priv_->get_symbol_name_regex())
     {
       if (!regex::match(regexp, var_linkage_name))
@@ -3019,7 +3402,12 @@ suppression_matches_variable_sym_name(const suppr::variable_suppression& s,
 	return false;
     }
   else if (s.priv_->symbol_name_.empty())
-    return false;
+    {
+      // The set of names of symbols to keep, if any, was considered
+      // above.
+      if (s.priv_->symbol_names_to_keep_.empty())
+	return false;
+    }
   else // if (!s.priv_->symbol_name_.empty())
     {
       if (s.priv_->symbol_name_ != var_linkage_name)
@@ -3598,6 +3986,41 @@ void
 variable_suppression::set_symbol_name_not_regex_str(const string& r)
 {priv_->symbol_name_not_regex_str_ = r;}
 
+/// Getter for the set of names of symbols of variables that this
+/// suppression specification is to *NOT* suppress.
+///
+/// If the name of the symbol of a variable is in this set, then the
+/// suppression specification does not suppress the variable.  See
+/// function_suppression::get_symbol_names_to_keep().
+///
+/// If the symbol name as returned by
+/// variable_suppression::get_symbol_name() is not empty, then this
+/// property is ignored at specification evaluation time.
+///
+/// This property might be empty, in which case it's ignored at
+/// evaluation time.
+///
+/// @return the set of names of symbols of variables to keep.
+const unordered_set<string>&
+variable_suppression::get_symbol_names_to_keep() const
+{return priv_->symbol_names_to_keep_;}
+
+/// Getter for the set of names of symbols of variables that this
+/// suppression specification is to *NOT* suppress.
+///
+/// @return the set of names of symbols of variables to keep.
+unordered_set<string>&
+variable_suppression::get_symbol_names_to_keep()
+{return priv_->symbol_names_to_keep_;}
+
+/// Setter for the set of names of symbols of variables that this
+/// suppression specification is to *NOT* suppress.
+///
+/// @param n the new set of names of symbols of variables to keep.
+void
+variable_suppression::set_symbol_names_to_keep(const unordered_set<string>& n)
+{priv_->symbol_names_to_keep_ = n;}
+
 /// Getter for the version of the symbol of the variable the user
 /// wants the current specification to designate.  This property might
 /// be empty, in which case it's ignored at evaluation time.
@@ -3794,6 +4217,9 @@ variable_suppression::suppresses_variable(const var_decl* var,
 	priv_->get_symbol_name_not_regex();
       if (sym_name_not_regex && regex::match(sym_name_not_regex, var_sym_name))
 	return false;
+
+      if (priv_->symbol_name_is_kept(var_sym_name))
+	return false;
     }
 
   // Check for symbol_version and symbol_version_regexp property match
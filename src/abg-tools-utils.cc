@@ -32,7 +32,9 @@
 #include <time.h>
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <libgen.h>
+#include <zlib.h>
 
 #include <algorithm>
 #include <cstdlib>
@@ -42,10 +44,10 @@
 #include <iterator>
 #include <memory>
 #include <sstream>
+#include <unordered_set>
 
 #include "abg-dwarf-reader.h"
 #include "abg-internal.h"
-#include "abg-regex.h"
 
 // <headers defining libabigail's API go under here>
 ABG_BEGIN_EXPORT_DECLARATIONS
@@ -318,6 +320,123 @@ operator<<(ostream& o, const timer& t)
   o << t.value_as_string();
   return o;
 }
+// </class timer stuff>
+
+// <class compressed_ofstream stuff>
+
+/// The private data type of the @ref compressed_ofstream class.
+///
+/// This is the stream buffer of the stream.  It accumulates the
+/// characters written to the stream and hands them over to zlib,
+/// which compresses them into the file, when it's full.
+struct compressed_ofstream::priv : public std::streambuf
+{
+  gzFile file;
+  char buffer[64 * 1024];
+
+  priv(const string& path, int level)
+    : file()
+  {
+    std::ostringstream mode;
+    mode << "wb" << level;
+    file = gzopen(path.c_str(), mode.str().c_str());
+    if (file)
+      gzbuffer(file, 128 * 1024);
+    setp(buffer, buffer + sizeof(buffer));
+  }
+
+  /// Hand the characters accumulated in the buffer over to zlib.
+  ///
+  /// @return true upon successful completion.
+  bool
+  flush_buffer()
+  {
+    int len = pptr() - pbase();
+    if (len && gzwrite(file, pbase(), len) != len)
+      return false;
+    setp(buffer, buffer + sizeof(buffer));
+    return true;
+  }
+
+  virtual int_type
+  overflow(int_type c)
+  {
+    if (!file || !flush_buffer())
+      return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      {
+	*pptr() = traits_type::to_char_type(c);
+	pbump(1);
+      }
+    return traits_type::not_eof(c);
+  }
+
+  virtual int
+  sync()
+  {return file && flush_buffer() ? 0 : -1;}
+
+  /// Flush the buffer and close the file.
+  ///
+  /// @return true upon successful completion.
+  bool
+  close()
+  {
+    if (!file)
+      return false;
+    bool is_ok = flush_buffer();
+    if (gzclose(file) != Z_OK)
+      is_ok = false;
+    file = 0;
+    return is_ok;
+  }
+
+  ~priv()
+  {close();}
+}; // end struct compressed_ofstream::priv
+
+/// Constructor of the @ref compressed_ofstream type.
+///
+/// @param path the path to the file to write to.  The file is
+/// created, or truncated if it exists already.
+///
+/// @param level the compression level, from 1 (fastest) to 9 (best
+/// compression).
+compressed_ofstream::compressed_ofstream(const string& path, int level)
+  : ostream(0),
+    priv_(new priv(path, level))
+{
+  rdbuf(priv_.get());
+  if (!priv_->file)
+    setstate(std::ios_base::failbit);
+}
+
+/// Test if the file of the stream could be opened.
+///
+/// @return true iff the file could be opened.
+bool
+compressed_ofstream::is_open() const
+{return priv_->file != 0;}
+
+/// Flush the stream and close its file.
+///
+/// @return true upon successful completion.
+bool
+compressed_ofstream::close()
+{
+  bool is_ok = priv_->close();
+  if (!is_ok)
+    setstate(std::ios_base::failbit);
+  return is_ok;
+}
+
+/// Destructor of the @ref compressed_ofstream type.
+///
+/// This closes the file if it's not yet.
+compressed_ofstream::~compressed_ofstream()
+{
+}
+
+// </class compressed_ofstream stuff>
 
 /// Get the stat struct (as returned by the lstat() function of the C
 /// library) of a file.  Note that the function uses lstat, so that
@@ -426,6 +545,60 @@ is_dir(const string& path)
   return false;
 }
 
+/// Tests if a given file is compressed in the gzip format.
+///
+/// @param path the path to the file to consider.
+///
+/// @return true iff the file at @p path starts with the magic number
+/// of the gzip format.
+bool
+file_is_compressed(const string& path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  unsigned char magic[2];
+  bool is_compressed = (read(fd, magic, sizeof(magic)) == sizeof(magic)
+			&& magic[0] == 0x1f
+			&& magic[1] == 0x8b);
+  close(fd);
+  return is_compressed;
+}
+
+/// Read the whole content of a file into memory.
+///
+/// If the file is compressed in the gzip format, its content is
+/// decompressed on the fly.
+///
+/// @param path the path to the file to read.
+///
+/// @param content output parameter.  This is set to the content of
+/// the file, decompressed, iff the function returns true.
+///
+/// @return true iff the file could be read.
+bool
+read_file_content(const string& path, string& content)
+{
+  gzFile f = gzopen(path.c_str(), "rb");
+  if (!f)
+    return false;
+  gzbuffer(f, 128 * 1024);
+
+  string result;
+  char buf[64 * 1024];
+  int len = 0;
+  while ((len = gzread(f, buf, sizeof(buf))) > 0)
+    result.append(buf, len);
+
+  bool is_ok = len == 0;
+  if (gzclose(f) != Z_OK)
+    is_ok = false;
+  if (is_ok)
+    content.swap(result);
+  return is_ok;
+}
+
 static const char* ANONYMOUS_STRUCT_INTERNAL_NAME = "__anonymous_struct__";
 static const char* ANONYMOUS_UNION_INTERNAL_NAME =  "__anonymous_union__";
 static const char* ANONYMOUS_ENUM_INTERNAL_NAME =   "__anonymous_enum__";
@@ -721,6 +894,47 @@ emit_prefix(const string& prog_name, ostream& out)
   return out;
 }
 
+/// Emit a string as a JSON string literal.
+///
+/// @param s the string to emit.
+///
+/// @param out the output stream to emit the string literal to.
+///
+/// @return the output stream where the string literal was emitted.
+ostream&
+emit_json_string(const string& s, ostream& out)
+{
+  static const char hex_digits[] = "0123456789abcdef";
+
+  out << '"';
+  for (string::const_iterator i = s.begin(); i != s.end(); ++i)
+    {
+      unsigned char c = *i;
+      switch (c)
+	{
+	case '"':
+	  out << "\\\"";
+	  break;
+	case '\\':
+	  out << "\\\\";
+	  break;
+	case '\n':
+	  out << "\\n";
+	  break;
+	case '\t':
+	  out << "\\t";
+	  break;
+	default:
+	  if (c < 0x20)
+	    out << "\\u00" << hex_digits[c >> 4] << hex_digits[c & 0xf];
+	  else
+	    out << c;
+	}
+    }
+  out << '"';
+  return out;
+}
+
 /// Check if a given path exists and is readable.
 ///
 /// @param path the path to consider.
@@ -1351,6 +1565,9 @@ operator<<(ostream& output,
     case FILE_TYPE_TAR:
       repr = "GNU tar archive type";
       break;
+    case FILE_TYPE_BINARY_CORPUS:
+      repr = "native binary corpus file type";
+      break;
     }
 
   output << repr;
@@ -1384,6 +1601,17 @@ guess_file_type(istream& in)
       && buf[3] == 'F')
     return FILE_TYPE_ELF;
 
+  if (in.gcount() >= 8
+      && buf[0] == 0x7f
+      && buf[1] == 'a'
+      && buf[2] == 'b'
+      && buf[3] == 'i'
+      && buf[4] == 'b'
+      && buf[5] == 'i'
+      && buf[6] == 'n'
+      && buf[7] == 0)
+    return FILE_TYPE_BINARY_CORPUS;
+
   if (buf[0] == '!'
       && buf[1] == '<'
       && buf[2] == 'a'
@@ -1474,6 +1702,42 @@ guess_file_type(istream& in)
   return FILE_TYPE_UNKNOWN;
 }
 
+/// Guess the type of the content of a gzip-compressed file.
+///
+/// The beginning of the file is decompressed in memory and its type
+/// is guessed from there.  Only the native file types, which the
+/// readers can decompress transparently, are recognized.
+///
+/// @param file_path the path to the file to consider.
+///
+/// @return the type of content guessed.
+static file_type
+guess_compressed_file_type(const string& file_path)
+{
+  gzFile f = gzopen(file_path.c_str(), "rb");
+  if (!f)
+    return FILE_TYPE_UNKNOWN;
+
+  char buf[263];
+  int len = gzread(f, buf, sizeof(buf));
+  gzclose(f);
+  if (len <= 0)
+    return FILE_TYPE_UNKNOWN;
+
+  std::istringstream in(string(buf, len));
+  file_type r = guess_file_type(in);
+  switch (r)
+    {
+    case FILE_TYPE_NATIVE_BI:
+    case FILE_TYPE_XML_CORPUS:
+    case FILE_TYPE_XML_CORPUS_GROUP:
+    case FILE_TYPE_BINARY_CORPUS:
+      return r;
+    default:
+      return FILE_TYPE_UNKNOWN;
+    }
+}
+
 /// Guess the type of the content of an file.
 ///
 /// @param file_path the path to the file to consider.
@@ -1502,6 +1766,9 @@ guess_file_type(const string& file_path)
       || string_ends_with(file_path, ".tz"))
     return FILE_TYPE_TAR;
 
+  if (file_is_compressed(file_path))
+    return guess_compressed_file_type(file_path);
+
   ifstream in(file_path.c_str(), ifstream::binary);
   file_type r = guess_file_type(in);
   in.close();
@@ -1948,8 +2215,8 @@ gen_suppr_spec_from_headers(const string& headers_root_dir)
 /// A whitelist file can have multiple sections (adhering to the naming
 /// conventions and multiple files can be passed. The suppression that
 /// is created takes all whitelist sections from all files into account.
-/// Symbols (or expression of such) are deduplicated in the final
-/// suppression expression.
+/// The names of the symbols are gathered in the set of names of
+/// symbols to keep of the suppressions.
 ///
 /// This function reads the white lists and generates a
 /// function_suppression_sptr and variable_suppression_sptr and returns
@@ -1963,7 +2230,7 @@ gen_suppr_spec_from_kernel_abi_whitelists
    (const std::vector<std::string>& abi_whitelist_paths)
 {
 
-  std::vector<std::string> whitelisted_names;
+  std::unordered_set<std::string> whitelisted_names;
   for (std::vector<std::string>::const_iterator
 	   path_iter = abi_whitelist_paths.begin(),
 	   path_end = abi_whitelist_paths.end();
@@ -1999,7 +2266,7 @@ gen_suppr_spec_from_kernel_abi_whitelists
 		  {
 		    const std::string& name = prop->get_name();
 		    if (!name.empty())
-		      whitelisted_names.push_back(name);
+		      whitelisted_names.insert(name);
 		  }
 	    }
 	}
@@ -2008,35 +2275,26 @@ gen_suppr_spec_from_kernel_abi_whitelists
   suppressions_type result;
   if (!whitelisted_names.empty())
     {
-      // Drop duplicates to simplify the regex we are generating
-      std::sort(whitelisted_names.begin(), whitelisted_names.end());
-      whitelisted_names.erase(std::unique(whitelisted_names.begin(),
-					  whitelisted_names.end()),
-			      whitelisted_names.end());
-
-      // Build a regular expression representing the union of all
-      // the function and variable names expressed in the white list.
-      const std::string regex = regex::generate_from_strings(whitelisted_names);
-
       // Build a suppression specification which *keeps* functions
-      // whose ELF symbols match the regular expression contained
-      // in function_names_regexp.  This will also keep the ELF
-      // symbols (not designated by any debug info) whose names
-      // match this regexp.
+      // whose ELF symbols are in the set of whitelisted names.  This
+      // will also keep the ELF symbols (not designated by any debug
+      // info) whose names are in that set.  The names are looked up
+      // in a hash set, which is much faster than matching them
+      // against a regular expression made of the alternation of all
+      // the whitelisted names.
       function_suppression_sptr fn_suppr(new function_suppression);
       fn_suppr->set_label("whitelist");
-      fn_suppr->set_symbol_name_not_regex_str(regex);
+      fn_suppr->set_symbol_names_to_keep(whitelisted_names);
       fn_suppr->set_drops_artifact_from_ir(true);
       result.push_back(fn_suppr);
 
       // Build a suppression specification which *keeps* variables
-      // whose ELF symbols match the regular expression contained
-      // in function_names_regexp.  This will also keep the ELF
-      // symbols (not designated by any debug info) whose names
-      // match this regexp.
+      // whose ELF symbols are in the set of whitelisted names.  This
+      // will also keep the ELF symbols (not designated by any debug
+      // info) whose names are in that set.
       variable_suppression_sptr var_suppr(new variable_suppression);
       var_suppr->set_label("whitelist");
-      var_suppr->set_symbol_name_not_regex_str(regex);
+      var_suppr->set_symbol_names_to_keep(whitelisted_names);
       var_suppr->set_drops_artifact_from_ir(true);
       result.push_back(var_suppr);
     }
@@ -14,7 +14,11 @@
 #include <assert.h>
 #include <unistd.h>
 #include <pthread.h>
-#include <queue>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <fstream>
 #include <vector>
 #include <iostream>
 
@@ -67,6 +71,36 @@ namespace workers
 /// Or she can choose to be asynchronously notified whenever a task is
 /// performed and added to the "done queue".
 ///
+/// A task being performed by a worker thread can itself schedule
+/// sub-tasks, using a @ref task_group or a @ref future, and wait for
+/// them.  Each worker thread has its own double-ended queue of
+/// sub-tasks: it pushes the sub-tasks it schedules at the back of
+/// its queue and performs them from the back as well, whereas idle
+/// worker threads steal sub-tasks from the front of the queues of
+/// the other workers.  A worker thread waiting for sub-tasks performs
+/// pending tasks in the mean time, so waiting doesn't deadlock the
+/// pool.  The tasks scheduled through the @ref queue interface are
+/// performed in a FIFO manner.
+///
+/// Finally, the number of worker threads that perform tasks at the
+/// same time is bounded by a budget that is shared by all the queues
+/// of the process, whatever their nesting level.  That way, a task
+/// that creates its own @ref queue doesn't over-subscribe the
+/// processor(s).  A worker thread that waits for the tasks of
+/// another queue gives its share of the budget back in the mean
+/// time.
+///
+/// A queue can also be given a memory budget.  A worker thread then
+/// only picks a task from the FIFO if the memory that the @ref
+/// queue::memory_estimator of the queue estimates for it fits in what
+/// is left of the budget; otherwise it looks for a smaller task further
+/// down the FIFO.  A task that doesn't fit in the whole budget is
+/// performed when no other task of the FIFO is being performed.
+/// While such tasks are performed, the resident set size of the
+/// process is sampled, and its growth is shared among the tasks in
+/// proportion of their estimates.  The resulting peak is reported to
+/// the estimator, so that it can refine its subsequent estimates.
+///
 ///@}
 
 /// @return The number of hardware threads of executions advertised by
@@ -75,22 +109,227 @@ size_t
 get_number_of_threads()
 {return sysconf(_SC_NPROCESSORS_ONLN);}
 
+/// @return the size of the physical memory of the machine, in bytes,
+/// or zero if it's unknown.
+size_t
+get_physical_memory_size()
+{
+  long num_pages = sysconf(_SC_PHYS_PAGES);
+  long page_size = sysconf(_SC_PAGESIZE);
+  if (num_pages <= 0 || page_size <= 0)
+    return 0;
+  return static_cast<size_t>(num_pages) * page_size;
+}
+
+/// @return the resident set size of the current process, in bytes,
+/// or zero if it's unknown.
+size_t
+get_resident_set_size()
+{
+  std::ifstream statm("/proc/self/statm");
+  size_t total_pages = 0, resident_pages = 0;
+  if (!(statm >> total_pages >> resident_pages))
+    return 0;
+  return resident_pages * sysconf(_SC_PAGESIZE);
+}
+
+// <thread budget stuff>
+
+/// The maximum number of worker threads that can perform tasks at the
+/// same time, across all the queues of the process.  Zero means the
+/// number of threads of execution of the processor.  Guarded by
+/// thread_budget_mutex.
+static size_t thread_budget;
+
+/// The number of worker threads that are currently performing tasks,
+/// across all the queues of the process.  Guarded by
+/// thread_budget_mutex.
+static size_t num_running_workers;
+
+/// The mutex that protects thread_budget and num_running_workers.
+static pthread_mutex_t thread_budget_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/// The condition signalled whenever a worker thread stops performing
+/// tasks, or whenever the thread budget changes.
+static pthread_cond_t thread_budget_cond = PTHREAD_COND_INITIALIZER;
+
+/// Getter of the thread budget.
+///
+/// Note that the caller must hold thread_budget_mutex.
+///
+/// @return the thread budget.
+static size_t
+do_get_thread_budget()
+{return thread_budget ? thread_budget : get_number_of_threads();}
+
+/// Getter of the maximum number of worker threads that can perform
+/// tasks at the same time, across all the queues of the process.
+///
+/// @return the thread budget.
+size_t
+get_thread_budget()
+{
+  pthread_mutex_lock(&thread_budget_mutex);
+  size_t result = do_get_thread_budget();
+  pthread_mutex_unlock(&thread_budget_mutex);
+  return result;
+}
+
+/// Setter of the maximum number of worker threads that can perform
+/// tasks at the same time, across all the queues of the process.
+///
+/// @param n the new thread budget.  Zero means the number of threads
+/// of execution advertised by the underlying processor, which is the
+/// default.
+void
+set_thread_budget(size_t n)
+{
+  pthread_mutex_lock(&thread_budget_mutex);
+  thread_budget = n;
+  pthread_mutex_unlock(&thread_budget_mutex);
+  pthread_cond_broadcast(&thread_budget_cond);
+}
+
+/// Wait until the thread budget allows the current worker thread to
+/// perform tasks, and account for it.
+static void
+acquire_thread_budget()
+{
+  pthread_mutex_lock(&thread_budget_mutex);
+  while (num_running_workers >= do_get_thread_budget())
+    pthread_cond_wait(&thread_budget_cond, &thread_budget_mutex);
+  ++num_running_workers;
+  pthread_mutex_unlock(&thread_budget_mutex);
+}
+
+/// Give the share of thread budget of the current worker thread back.
+static void
+release_thread_budget()
+{
+  pthread_mutex_lock(&thread_budget_mutex);
+  ABG_ASSERT(num_running_workers);
+  --num_running_workers;
+  pthread_mutex_unlock(&thread_budget_mutex);
+  pthread_cond_signal(&thread_budget_cond);
+}
+
+// </thread budget stuff>
+
+// <job declarations>
+
+/// A set of jobs whose completion can be waited for.
+///
+/// This is an implementation detail of the @ref queue, @ref
+/// task_group and @ref future types.
+struct job_set
+{
+  // The number of jobs of the set that are not yet performed.
+  std::atomic<size_t>		num_pending;
+  // The number of jobs of the set that are not yet picked up by a
+  // worker thread.
+  std::atomic<size_t>		num_todo;
+
+  job_set()
+    : num_pending(0),
+      num_todo(0)
+  {}
+
+  /// This is invoked by the worker thread that performed a task of
+  /// the set, right after it performed it.
+  ///
+  /// By default, this does nothing.
+  virtual void
+  task_done(const task_sptr&)
+  {}
+
+  virtual ~job_set()
+  {}
+}; // end struct job_set
+
+/// Convenience typedef for a shared pointer to @ref job_set.
+typedef shared_ptr<job_set> job_set_sptr;
+
+/// The memory accounted for a job that was picked within the memory
+/// budget of a queue.
+struct memory_account
+{
+  // The memory estimated for the job, reserved from the budget.
+  size_t	estimate;
+  // The share of the growth of the resident set size attributed to
+  // the job since it was picked.
+  double	usage;
+  // The peak of the usage above.
+  double	peak;
+
+  memory_account(size_t e)
+    : estimate(e),
+      usage(),
+      peak()
+  {}
+}; // end struct memory_account
+
+/// Convenience typedef for a shared pointer to @ref memory_account.
+typedef shared_ptr<memory_account> memory_account_sptr;
+
+/// A task to be performed, together with the set of jobs it belongs
+/// to.
+struct job
+{
+  task_sptr		task;
+  job_set_sptr		set;
+  // The memory accounted for the job, if it was picked within a
+  // memory budget.
+  memory_account_sptr	account;
+
+  job()
+  {}
+
+  job(const task_sptr& t, const job_set_sptr& s)
+    : task(t),
+      set(s)
+  {}
+}; // end struct job
+
+// </job declarations>
+
 /// The abstraction of a worker thread.
 ///
 /// This is an implementation detail of the @ref queue public
 /// interface type of this worker thread design pattern.
 struct worker
 {
-  pthread_t tid;
+  pthread_t		tid;
+  // The pool of worker threads this worker belongs to.
+  queue::priv*		pool;
+  // The index of this worker in the pool.
+  size_t		index;
+  // True iff this worker accounts for a share of the thread budget.
+  bool			has_budget;
+  // A mutex that protects the jobs deque.
+  pthread_mutex_t	jobs_mutex;
+  // The jobs scheduled by the tasks performed by this worker.  This
+  // worker pushes and pops jobs at the back; other workers steal jobs
+  // from the front.
+  std::deque<job>	jobs;
 
-  worker()
-    : tid()
+  worker(queue::priv* p, size_t i)
+    : tid(),
+      pool(p),
+      index(i),
+      has_budget(),
+      jobs_mutex()
   {}
 
-  static queue::priv*
-  wait_to_execute_a_task(queue::priv*);
+  static worker*
+  wait_to_execute_a_task(worker*);
 }; // end struct worker
 
+/// Convenience typedef for a shared pointer to @ref worker.
+typedef shared_ptr<worker> worker_sptr;
+
+/// The worker thread running on the current thread, if any.
+static thread_local worker* current_worker;
+
 // </worker declarations>
 
 // <queue stuff>
@@ -100,8 +339,6 @@ struct queue::priv
 {
   // A boolean to say if the user wants to shutdown the worker
   // threads. guarded by tasks_todo_mutex.
-  // TODO: once we have std::atomic<bool>, use it and reconsider the
-  // synchronization around its reads and writes
   bool				bring_workers_down;
   // The number of worker threads.
   size_t			num_workers;
@@ -110,19 +347,30 @@ struct queue::priv
   pthread_mutex_t		tasks_todo_mutex;
   // The queue condition variable.  This condition is used to make the
   // worker threads sleep until a new task is added to the queue of
-  // todo tasks.  Whenever a new task is added to that queue, a signal
-  // is sent to all a thread sleeping on this condition variable.
+  // todo tasks, or to the jobs of a worker.  Whenever a new task is
+  // added, a signal is sent to a thread sleeping on this condition
+  // variable.
   pthread_cond_t		tasks_todo_cond;
   // A mutex that protects the done tasks queue from being accessed in
   // read/write by two threads at the same time.
   pthread_mutex_t		tasks_done_mutex;
-  // A condition to be signalled whenever there is a task done. That is being
-  // used to wait for tasks completed when bringing the workers down.
+  // A condition to be signalled whenever a set of jobs is done.  That
+  // is being used by threads that are not worker threads of this
+  // pool, to wait for tasks to be completed.
   pthread_cond_t		tasks_done_cond;
-  // The todo task queue itself.
-  std::queue<task_sptr>	tasks_todo;
+  // The todo task queue itself.  These are the tasks that were
+  // scheduled by threads that are not worker threads of this pool.
+  std::deque<job>		tasks_todo;
+  // The number of jobs that are either in the todo task queue or in
+  // the jobs of a worker.
+  std::atomic<size_t>		num_queued_jobs;
+  // The number of worker threads sleeping on tasks_todo_cond.
+  std::atomic<size_t>		num_sleeping_workers;
   // The done task queue itself.
   std::vector<task_sptr>	tasks_done;
+  // The set of the tasks scheduled through the queue::schedule_task
+  // interface.
+  job_set_sptr			tasks;
   // This functor is invoked to notify the user of this queue that a
   // task has been completed and has been added to the done tasks
   // vector.  We call it a notifier.  This notifier is the default
@@ -134,67 +382,257 @@ struct queue::priv
   // default one.
   task_done_notify&		notify;
   // A vector of the worker threads.
-  std::vector<worker>		workers;
+  std::vector<worker_sptr>	workers;
+  // The sum of the memory estimated for the jobs picked from the todo
+  // task queue that are being performed must not exceed this.  Zero
+  // means there is no memory budget.
+  size_t			memory_budget;
+  // The estimator of the memory needed by the jobs.  This is the
+  // default one, that estimates nothing, if the user has specified
+  // none.
+  static memory_estimator	default_estimator;
+  memory_estimator&		estimator;
+  // The sum of the memory estimated for the jobs being performed
+  // within the memory budget.  Guarded by tasks_todo_mutex.
+  size_t			reserved_memory;
+  // The memory accounts of the jobs being performed within the memory
+  // budget.  Guarded by tasks_todo_mutex.
+  std::vector<memory_account_sptr>	memory_accounts;
+  // The resident set size of the process at the time of the last
+  // sampling.  Guarded by tasks_todo_mutex.
+  size_t			resident_set_size;
+  // The thread that samples the resident set size of the process
+  // while jobs are performed within the memory budget.
+  pthread_t			monitor_tid;
+  // The condition the monitor thread sleeps on between two samplings.
+  pthread_cond_t		monitor_cond;
 
-  /// A constructor of @ref queue::priv.
-  ///
-  /// @param nb_workers the number of worker threads to have in the
-  /// thread pool.
-  ///
-  /// @param task_done_notify a functor object that is invoked by the
-  /// worker thread which has performed the task, right after it's
-  /// added that task to the vector of the done tasks.
   priv(size_t nb_workers = get_number_of_threads(),
-	      task_done_notify& n = default_notify)
-    : bring_workers_down(),
-      num_workers(nb_workers),
-      tasks_todo_mutex(),
-      tasks_todo_cond(),
-      tasks_done_mutex(),
-      tasks_done_cond(),
-      notify(n)
-  {create_workers();}
+       task_done_notify& n = default_notify,
+       size_t budget = 0,
+       memory_estimator& e = default_estimator);
 
   /// Create the worker threads pool and have all threads sit idle,
   /// waiting for a task to be added to the todo queue.
+  ///
+  /// Note that as the worker threads look at each other to steal
+  /// jobs, the vector of workers is fully populated before the
+  /// threads are started.
   void
   create_workers()
   {
     for (unsigned i = 0; i < num_workers; ++i)
+      workers.push_back(worker_sptr(new worker(this, i)));
+
+    for (std::vector<worker_sptr>::const_iterator i = workers.begin();
+	 i != workers.end();
+	 ++i)
+      ABG_ASSERT(pthread_create(&(*i)->tid,
+			    /*attr=*/0,
+			    (void*(*)(void*))&worker::wait_to_execute_a_task,
+			    i->get()) == 0);
+
+    if (memory_budget && !workers.empty())
+      ABG_ASSERT(pthread_create(&monitor_tid,
+				/*attr=*/0,
+				(void*(*)(void*))&monitor_memory_usage,
+				this) == 0);
+  }
+
+  /// Sample the resident set size of the process, and share its
+  /// growth since the last sampling among the jobs being performed
+  /// within the memory budget, in proportion of their estimates.
+  ///
+  /// Note that the caller must hold tasks_todo_mutex.
+  void
+  sample_memory_usage()
+  {
+    size_t rss = get_resident_set_size();
+    double growth = static_cast<double>(rss) - resident_set_size;
+    resident_set_size = rss;
+
+    if (memory_accounts.empty())
+      return;
+
+    double total = 0;
+    for (std::vector<memory_account_sptr>::const_iterator i =
+	   memory_accounts.begin();
+	 i != memory_accounts.end();
+	 ++i)
+      total += (*i)->estimate;
+
+    for (std::vector<memory_account_sptr>::const_iterator i =
+	   memory_accounts.begin();
+	 i != memory_accounts.end();
+	 ++i)
       {
-	worker w;
-	ABG_ASSERT(pthread_create(&w.tid,
-			      /*attr=*/0,
-			      (void*(*)(void*))&worker::wait_to_execute_a_task,
-			      this) == 0);
-	workers.push_back(w);
+	double share = total
+	  ? (*i)->estimate / total
+	  : 1.0 / memory_accounts.size();
+	(*i)->usage = std::max(0.0, (*i)->usage + growth * share);
+	(*i)->peak = std::max((*i)->peak, (*i)->usage);
       }
   }
 
-  /// Submit a task to the queue of tasks to be performed.
+  /// The function run by the thread that samples the resident set
+  /// size of the process while jobs are performed within the memory
+  /// budget.
   ///
-  /// This wakes up one thread from the pool which immediatly starts
-  /// performing the task.  When it's done with the task, it goes back
-  /// to be suspended, waiting for a new task to be scheduled.
+  /// @param p the queue to sample the resident set size for.
+  ///
+  /// @return @p p.
+  static priv*
+  monitor_memory_usage(priv* p)
+  {
+    // The sampling period, in nanoseconds.
+    const long period = 10 * 1000 * 1000;
+
+    pthread_mutex_lock(&p->tasks_todo_mutex);
+    while (!p->bring_workers_down)
+      {
+	if (p->memory_accounts.empty())
+	  {
+	    pthread_cond_wait(&p->monitor_cond, &p->tasks_todo_mutex);
+	    continue;
+	  }
+
+	p->sample_memory_usage();
+
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_nsec += period;
+	if (deadline.tv_nsec >= 1000 * 1000 * 1000)
+	  {
+	    deadline.tv_sec += 1;
+	    deadline.tv_nsec -= 1000 * 1000 * 1000;
+	  }
+	pthread_cond_timedwait(&p->monitor_cond, &p->tasks_todo_mutex,
+			       &deadline);
+      }
+    pthread_mutex_unlock(&p->tasks_todo_mutex);
+    return p;
+  }
+
+  /// Find the first job of the todo task queue that fits in the
+  /// memory budget.
+  ///
+  /// If there is no memory budget, or if no job of the todo task
+  /// queue is being performed, the first job fits.
+  ///
+  /// Note that the caller must hold tasks_todo_mutex.
+  ///
+  /// @param estimate output parameter.  This is set to the memory
+  /// estimated for the job found, if there is a memory budget.
+  ///
+  /// @return an iterator to the job found, or the end of the todo
+  /// task queue if no job fits.
+  std::deque<job>::iterator
+  find_job_within_memory_budget(size_t& estimate)
+  {
+    estimate = 0;
+    if (!memory_budget)
+      return tasks_todo.begin();
+
+    for (std::deque<job>::iterator i = tasks_todo.begin();
+	 i != tasks_todo.end();
+	 ++i)
+      {
+	estimate = estimator.estimate(i->task);
+	if (memory_accounts.empty()
+	    || (estimate <= memory_budget
+		&& reserved_memory <= memory_budget - estimate))
+	  return i;
+      }
+    return tasks_todo.end();
+  }
+
+  /// Test if there is a job that a worker thread can pick.
+  ///
+  /// Note that the caller must hold tasks_todo_mutex.
+  ///
+  /// @return true iff there is a job in the jobs of a worker, or a job
+  /// of the todo task queue that fits in the memory budget.
+  bool
+  has_job_to_pick()
+  {
+    if (num_queued_jobs > tasks_todo.size())
+      return true;
+
+    size_t estimate = 0;
+    return (!tasks_todo.empty()
+	    && find_job_within_memory_budget(estimate) != tasks_todo.end());
+  }
+
+  /// Wake up a worker thread that is sleeping, waiting for a task to
+  /// be scheduled, if there is one.
+  void
+  wake_up_a_worker()
+  {
+    if (num_sleeping_workers)
+      {
+	pthread_mutex_lock(&tasks_todo_mutex);
+	pthread_cond_signal(&tasks_todo_cond);
+	pthread_mutex_unlock(&tasks_todo_mutex);
+      }
+  }
+
+  /// Schedule a task to be performed by the worker threads, as part
+  /// of a given set of jobs.
+  ///
+  /// If the current thread is a worker thread of this pool, the task
+  /// is pushed at the back of the jobs of that worker.  Otherwise,
+  /// it's added to the todo task queue.
   ///
   /// @param t the task to schedule.  Note that a nil task won't be
-  /// scheduled.  If the queue is empty, the task @p t won't be
+  /// scheduled.  If there is no worker thread, the task @p t won't be
   /// scheduled either.
   ///
+  /// @param set the set of jobs @p t belongs to.
+  ///
   /// @return true iff the task @p t was successfully scheduled.
   bool
-  schedule_task(const task_sptr& t)
+  schedule_job(const task_sptr& t, const job_set_sptr& set)
   {
     if (workers.empty() || !t)
       return false;
 
-    pthread_mutex_lock(&tasks_todo_mutex);
-    tasks_todo.push(t);
-    pthread_mutex_unlock(&tasks_todo_mutex);
-    pthread_cond_signal(&tasks_todo_cond);
+    ++set->num_pending;
+    ++set->num_todo;
+    ++num_queued_jobs;
+
+    worker* w = current_worker;
+    if (w && w->pool == this)
+      {
+	pthread_mutex_lock(&w->jobs_mutex);
+	w->jobs.push_back(job(t, set));
+	pthread_mutex_unlock(&w->jobs_mutex);
+      }
+    else
+      {
+	pthread_mutex_lock(&tasks_todo_mutex);
+	tasks_todo.push_back(job(t, set));
+	pthread_mutex_unlock(&tasks_todo_mutex);
+      }
+
+    wake_up_a_worker();
     return true;
   }
 
+  /// Submit a task to the queue of tasks to be performed.
+  ///
+  /// This wakes up one thread from the pool which immediatly starts
+  /// performing the task.  When it's done with the task, it goes back
+  /// to be suspended, waiting for a new task to be scheduled.
+  ///
+  /// @param t the task to schedule.  Note that a nil task won't be
+  /// scheduled.  If the queue is empty, the task @p t won't be
+  /// scheduled either.
+  ///
+  /// @return true iff the task @p t was successfully scheduled.
+  bool
+  schedule_task(const task_sptr& t)
+  {return schedule_job(t, tasks);}
+
   /// Submit a vector of task to the queue of tasks to be performed.
   ///
   /// This wakes up threads of the pool which immediatly start
@@ -211,11 +649,179 @@ struct queue::priv
     return is_ok;
   }
 
-  /// Signal all the threads (of the pool) which are suspended and
-  /// waiting to perform a task, so that they wake up and end up their
-  /// execution.  If there is no task to perform, they just end their
-  /// execution.  If there are tasks to perform, they finish them and
-  /// then end their execution.
+  /// Pick a job to perform, for a given worker thread.
+  ///
+  /// The job is picked from the back of the jobs of the worker, then
+  /// from the front of the todo task queue, then from the front of
+  /// the jobs of the other workers.
+  ///
+  /// @param w the worker thread to pick a job for.
+  ///
+  /// @param j output parameter.  This is set to the job picked, iff
+  /// the function returns true.
+  ///
+  /// @return true iff a job was picked.
+  bool
+  pick_job(worker* w, job& j)
+  {
+    bool picked = false;
+
+    pthread_mutex_lock(&w->jobs_mutex);
+    if (!w->jobs.empty())
+      {
+	j = w->jobs.back();
+	w->jobs.pop_back();
+	picked = true;
+      }
+    pthread_mutex_unlock(&w->jobs_mutex);
+
+    if (!picked)
+      {
+	pthread_mutex_lock(&tasks_todo_mutex);
+	size_t estimate = 0;
+	std::deque<job>::iterator i;
+	if (!tasks_todo.empty()
+	    && (i = find_job_within_memory_budget(estimate))
+	    != tasks_todo.end())
+	  {
+	    j = *i;
+	    tasks_todo.erase(i);
+	    picked = true;
+	    if (memory_budget)
+	      {
+		sample_memory_usage();
+		j.account.reset(new memory_account(estimate));
+		memory_accounts.push_back(j.account);
+		reserved_memory += estimate;
+		pthread_cond_signal(&monitor_cond);
+	      }
+	  }
+	pthread_mutex_unlock(&tasks_todo_mutex);
+      }
+
+    for (size_t i = 1; !picked && i < workers.size(); ++i)
+      {
+	worker* victim = workers[(w->index + i) % workers.size()].get();
+	pthread_mutex_lock(&victim->jobs_mutex);
+	if (!victim->jobs.empty())
+	  {
+	    j = victim->jobs.front();
+	    victim->jobs.pop_front();
+	    picked = true;
+	  }
+	pthread_mutex_unlock(&victim->jobs_mutex);
+      }
+
+    if (picked)
+      {
+	--num_queued_jobs;
+	--j.set->num_todo;
+      }
+    return picked;
+  }
+
+  /// Give the memory reserved for a job back to the memory budget,
+  /// and report the peak of the memory it used to the estimator.
+  ///
+  /// @param j the job that was just performed.
+  void
+  release_memory(const job& j)
+  {
+    pthread_mutex_lock(&tasks_todo_mutex);
+    sample_memory_usage();
+    memory_accounts.erase(std::find(memory_accounts.begin(),
+				    memory_accounts.end(),
+				    j.account));
+    reserved_memory -= j.account->estimate;
+    estimator.observe(j.task, static_cast<size_t>(j.account->peak));
+    // Jobs that didn't fit in the budget might fit now.
+    pthread_cond_broadcast(&tasks_todo_cond);
+    pthread_mutex_unlock(&tasks_todo_mutex);
+  }
+
+  /// Perform a job, and signal the threads waiting for its set of
+  /// jobs if it was the last one of the set to be performed.
+  ///
+  /// @param j the job to perform.
+  void
+  perform_job(const job& j)
+  {
+    j.task->perform();
+    if (j.account)
+      release_memory(j);
+    j.set->task_done(j.task);
+    if (--j.set->num_pending == 0)
+      {
+	pthread_mutex_lock(&tasks_todo_mutex);
+	pthread_cond_broadcast(&tasks_todo_cond);
+	pthread_cond_broadcast(&tasks_done_cond);
+	pthread_mutex_unlock(&tasks_todo_mutex);
+      }
+  }
+
+  /// Suspend the current thread until all the jobs of a given set are
+  /// performed.
+  ///
+  /// If the current thread is a worker thread of this pool, it
+  /// performs pending jobs in the mean time.  If it's a worker thread
+  /// of another pool, it gives its share of thread budget back while
+  /// it's suspended.
+  ///
+  /// @param set the set of jobs to wait for.
+  void
+  wait_for(const job_set& set)
+  {
+    worker* w = current_worker;
+    if (w && w->pool == this)
+      {
+	while (set.num_pending)
+	  {
+	    job j;
+	    if (pick_job(w, j))
+	      {
+		perform_job(j);
+		continue;
+	      }
+
+	    release_thread_budget();
+	    w->has_budget = false;
+	    pthread_mutex_lock(&tasks_todo_mutex);
+	    ++num_sleeping_workers;
+	    while (!has_job_to_pick() && set.num_pending)
+	      pthread_cond_wait(&tasks_todo_cond, &tasks_todo_mutex);
+	    --num_sleeping_workers;
+	    pthread_mutex_unlock(&tasks_todo_mutex);
+	    acquire_thread_budget();
+	    w->has_budget = true;
+	  }
+	return;
+      }
+
+    bool had_budget = w && w->has_budget;
+    if (had_budget)
+      {
+	release_thread_budget();
+	w->has_budget = false;
+      }
+
+    pthread_mutex_lock(&tasks_todo_mutex);
+    while (set.num_pending)
+      pthread_cond_wait(&tasks_done_cond, &tasks_todo_mutex);
+    pthread_mutex_unlock(&tasks_todo_mutex);
+
+    if (had_budget)
+      {
+	acquire_thread_budget();
+	w->has_budget = true;
+      }
+  }
+
+  /// Wait for the tasks of the queue to be performed, then signal all
+  /// the threads (of the pool) which are suspended and waiting to
+  /// perform a task, so that they wake up and end up their execution.
+  /// The threads first perform the jobs that are still pending, e.g,
+  /// the ones that were scheduled for a @ref future that nobody waited
+  /// for.
   ///
   /// This function then joins all the tasks of the pool, waiting for
   /// them to finish, and then it returns.  In other words, this
@@ -231,23 +837,43 @@ struct queue::priv
     if (workers.empty())
       return;
 
-    // Wait for the todo list to be empty to make sure all tasks got picked up
-    pthread_mutex_lock(&tasks_todo_mutex);
-    while (!tasks_todo.empty())
-      pthread_cond_wait(&tasks_done_cond, &tasks_todo_mutex);
+    // If the current thread is a worker thread of another pool, give
+    // its share of thread budget back while it waits for the worker
+    // threads of this pool, as they might need it to terminate.
+    worker* w = current_worker;
+    bool had_budget = w && w->pool != this && w->has_budget;
+    if (had_budget)
+      {
+	release_thread_budget();
+	w->has_budget = false;
+      }
+
+    // Wait for all the tasks of the queue to be performed.
+    wait_for(*tasks);
 
+    pthread_mutex_lock(&tasks_todo_mutex);
     bring_workers_down = true;
+    pthread_cond_signal(&monitor_cond);
     pthread_mutex_unlock(&tasks_todo_mutex);
 
-    // Now that the task queue is empty, drain the workers by waking them up,
-    // letting them finish their final task before termination.
+    // Now wake the workers up, letting them finish the remaining
+    // jobs before termination.
     ABG_ASSERT(pthread_cond_broadcast(&tasks_todo_cond) == 0);
 
-    for (std::vector<worker>::const_iterator i = workers.begin();
+    for (std::vector<worker_sptr>::const_iterator i = workers.begin();
 	 i != workers.end();
 	 ++i)
-      ABG_ASSERT(pthread_join(i->tid, /*thread_return=*/0) == 0);
+      ABG_ASSERT(pthread_join((*i)->tid, /*thread_return=*/0) == 0);
     workers.clear();
+
+    if (memory_budget)
+      ABG_ASSERT(pthread_join(monitor_tid, /*thread_return=*/0) == 0);
+
+    if (had_budget)
+      {
+	acquire_thread_budget();
+	w->has_budget = true;
+      }
   }
 
   /// Destructors of @ref queue::priv type.
@@ -256,9 +882,78 @@ struct queue::priv
 
 }; //end struct queue::priv
 
+/// The set of the tasks scheduled through the @ref queue interface.
+///
+/// The tasks of this set that are performed are added to the done
+/// tasks vector of the queue, and the notifier of the queue is
+/// invoked for them.
+struct queue_job_set : public job_set
+{
+  queue::priv& queue_priv;
+
+  queue_job_set(queue::priv& q)
+    : queue_priv(q)
+  {}
+
+  /// Add the task to the vector of tasks that are done and notify
+  /// listeners about the fact that the task is done.
+  ///
+  /// Note that this (including the notification) is not happening in
+  /// parallel.  So the code performed by the notifier during the
+  /// notification is running sequentially, not in parallel with any
+  /// other task that was just done and that is notifying its
+  /// listeners.
+  ///
+  /// @param t the task that was just performed.
+  virtual void
+  task_done(const task_sptr& t)
+  {
+    pthread_mutex_lock(&queue_priv.tasks_done_mutex);
+    queue_priv.tasks_done.push_back(t);
+    queue_priv.notify(t);
+    pthread_mutex_unlock(&queue_priv.tasks_done_mutex);
+  }
+}; // end struct queue_job_set
+
 // default initialize the default notifier.
 queue::task_done_notify queue::priv::default_notify;
 
+// default initialize the default memory estimator.
+queue::memory_estimator queue::priv::default_estimator;
+
+/// A constructor of @ref queue::priv.
+///
+/// @param nb_workers the number of worker threads to have in the
+/// thread pool.
+///
+/// @param task_done_notify a functor object that is invoked by the
+/// worker thread which has performed the task, right after it's
+/// added that task to the vector of the done tasks.
+///
+/// @param budget the memory budget of the queue, in bytes.  Zero
+/// means there is no memory budget.
+///
+/// @param e the estimator of the memory needed by the tasks.
+queue::priv::priv(size_t nb_workers, task_done_notify& n,
+		  size_t budget, memory_estimator& e)
+  : bring_workers_down(),
+    num_workers(nb_workers),
+    tasks_todo_mutex(),
+    tasks_todo_cond(),
+    tasks_done_mutex(),
+    tasks_done_cond(),
+    num_queued_jobs(0),
+    num_sleeping_workers(0),
+    tasks(new queue_job_set(*this)),
+    notify(n),
+    memory_budget(budget),
+    estimator(e),
+    reserved_memory(),
+    resident_set_size(),
+    monitor_tid(),
+    monitor_cond()
+{create_workers();}
+
 /// Default constructor of the @ref queue type.
 ///
 /// By default the queue is created with a number of worker threaders
@@ -293,13 +988,44 @@ queue::queue(unsigned number_of_workers,
   : p_(new priv(number_of_workers, notifier))
 {}
 
+/// Constructor of the @ref queue type.
+///
+/// @param number_of_workers the number of worker threads to have in
+/// the pool.
+///
+/// @param notifier the notifier to invoke when a task is done doing
+/// its job.
+///
+/// @param memory_budget the maximum amount of memory, in bytes, that
+/// the tasks performed at the same time are estimated to need.  A
+/// task that needs more than that on its own is performed while no
+/// other task of the queue is.  Zero means there is no memory budget.
+///
+/// @param estimator the functor that estimates the memory needed by
+/// each task, and that is told about the memory the task used, once
+/// it's performed.
+queue::queue(unsigned number_of_workers,
+	     task_done_notify& notifier,
+	     size_t memory_budget,
+	     memory_estimator& estimator)
+  : p_(new priv(number_of_workers, notifier, memory_budget, estimator))
+{}
+
 /// Getter of the size of the queue.  This gives the number of task
 /// still present in the queue.
 ///
 /// @return the number of task still present in the queue.
 size_t
 queue::get_size() const
-{return p_->tasks_todo.size();}
+{return p_->tasks->num_todo;}
+
+/// Getter of the memory budget of the queue.
+///
+/// @return the memory budget of the queue, in bytes, or zero if it
+/// has none.
+size_t
+queue::get_memory_budget() const
+{return p_->memory_budget;}
 
 /// Submit a task to the queue of tasks to be performed.
 ///
@@ -359,71 +1085,297 @@ queue::task_done_notify::operator()(const task_sptr&/*task_done*/)
 {
 }
 
+/// The default memory estimation of the @ref queue type.
+///
+/// @return zero, that is, the task is estimated to need no memory.
+size_t
+queue::memory_estimator::estimate(const task_sptr&/*t*/)
+{return 0;}
+
+/// The default function that is told about the memory used by a
+/// task of the @ref queue type.
+///
+/// This does nothing.
+void
+queue::memory_estimator::observe(const task_sptr&/*t*/,
+				 size_t /*peak_memory*/)
+{}
+
 // </queue stuff>
 
+// <task_group stuff>
+
+/// The private data structure of the @ref task_group type.
+struct task_group::priv
+{
+  // The pool of worker threads that performs the tasks of the group.
+  // If this is nil, the tasks are performed by the thread that
+  // schedules them, right away.
+  queue::priv*	pool;
+  // The set of the jobs of the group.
+  job_set_sptr	jobs;
+
+  priv(queue::priv* p)
+    : pool(p),
+      jobs(new job_set)
+  {}
+}; // end struct task_group::priv
+
+/// Default constructor of the @ref task_group type.
+///
+/// If the current thread is a worker thread, the tasks of the group
+/// are performed by the pool of worker threads it belongs to.
+/// Otherwise, they are performed right away by the thread that
+/// schedules them.  That way, code that can be invoked from within a
+/// task, or not, can schedule sub-tasks without knowing.
+task_group::task_group()
+  : p_(new priv(current_worker ? current_worker->pool : 0))
+{}
+
+/// Constructor of the @ref task_group type.
+///
+/// @param q the queue which worker threads perform the tasks of the
+/// group.
+task_group::task_group(queue& q)
+  : p_(new priv(q.p_.get()))
+{}
+
+/// Schedule a task as part of the group.
+///
+/// @param t the task to schedule.  Note that a nil task won't be
+/// scheduled.
+///
+/// @return true iff the task was successfully scheduled.
+bool
+task_group::schedule_task(const task_sptr& t)
+{
+  if (!t)
+    return false;
+
+  if (!p_->pool)
+    {
+      t->perform();
+      return true;
+    }
+
+  return p_->pool->schedule_job(t, p_->jobs);
+}
+
+/// Schedule a vector of tasks as part of the group.
+///
+/// @param tasks the tasks to schedule.
+///
+/// @return true iff all the tasks were successfully scheduled.
+bool
+task_group::schedule_tasks(const queue::tasks_type& tasks)
+{
+  bool is_ok = true;
+  for (queue::tasks_type::const_iterator t = tasks.begin();
+       t != tasks.end();
+       ++t)
+    is_ok &= schedule_task(*t);
+  return is_ok;
+}
+
+/// Suspend the current thread until all the tasks scheduled as part
+/// of the group are performed.
+///
+/// If the current thread is a worker thread of the pool that performs
+/// the tasks of the group, it performs pending tasks in the mean
+/// time.
+void
+task_group::wait()
+{
+  if (p_->pool)
+    p_->pool->wait_for(*p_->jobs);
+}
+
+/// Destructor of the @ref task_group type.
+///
+/// This waits for the tasks of the group to be performed.
+task_group::~task_group()
+{wait();}
+
+// </task_group stuff>
+
+// <future stuff>
+
+/// The private data structure of the @ref future type.
+struct future::priv
+{
+  // The pool of worker threads that performs the task.  If this is
+  // nil, the task was performed right away.
+  queue::priv*	pool;
+  // The set of jobs made of the task.
+  job_set_sptr	jobs;
+  // The task.
+  task_sptr	task;
+
+  priv(queue::priv* p, const task_sptr& t)
+    : pool(p),
+      jobs(new job_set),
+      task(t)
+  {}
+}; // end struct future::priv
+
+/// Default constructor of the @ref future type.
+///
+/// The resulting future is not valid.
+future::future()
+{}
+
+/// Constructor of the @ref future type.
+///
+/// @param p the private data of the future.
+future::future(const priv_sptr& p)
+  : p_(p)
+{}
+
+/// Test if the @ref future refers to a task.
+///
+/// @return true iff the @ref future refers to a task.
+bool
+future::is_valid() const
+{return p_.get();}
+
+/// Test if the task of the @ref future has been performed.
+///
+/// @return true iff the task of the @ref future has been performed.
+bool
+future::is_ready() const
+{return p_ && !p_->jobs->num_pending;}
+
+/// Getter of the task of the @ref future.
+///
+/// This waits for the task to be performed.  If the current thread is
+/// a worker thread of the pool that performs the task, it performs
+/// pending tasks in the mean time.
+///
+/// @return the task of the future, or nil if the future is not
+/// valid.
+const task_sptr&
+future::get() const
+{
+  static const task_sptr nil;
+  if (!p_)
+    return nil;
+
+  if (p_->pool)
+    p_->pool->wait_for(*p_->jobs);
+  return p_->task;
+}
+
+/// Schedule a task and get a @ref future for it.
+///
+/// @param pool the pool of worker threads to perform the task.  If
+/// this is nil, the task is performed right away.
+///
+/// @param t the task to schedule.
+///
+/// @return the future for @p t.  It's not valid if @p t is nil or if
+/// it couldn't be scheduled.
+static future
+schedule_future(queue::priv* pool, const task_sptr& t)
+{
+  if (!t)
+    return future();
+
+  future::priv_sptr p(new future::priv(pool, t));
+  if (!pool)
+    t->perform();
+  else if (!pool->schedule_job(t, p->jobs))
+    return future();
+
+  return future(p);
+}
+
+/// Schedule a task and get a @ref future for it.
+///
+/// If the current thread is a worker thread, the task is performed by
+/// the pool of worker threads it belongs to.  Otherwise, it's
+/// performed right away.
+///
+/// @param t the task to schedule.
+///
+/// @return the future for @p t.  It's not valid if @p t is nil.
+future
+async(const task_sptr& t)
+{return schedule_future(current_worker ? current_worker->pool : 0, t);}
+
+/// Schedule a task onto the worker threads of a given @ref queue and
+/// get a @ref future for it.
+///
+/// Note that the task is not added to the vector of the completed
+/// tasks of @p q.
+///
+/// @param q the queue which worker threads perform the task.
+///
+/// @param t the task to schedule.
+///
+/// @return the future for @p t.  It's not valid if @p t is nil or if
+/// it couldn't be scheduled.
+future
+async(queue& q, const task_sptr& t)
+{return schedule_future(q.p_.get(), t);}
+
+// </future stuff>
+
 // <worker definitions>
 
 /// Wait to be woken up by a thread condition signal, then look if
-/// there is a task to be executed.  If there is, then pick one (in a
-/// FIFO manner), execute it, and put the executed task into the set
-/// of done tasks.
+/// there is a task to be executed.  If there is, then pick one,
+/// execute it, and put the executed task into the set of done tasks.
+///
+/// Tasks are picked from the jobs of the worker first, then from the
+/// todo task queue (in a FIFO manner), then from the jobs of the other
+/// workers.  A worker only performs tasks while the thread budget
+/// allows it, and only picks the tasks of the todo task queue that
+/// fit in the memory budget of the queue.
 ///
-/// @param t the private data of the "task queue" type to consider.
+/// @param w the worker to consider.
 ///
-/// @param return the same private data of the task queue type we got
-/// in argument.
-queue::priv*
-worker::wait_to_execute_a_task(queue::priv* p)
+/// @param return the same worker we got in argument.
+worker*
+worker::wait_to_execute_a_task(worker* w)
 {
+  current_worker = w;
+  queue::priv* p = w->pool;
+
+  acquire_thread_budget();
+  w->has_budget = true;
   while (true)
     {
-      pthread_mutex_lock(&p->tasks_todo_mutex);
-      // If there is no more tasks to perform and the queue is not to
-      // be brought down then wait (sleep) for new tasks to come up.
-      while (p->tasks_todo.empty() && !p->bring_workers_down)
-	pthread_cond_wait(&p->tasks_todo_cond, &p->tasks_todo_mutex);
-
-      // We were woken up.  So maybe there are tasks to perform?  If
-      // so, get a task from the queue ...
-      task_sptr t;
-      if (!p->tasks_todo.empty())
+      // If we've got a task to perform then perform it.
+      job j;
+      if (p->pick_job(w, j))
 	{
-	  t = p->tasks_todo.front();
-	  p->tasks_todo.pop();
+	  p->perform_job(j);
+	  continue;
 	}
-      pthread_mutex_unlock(&p->tasks_todo_mutex);
 
-      // If we've got a task to perform then perform it and when it's
-      // done then add to the set of tasks that are done.
-      if (t)
-	{
-	  t->perform();
-
-	  // Add the task to the vector of tasks that are done and
-	  // notify listeners about the fact that the task is done.
-	  //
-	  // Note that this (including the notification) is not
-	  // happening in parallel.  So the code performed by the
-	  // notifier during the notification is running sequentially,
-	  // not in parallel with any other task that was just done
-	  // and that is notifying its listeners.
-	  pthread_mutex_lock(&p->tasks_done_mutex);
-	  p->tasks_done.push_back(t);
-	  p->notify(t);
-	  pthread_mutex_unlock(&p->tasks_done_mutex);
-	  pthread_cond_signal(&p->tasks_done_cond);
-	}
+      release_thread_budget();
+      w->has_budget = false;
 
-      // ensure we access bring_workers_down always guarded
-      bool drop_out = false;
       pthread_mutex_lock(&p->tasks_todo_mutex);
-      drop_out = p->bring_workers_down;
+      // If there is no more tasks to perform and the queue is not to
+      // be brought down then wait (sleep) for new tasks to come up,
+      // or for the memory budget to allow for one of them.
+      ++p->num_sleeping_workers;
+      while (!p->has_job_to_pick() && !p->bring_workers_down)
+	pthread_cond_wait(&p->tasks_todo_cond, &p->tasks_todo_mutex);
+      --p->num_sleeping_workers;
+      bool drop_out = p->bring_workers_down && !p->num_queued_jobs;
       pthread_mutex_unlock(&p->tasks_todo_mutex);
+
       if (drop_out)
 	break;
+
+      acquire_thread_budget();
+      w->has_budget = true;
     }
 
-  return p;
+  current_worker = 0;
+  return w;
 }
 // </worker definitions>
 } //end namespace workers
@@ -40,6 +40,7 @@ ABG_BEGIN_EXPORT_DECLARATIONS
 
 #include "abg-writer.h"
 #include "abg-libxml-utils.h"
+#include "abg-workers.h"
 
 ABG_END_EXPORT_DECLARATIONS
 // </headers defining libabigail's API>
@@ -166,6 +167,7 @@ class write_context
   bool					m_short_locs;
   bool					m_write_default_sizes;
   type_id_style_kind			m_type_id_style;
+  bool					m_write_tus_concurrently;
   mutable type_ptr_map			m_type_id_map;
   mutable unordered_set<uint32_t>	m_used_type_id_hashes;
   mutable type_ptr_set_type		m_emitted_type_set;
@@ -205,7 +207,8 @@ public:
       m_write_parameter_names(true),
       m_short_locs(false),
       m_write_default_sizes(true),
-      m_type_id_style(SEQUENCE_TYPE_ID_STYLE)
+      m_type_id_style(SEQUENCE_TYPE_ID_STYLE),
+      m_write_tus_concurrently(false)
   {}
 
   /// Getter of the environment we are operating from.
@@ -383,6 +386,23 @@ public:
   set_type_id_style(type_id_style_kind style)
   {m_type_id_style = style;}
 
+  /// Getter of the flag that tells if the translation units are
+  /// written out concurrently with their serialization.
+  ///
+  /// @return true iff the translation units are written out
+  /// concurrently with their serialization.
+  bool
+  get_write_tus_concurrently() const
+  {return m_write_tus_concurrently;}
+
+  /// Setter of the flag that tells if the translation units are
+  /// written out concurrently with their serialization.
+  ///
+  /// @param f the new value of the flag.
+  void
+  set_write_tus_concurrently(bool f)
+  {m_write_tus_concurrently = f;}
+
   /// Getter of the @ref id_manager.
   ///
   /// @return the @ref id_manager used by the current instance of @ref
@@ -2154,6 +2174,30 @@ void
 set_type_id_style(write_context& ctxt, type_id_style_kind style)
 {ctxt.set_type_id_style(style);}
 
+/// Configure the @ref write_context so that the translation units of
+/// a corpus are written out concurrently with their serialization.
+///
+/// In that mode, each translation unit is serialized into a private
+/// buffer, which is then handed over to a worker thread that writes
+/// it to the output stream, while the next translation unit is being
+/// serialized.  This is useful when writing to the output stream is
+/// costly, e.g. when it compresses its content or when it's backed by
+/// a network file system.  The output is the same as in the default
+/// mode.
+///
+/// This has no effect on a machine with a single processor.
+///
+/// The output stream must not be used by anything else while the
+/// corpus is being written.
+///
+/// @param ctxt the context to set this property on.
+///
+/// @param flag if true, the translation units are written out
+/// concurrently with their serialization.
+void
+set_write_translation_units_concurrently(write_context& ctxt, bool flag)
+{ctxt.set_write_tus_concurrently(flag);}
+
 /// Serialize the canonical types of a given scope.
 ///
 /// @param scope the scope to consider.
@@ -4476,6 +4520,94 @@ write_corpus_to_archive(const corpus_sptr corp, const bool annotate)
 
 #endif //WITH_ZIP_ARCHIVE
 
+/// A task that writes a buffer to an output stream.
+///
+/// Instances of this type are performed by a @ref workers::queue to
+/// write the serialized translation units of a corpus out, while the
+/// next ones are being serialized.
+class buffer_writing_task : public workers::task
+{
+  ostream&	out_;
+  string	buffer_;
+
+public:
+
+  /// Constructor of @ref buffer_writing_task.
+  ///
+  /// @param out the output stream to write the buffer to.
+  ///
+  /// @param buffer the buffer to write.  Its content is moved into
+  /// the task, which leaves it empty.
+  buffer_writing_task(ostream& out, string& buffer)
+    : out_(out)
+  {buffer_.swap(buffer);}
+
+  /// Write the buffer, and release it.
+  virtual void
+  perform()
+  {
+    out_.write(buffer_.data(), buffer_.size());
+    string().swap(buffer_);
+  }
+}; // end class buffer_writing_task
+
+/// A convenience typedef for a shared pointer to @ref
+/// buffer_writing_task.
+typedef shared_ptr<buffer_writing_task> buffer_writing_task_sptr;
+
+/// Serialize the translation units of a corpus, writing each of them
+/// out concurrently with the serialization of the next ones.
+///
+/// The translation units are serialized in turn, in the order of the
+/// corpus, into a private buffer.  The state of the write context
+/// carries over from one translation unit to the next one, so that
+/// the type ids and the sets of emitted types are the same as in the
+/// default mode.  Each buffer is then written to the output stream
+/// of the context by one worker thread, in order.  The output is thus
+/// the same as in the default mode.
+///
+/// Note that the translation units are not serialized concurrently.
+/// Besides the state of the write context, serializing a type fills
+/// the lazy caches of the IR, like the caches of qualified names,
+/// which are not safe to fill from several threads at once.
+///
+/// @param ctxt the write context to use.
+///
+/// @param corpus the corpus which translation units to serialize.
+///
+/// @param indent the number of white space indentation to use.
+static void
+write_translation_units_concurrently(write_context&	ctxt,
+				     const corpus&	corpus,
+				     unsigned		indent)
+{
+  ostream& out = ctxt.get_ostream();
+  std::ostringstream tu_buffer;
+  ctxt.set_ostream(tu_buffer);
+
+  // A single worker writes the buffers, so it writes them in the
+  // order they are scheduled.
+  workers::queue q(1);
+  for (translation_units::const_iterator i =
+	 corpus.get_translation_units().begin();
+       i != corpus.get_translation_units().end();
+       ++i)
+    {
+      translation_unit& tu = **i;
+      if (tu.is_empty())
+	continue;
+
+      write_translation_unit(ctxt, tu, indent);
+      string buffer = tu_buffer.str();
+      tu_buffer.str("");
+      q.schedule_task(buffer_writing_task_sptr
+		      (new buffer_writing_task(out, buffer)));
+    }
+  q.wait_for_workers_to_complete();
+
+  ctxt.set_ostream(out);
+}
+
 /// Serialize an ABI corpus to a single native xml document.  The root
 /// note of the resulting XML document is 'abi-corpus'.
 ///
@@ -4575,16 +4707,23 @@ write_corpus(write_context&	ctxt,
       out << "</elf-variable-symbols>\n";
     }
 
-  // Now write the translation units.
-  for (translation_units::const_iterator i =
-	 corpus->get_translation_units().begin();
-       i != corpus->get_translation_units().end();
-       ++i)
-    {
-      translation_unit& tu = **i;
-      if (!tu.is_empty())
-	write_translation_unit(ctxt, tu, get_indent_to_level(ctxt, indent, 1));
-    }
+  // Now write the translation units.  Writing them out concurrently
+  // is only worth it if there is another processor to do it.
+  if (ctxt.get_write_tus_concurrently()
+      && workers::get_number_of_threads() > 1)
+    write_translation_units_concurrently(ctxt, *corpus,
+					 get_indent_to_level(ctxt, indent, 1));
+  else
+    for (translation_units::const_iterator i =
+	   corpus->get_translation_units().begin();
+	 i != corpus->get_translation_units().end();
+	 ++i)
+      {
+	translation_unit& tu = **i;
+	if (!tu.is_empty())
+	  write_translation_unit(ctxt, tu,
+				 get_indent_to_level(ctxt, indent, 1));
+      }
 
   do_indent_to_level(ctxt, indent, 0);
   out << "</abi-corpus>\n";
@@ -4592,6 +4731,68 @@ write_corpus(write_context&	ctxt,
   return true;
 }
 
+/// Serialize an ABI corpus in the binary corpus format.
+///
+/// The binary corpus format is the abixml representation of the
+/// corpus, encoded in the binary tree format of
+/// xml::write_binary_tree().  It's much faster to load than abixml
+/// because its strings are de-duplicated in a table and it doesn't
+/// need to be parsed.  It's read back by the native xml reader,
+/// e.g. by xml_reader::read_corpus_from_native_xml_file().
+///
+/// Note that comments, like the annotations of the abixml
+/// representation, are not part of the binary corpus format.
+///
+/// Also note that the corpus is serialized twice: it's first written
+/// out as abixml text into memory, which is then parsed back into a
+/// libxml2 tree that is finally encoded in the binary tree format.
+/// So writing a binary corpus is slower and takes more memory than
+/// writing abixml, as the whole abixml text and its tree are held in
+/// memory at once.  On test12-pr18844.so for instance, abidw takes
+/// about 10% more time and 45% more peak memory to emit the binary
+/// corpus.  The cost is meant to be paid once, at the time the
+/// corpus is saved, so that loading it is cheaper.
+///
+/// @param ctxt the write context to use.  The binary corpus is
+/// emitted to its output stream.
+///
+/// @param corpus the corpus to serialize.
+///
+/// @return true upon successful completion, false otherwise.
+bool
+write_corpus_to_binary(write_context&		ctxt,
+		       const corpus_sptr&	corpus)
+{
+  if (!corpus)
+    return false;
+
+  ostream& out = ctxt.get_ostream();
+  string abixml;
+  {
+    std::ostringstream text;
+    ctxt.set_ostream(text);
+    bool is_ok = write_corpus(ctxt, corpus, /*indent=*/0);
+    ctxt.set_ostream(out);
+    if (!is_ok)
+      return false;
+    abixml = text.str();
+  }
+  if (abixml.empty())
+    // The corpus is empty.
+    return true;
+
+  xmlDocPtr doc = xmlReadMemory(abixml.c_str(), abixml.size(), "", 0,
+				XML_PARSE_NOBLANKS | XML_PARSE_COMPACT);
+  // The abixml text is not needed anymore.
+  string().swap(abixml);
+  if (!doc)
+    return false;
+
+  bool is_ok = xml::write_binary_tree(xmlDocGetRootElement(doc), out);
+  xmlFreeDoc(doc);
+  return is_ok;
+}
+
 /// Serialize an ABI corpus group to a single native xml document.
 /// The root note of the resulting XML document is 'abi-corpus-group'.
 ///
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2020 Red Hat, Inc.
+
+/// @file
+///
+/// This program measures the time it takes to match the names of the
+/// functions and variables of an ABI corpus against a large set of
+/// regular expressions, like those of a big function or variable
+/// whitelist, either one regular expression at a time, or through
+/// the alternations built by regex::compile_alternation().
+///
+/// The regular expressions are generated from the names of the
+/// corpus.
+///
+/// Usage: benchalternation [number-of-regexes [abixml-file]]
+///
+/// By default, 2000 regular expressions are generated, and the corpus
+/// read is tests/data/test-read-dwarf/test12-pr18844.so.abi.
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "abg-corpus.h"
+#include "abg-ir.h"
+#include "abg-reader.h"
+#include "abg-regex.h"
+#include "test-utils.h"
+
+using std::cerr;
+using std::cout;
+using std::ostringstream;
+using std::string;
+using std::vector;
+using abigail::ir::environment;
+using abigail::corpus;
+using abigail::corpus_sptr;
+using abigail::regex::regex_t_sptr;
+using abigail::tests::bench_clock;
+using abigail::tests::elapsed_ms;
+
+/// Count the names that match at least one regular expression of a
+/// set.
+///
+/// @param regexes the set of compiled regular expressions.
+///
+/// @param names the names to match.
+///
+/// @return the number of names of @p names that match one of @p
+/// regexes.
+static size_t
+count_matches(const vector<regex_t_sptr>& regexes,
+	      const vector<string>& names)
+{
+  size_t num_matches = 0;
+  for (vector<string>::const_iterator s = names.begin();
+       s != names.end();
+       ++s)
+    for (vector<regex_t_sptr>::const_iterator r = regexes.begin();
+	 r != regexes.end();
+	 ++r)
+      if (abigail::regex::match(*r, *s))
+	{
+	  ++num_matches;
+	  break;
+	}
+  return num_matches;
+}
+
+int
+main(int argc, char* argv[])
+{
+  string corpus_path = string(abigail::tests::get_src_dir())
+    + "/tests/data/test-read-dwarf/test12-pr18844.so.abi";
+  size_t num_regexes = 2000;
+  if (argc > 1)
+    num_regexes = atoi(argv[1]);
+  if (argc > 2)
+    corpus_path = argv[2];
+
+  environment env;
+  corpus_sptr corp =
+    abigail::xml_reader::read_corpus_from_native_xml_file(corpus_path, &env);
+  if (!corp)
+    {
+      cerr << "could not read " << corpus_path << "\n";
+      return 1;
+    }
+
+  vector<string> names;
+  for (corpus::functions::const_iterator i = corp->get_functions().begin();
+       i != corp->get_functions().end();
+       ++i)
+    names.push_back((*i)->get_qualified_name());
+  for (corpus::variables::const_iterator i = corp->get_variables().begin();
+       i != corp->get_variables().end();
+       ++i)
+    names.push_back((*i)->get_qualified_name());
+  if (names.empty())
+    {
+      cerr << "no function or variable in " << corpus_path << "\n";
+      return 1;
+    }
+
+  // Generate regular expressions of several shapes from the names:
+  // anchored prefixes, anchored alternations of literals and
+  // unanchored prefixes followed by a character class.
+  vector<string> patterns;
+  for (size_t i = 0; i < num_regexes; ++i)
+    {
+      ostringstream escaped;
+      escaped << abigail::regex::escape(names[(i * 7919) % names.size()]);
+      string name = escaped.str();
+      ostringstream o;
+      switch (i % 3)
+	{
+	case 0:
+	  o << "^" << name.substr(0, name.size() / 2) << "[a-z_]*$";
+	  break;
+	case 1:
+	  o << "(foo|" << name << ")$";
+	  break;
+	default:
+	  o << name.substr(0, 3) << "[0-9]+x";
+	}
+      patterns.push_back(o.str());
+    }
+
+  bench_clock::time_point start = bench_clock::now();
+  vector<regex_t_sptr> regexes;
+  for (vector<string>::const_iterator p = patterns.begin();
+       p != patterns.end();
+       ++p)
+    if (regex_t_sptr r = abigail::regex::compile(*p))
+      regexes.push_back(r);
+  long compile_time = elapsed_ms(start);
+  start = bench_clock::now();
+  size_t num_matches = count_matches(regexes, names);
+  cout << "one regex at a time: compile " << compile_time << "ms, "
+       << "match " << elapsed_ms(start) << "ms\n";
+
+  start = bench_clock::now();
+  vector<regex_t_sptr> alternations;
+  abigail::regex::compile_alternation(patterns, alternations);
+  compile_time = elapsed_ms(start);
+  start = bench_clock::now();
+  size_t num_alternation_matches = count_matches(alternations, names);
+  cout << "alternations: compile " << compile_time << "ms, "
+       << "match " << elapsed_ms(start) << "ms\n";
+
+  cout << regexes.size() << " regular expressions in "
+       << alternations.size() << " alternations, "
+       << names.size() << " names, "
+       << num_matches << " matching names\n";
+
+  if (num_matches != num_alternation_matches)
+    {
+      cerr << "mismatch: " << num_matches
+	   << " vs " << num_alternation_matches << " matching names\n";
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2020 Red Hat, Inc.
+
+/// @file
+///
+/// This program measures the time it takes to parse a large kernel
+/// ABI whitelist, as generated for the Linux kernel, with
+/// abigail::ini::read_config().
+///
+/// Usage: benchini [number-of-symbols [iterations]]
+///
+/// The whitelist is generated under the tests/output directory of
+/// the build directory.
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "abg-ini.h"
+#include "abg-tools-utils.h"
+#include "test-utils.h"
+
+using std::cerr;
+using std::cout;
+using std::string;
+using abigail::ini::config;
+using abigail::ini::config_sptr;
+using abigail::tests::bench_clock;
+using abigail::tests::elapsed_ms;
+
+/// Generate a kernel ABI whitelist.
+///
+/// @param path the path of the whitelist file to generate.
+///
+/// @param num_symbols the number of symbols of the whitelist.
+///
+/// @return true iff the whitelist could be written.
+static bool
+generate_whitelist(const string& path, size_t num_symbols)
+{
+  if (!abigail::tools_utils::ensure_parent_dir_created(path))
+    return false;
+
+  std::ofstream o(path.c_str());
+  if (!o.good())
+    return false;
+
+  const size_t num_per_section = 1000;
+  for (size_t i = 0; i < num_symbols; ++i)
+    {
+      if (i % num_per_section == 0)
+	o << "[abi_whitelist_" << i / num_per_section << "]\n"
+	  << "# Symbols of group " << i / num_per_section << "\n";
+      o << "  kernel_symbol_" << i << "_of_some_subsystem\n";
+    }
+  return o.good();
+}
+
+/// Parse a given ini file a number of times.
+///
+/// @param path the path of the ini file to parse.
+///
+/// @param iterations the number of times to parse @p path.
+///
+/// @param from_stream if true, parse the file through an input
+/// stream, rather than from its path.
+///
+/// @param num_properties output parameter.  This is set to the
+/// number of properties of the file.
+///
+/// @return the time it took, in milliseconds, or -1 if @p path could
+/// not be parsed.
+static long
+parse(const string& path, int iterations, bool from_stream,
+      size_t& num_properties)
+{
+  bench_clock::time_point start = bench_clock::now();
+  for (int n = 0; n < iterations; ++n)
+    {
+      config_sptr conf;
+      if (from_stream)
+	{
+	  std::ifstream in(path.c_str());
+	  conf = abigail::ini::read_config(in);
+	}
+      else
+	conf = abigail::ini::read_config(path);
+      if (!conf)
+	return -1;
+
+      num_properties = 0;
+      for (config::sections_type::const_iterator s =
+	     conf->get_sections().begin();
+	   s != conf->get_sections().end();
+	   ++s)
+	num_properties += (*s)->get_properties().size();
+    }
+
+  return elapsed_ms(start);
+}
+
+int
+main(int argc, char* argv[])
+{
+  size_t num_symbols = 100000;
+  int iterations = 10;
+  if (argc > 1)
+    num_symbols = strtoul(argv[1], NULL, 10);
+  if (argc > 2)
+    iterations = atoi(argv[2]);
+
+  string path = string(abigail::tests::get_build_dir())
+    + "/tests/output/bench-ini/whitelist.ini";
+  if (!generate_whitelist(path, num_symbols))
+    {
+      cerr << "could not write " << path << "\n";
+      return 1;
+    }
+
+  size_t num_properties = 0;
+  long duration = parse(path, iterations, /*from_stream=*/false,
+			num_properties);
+  if (duration < 0)
+    {
+      cerr << "could not parse " << path << "\n";
+      return 1;
+    }
+  cout << "read_config(path): " << duration << "ms\n";
+
+  size_t num_stream_properties = 0;
+  duration = parse(path, iterations, /*from_stream=*/true,
+		   num_stream_properties);
+  if (duration < 0)
+    {
+      cerr << "could not parse " << path << "\n";
+      return 1;
+    }
+  cout << "read_config(istream): " << duration << "ms\n";
+
+  cout << num_symbols << " symbols, "
+       << iterations << " iterations\n";
+
+  if (num_properties != num_symbols || num_stream_properties != num_symbols)
+    {
+      cerr << "mismatch: " << num_properties
+	   << " and " << num_stream_properties
+	   << " properties vs " << num_symbols << " symbols\n";
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2020 Red Hat, Inc.
+
+/// @file
+///
+/// This program measures the time it takes to match the names of the
+/// functions and variables of an ABI corpus against the regular
+/// expressions of the default suppression specifications, using
+/// regex::match() on one hand and regexec on the other hand.
+///
+/// Usage: benchregex [abixml-file [iterations]]
+///
+/// By default, the corpus read is
+/// tests/data/test-read-dwarf/test12-pr18844.so.abi.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "abg-corpus.h"
+#include "abg-ini.h"
+#include "abg-ir.h"
+#include "abg-reader.h"
+#include "abg-regex.h"
+#include "test-utils.h"
+
+using std::cerr;
+using std::cout;
+using std::string;
+using std::vector;
+using abigail::ir::environment;
+using abigail::corpus;
+using abigail::corpus_sptr;
+using abigail::ini::config;
+using abigail::ini::config_sptr;
+using abigail::ini::simple_property_sptr;
+using abigail::ini::is_simple_property;
+using abigail::regex::regex_t_sptr;
+using abigail::tests::bench_clock;
+using abigail::tests::elapsed_ms;
+
+/// Collect the regular expressions of the properties of a
+/// suppression specification file.
+///
+/// @param path the path to the suppression specification file.
+///
+/// @param regexes output parameter.  The compiled regular
+/// expressions found in @p path are added to this.
+///
+/// @return true iff @p path could be read.
+static bool
+collect_regexes(const string& path, vector<regex_t_sptr>& regexes)
+{
+  config_sptr conf = abigail::ini::read_config(path);
+  if (!conf)
+    return false;
+
+  for (config::sections_type::const_iterator s =
+	 conf->get_sections().begin();
+       s != conf->get_sections().end();
+       ++s)
+    for (config::properties_type::const_iterator p =
+	   (*s)->get_properties().begin();
+	 p != (*s)->get_properties().end();
+	 ++p)
+      {
+	const string& name = (*p)->get_name();
+	if (name.size() < 6 || name.compare(name.size() - 6, 6, "regexp"))
+	  continue;
+	if (simple_property_sptr prop = is_simple_property(*p))
+	  if (regex_t_sptr r =
+	      abigail::regex::compile(prop->get_value()->as_string()))
+	    regexes.push_back(r);
+      }
+  return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+  string src_dir = abigail::tests::get_src_dir();
+  string corpus_path = src_dir
+    + "/tests/data/test-read-dwarf/test12-pr18844.so.abi";
+  int iterations = 10;
+  if (argc > 1)
+    corpus_path = argv[1];
+  if (argc > 2)
+    iterations = atoi(argv[2]);
+
+  vector<regex_t_sptr> regexes;
+  if (!collect_regexes(src_dir + "/default.abignore", regexes))
+    {
+      cerr << "could not read " << src_dir << "/default.abignore\n";
+      return 1;
+    }
+
+  environment env;
+  corpus_sptr corp =
+    abigail::xml_reader::read_corpus_from_native_xml_file(corpus_path, &env);
+  if (!corp)
+    {
+      cerr << "could not read " << corpus_path << "\n";
+      return 1;
+    }
+
+  vector<string> names;
+  for (corpus::functions::const_iterator i = corp->get_functions().begin();
+       i != corp->get_functions().end();
+       ++i)
+    {
+      names.push_back((*i)->get_qualified_name());
+      names.push_back((*i)->get_linkage_name());
+    }
+  for (corpus::variables::const_iterator i = corp->get_variables().begin();
+       i != corp->get_variables().end();
+       ++i)
+    {
+      names.push_back((*i)->get_qualified_name());
+      names.push_back((*i)->get_linkage_name());
+    }
+
+  size_t num_matches = 0, num_regexec_matches = 0;
+
+  bench_clock::time_point start = bench_clock::now();
+  for (int n = 0; n < iterations; ++n)
+    for (vector<regex_t_sptr>::const_iterator r = regexes.begin();
+	 r != regexes.end();
+	 ++r)
+      for (vector<string>::const_iterator s = names.begin();
+	   s != names.end();
+	   ++s)
+	if (abigail::regex::match(*r, *s))
+	  ++num_matches;
+  cout << "regex::match: " << elapsed_ms(start) << "ms\n";
+
+  start = bench_clock::now();
+  for (int n = 0; n < iterations; ++n)
+    for (vector<regex_t_sptr>::const_iterator r = regexes.begin();
+	 r != regexes.end();
+	 ++r)
+      for (vector<string>::const_iterator s = names.begin();
+	   s != names.end();
+	   ++s)
+	if (!regexec(r->get(), s->c_str(), 0, NULL, 0))
+	  ++num_regexec_matches;
+  cout << "regexec: " << elapsed_ms(start) << "ms\n";
+
+  cout << regexes.size() << " regular expressions, "
+       << names.size() << " names, "
+       << iterations << " iterations\n";
+
+  if (num_matches != num_regexec_matches)
+    {
+      cerr << "mismatch: " << num_matches
+	   << " vs " << num_regexec_matches << " matches\n";
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,29 @@
+// Compile this with:
+// gcc -gdwarf-4 -Wall -fPIC -shared -o libtest28-drop-vars.so test28-drop-vars.c
+
+struct kept_type
+{
+  int m;
+};
+
+struct dropped_type
+{
+  long m;
+  char n;
+};
+
+struct kept_type kept_var;
+
+struct dropped_type dropped_var;
+
+int dropped_var_with_kept_alias = 1;
+
+extern int kept_alias __attribute__((alias("dropped_var_with_kept_alias")));
+
+int
+kept_fn(void)
+{return kept_var.m + kept_alias;}
+
+long
+dropped_fn(void)
+{return dropped_var.m;}
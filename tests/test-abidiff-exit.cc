@@ -234,6 +234,17 @@ InOutSpec in_out_specs[] =
     "data/test-abidiff-exit/test-fun-param-report.txt",
     "output/test-abidiff-exit/test-fun-param-report.txt"
   },
+  {
+    "data/test-abidiff-exit/test-fun-param-v0.abi",
+    "data/test-abidiff-exit/test-fun-param-v1.abi",
+    "",
+    "",
+    "",
+    "--json",
+    abigail::tools_utils::ABIDIFF_ABI_CHANGE,
+    "data/test-abidiff-exit/test-fun-param-json-report.txt",
+    "output/test-abidiff-exit/test-fun-param-json-report.txt"
+  },
   {
     "data/test-abidiff-exit/test-decl-enum-v0.o",
     "data/test-abidiff-exit/test-decl-enum-v1.o",
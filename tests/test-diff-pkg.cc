@@ -222,6 +222,20 @@ static InOutSpec in_out_specs[] =
     "data/test-diff-pkg/tarpkg-1-report-0.txt",
     "output/test-diff-pkg/tarpkg-1-report-0.txt"
   },
+  // The comparison is estimated to need more than the memory budget.
+  // So it's performed on its own, and the report is the same.
+  {
+    "data/test-diff-pkg/tarpkg-0-dir1.tar",
+    "data/test-diff-pkg/tarpkg-0-dir2.tar",
+    "--no-default-suppression --no-show-locs --memory-budget 1",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "data/test-diff-pkg/tarpkg-0-report-0.txt",
+    "output/test-diff-pkg/tarpkg-0-report-04.txt"
+  },
 #endif //WITH_TAR
 
 #ifdef WITH_RPM
@@ -238,6 +252,22 @@ static InOutSpec in_out_specs[] =
     "data/test-diff-pkg/test-rpm-report-0.txt",
     "output/test-diff-pkg/test-rpm-report-0.txt"
   },
+  // Same as above, but with a memory budget that the comparisons
+  // are estimated to exceed.  So they are performed one at a time,
+  // and the report is the same.
+  {
+    "data/test-diff-pkg/dbus-glib-0.80-3.fc12.x86_64.rpm",
+    "data/test-diff-pkg/dbus-glib-0.104-3.fc23.x86_64.rpm",
+    "--no-default-suppression --private-dso --no-show-locs "
+    "--memory-budget 1",
+    "",
+    "data/test-diff-pkg/dbus-glib-debuginfo-0.80-3.fc12.x86_64.rpm",
+    "data/test-diff-pkg/dbus-glib-debuginfo-0.104-3.fc23.x86_64.rpm",
+    "",
+    "",
+    "data/test-diff-pkg/test-rpm-report-0.txt",
+    "output/test-diff-pkg/test-rpm-report-0-memory-budget.txt"
+  },
   // Two RPM packages with 2nd package debuginfo missing
   {
     "data/test-diff-pkg/dbus-glib-0.80-3.fc12.x86_64.rpm",
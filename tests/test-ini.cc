@@ -47,6 +47,34 @@ InOutSpec in_out_specs[] =
     ""
   }
   ,
+  {
+    "data/test-ini/test02-comments.abignore",
+    "data/test-ini/test02-comments.abignore.expected",
+    "output/test-ini/test02-comments.abignore",
+    ""
+  }
+  ,
+  {
+    "data/test-ini/test03-continuations.abignore",
+    "data/test-ini/test03-continuations.abignore.expected",
+    "output/test-ini/test03-continuations.abignore",
+    ""
+  }
+  ,
+  {
+    "data/test-ini/test04-non-ascii.abignore",
+    "data/test-ini/test04-non-ascii.abignore.expected",
+    "output/test-ini/test04-non-ascii.abignore",
+    ""
+  }
+  ,
+  {
+    "data/test-ini/test05-no-trailing-new-line.abignore",
+    "data/test-ini/test05-no-trailing-new-line.abignore.expected",
+    "output/test-ini/test05-no-trailing-new-line.abignore",
+    ""
+  }
+  ,
   // This one must always remain the last one.
   {0, 0, 0, 0}
 };
@@ -9,13 +9,22 @@
 ///
 /// This program tests suppression generation from KMI whitelists.
 
+#include <set>
+#include <sstream>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "lib/catch.hpp"
 
+#include "abg-corpus.h"
+#include "abg-dwarf-reader.h"
 #include "abg-fwd.h"
+#include "abg-ir.h"
+#include "abg-reader.h"
 #include "abg-suppression.h"
 #include "abg-tools-utils.h"
+#include "abg-writer.h"
 #include "test-utils.h"
 
 using abigail::tools_utils::gen_suppr_spec_from_kernel_abi_whitelists;
@@ -25,6 +34,20 @@ using abigail::suppr::function_suppression_sptr;
 using abigail::suppr::variable_suppression_sptr;
 using abigail::suppr::is_function_suppression;
 using abigail::suppr::is_variable_suppression;
+using abigail::suppr::function_suppression;
+using abigail::ir::environment;
+using abigail::ir::elf_symbol;
+using abigail::ir::elf_symbol_sptr;
+using abigail::ir::location;
+using abigail::ir::decl_base;
+using abigail::ir::function_type;
+using abigail::ir::function_type_sptr;
+using abigail::ir::function_decl;
+using abigail::ir::function_decl_sptr;
+using abigail::comparison::diff_context_sptr;
+using abigail::corpus;
+using abigail::corpus_sptr;
+using std::unordered_set;
 
 const static std::string whitelist_with_single_entry
     = std::string(abigail::tests::get_src_dir())
@@ -42,10 +65,24 @@ const static std::string whitelist_with_duplicate_entry
     = std::string(abigail::tests::get_src_dir())
       + "/tests/data/test-kmi-whitelist/whitelist-with-duplicate-entry";
 
+const static std::string whitelist_for_libtirpc
+    = std::string(abigail::tests::get_src_dir())
+      + "/tests/data/test-kmi-whitelist/whitelist-for-libtirpc";
+
+const static std::string libtirpc
+    = std::string(abigail::tests::get_src_dir())
+      + "/tests/data/test-abidiff/test-PR18166-libtirpc.so";
+
 void
 test_suppressions_are_consistent(const suppressions_type& suppr,
-			    const std::string&	     expr)
+				 const std::string&	  name1,
+				 const std::string&	  name2 = "")
 {
+  unordered_set<std::string> names;
+  names.insert(name1);
+  if (!name2.empty())
+    names.insert(name2);
+
   REQUIRE(suppr.size() == 2);
 
   function_suppression_sptr left = is_function_suppression(suppr[0]);
@@ -59,11 +96,13 @@ test_suppressions_are_consistent(const suppressions_type& suppr,
   // same mode
   REQUIRE(left->get_drops_artifact_from_ir()
 	  == right->get_drops_artifact_from_ir());
-  // same regex
-  REQUIRE(left->get_symbol_name_not_regex_str()
-     == right->get_symbol_name_not_regex_str());
-  // regex as expected
-  REQUIRE(left->get_symbol_name_not_regex_str() == expr);
+  // same set of symbol names
+  REQUIRE(left->get_symbol_names_to_keep()
+	  == right->get_symbol_names_to_keep());
+  // set of symbol names as expected
+  REQUIRE(left->get_symbol_names_to_keep() == names);
+  // no regular expression
+  REQUIRE(left->get_symbol_name_not_regex_str().empty());
 }
 
 TEST_CASE("NoWhitelists", "[whitelists]")
@@ -81,7 +120,7 @@ TEST_CASE("WhitelistWithASingleEntry", "[whitelists]")
   suppressions_type suppr
       = gen_suppr_spec_from_kernel_abi_whitelists(abi_whitelist_paths);
   REQUIRE(!suppr.empty());
-  test_suppressions_are_consistent(suppr, "^(test_symbol)$");
+  test_suppressions_are_consistent(suppr, "test_symbol");
 }
 
 TEST_CASE("WhitelistWithADuplicateEntry", "[whitelists]")
@@ -91,7 +130,7 @@ TEST_CASE("WhitelistWithADuplicateEntry", "[whitelists]")
   suppressions_type suppr
       = gen_suppr_spec_from_kernel_abi_whitelists(abi_whitelist_paths);
   REQUIRE(!suppr.empty());
-  test_suppressions_are_consistent(suppr, "^(test_symbol)$");
+  test_suppressions_are_consistent(suppr, "test_symbol");
 }
 
 TEST_CASE("TwoWhitelists", "[whitelists]")
@@ -103,7 +142,8 @@ TEST_CASE("TwoWhitelists", "[whitelists]")
       gen_suppr_spec_from_kernel_abi_whitelists(abi_whitelist_paths);
   REQUIRE(!suppr.empty());
   test_suppressions_are_consistent(suppr,
-				   "^(test_another_symbol|test_symbol)$");
+				   "test_another_symbol",
+				   "test_symbol");
 }
 
 TEST_CASE("TwoWhitelistsWithDuplicates", "[whitelists]")
@@ -115,7 +155,8 @@ TEST_CASE("TwoWhitelistsWithDuplicates", "[whitelists]")
       = gen_suppr_spec_from_kernel_abi_whitelists(abi_whitelist_paths);
   REQUIRE(!suppr.empty());
   test_suppressions_are_consistent(suppr,
-				   "^(test_another_symbol|test_symbol)$");
+				   "test_another_symbol",
+				   "test_symbol");
 }
 
 TEST_CASE("WhitelistWithTwoSections", "[whitelists]")
@@ -125,5 +166,176 @@ TEST_CASE("WhitelistWithTwoSections", "[whitelists]")
   suppressions_type suppr
       = gen_suppr_spec_from_kernel_abi_whitelists(abi_whitelist_paths);
   REQUIRE(!suppr.empty());
-  test_suppressions_are_consistent(suppr, "^(test_symbol1|test_symbol2)$");
+  test_suppressions_are_consistent(suppr,
+				   "test_symbol1",
+				   "test_symbol2");
+}
+
+TEST_CASE("WhitelistedSymbolsAreKept", "[whitelists]")
+{
+  std::vector<std::string> abi_whitelist_paths;
+  abi_whitelist_paths.push_back(whitelist_with_two_sections);
+  suppressions_type suppr
+      = gen_suppr_spec_from_kernel_abi_whitelists(abi_whitelist_paths);
+  REQUIRE(suppr.size() == 2);
+  function_suppression_sptr fn_suppr = is_function_suppression(suppr[0]);
+  REQUIRE(fn_suppr);
+
+  environment env;
+  function_type_sptr fn_type(new function_type(env.get_void_type(), 0, 0));
+  const char* names[] = {"test_symbol1", "test_symbol2", "test_symbol3"};
+  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+    {
+      elf_symbol_sptr sym =
+	elf_symbol::create(&env, i, 0, names[i],
+			   elf_symbol::FUNC_TYPE,
+			   elf_symbol::GLOBAL_BINDING,
+			   /*is_defined=*/true,
+			   /*is_common=*/false,
+			   elf_symbol::version(),
+			   elf_symbol::DEFAULT_VISIBILITY);
+      function_decl_sptr fn(new function_decl(names[i], fn_type,
+					      /*declared_inline=*/false,
+					      location(), names[i],
+					      decl_base::VISIBILITY_DEFAULT,
+					      decl_base::BINDING_GLOBAL));
+      fn->set_symbol(sym);
+      // Only the function which symbol is not whitelisted is
+      // suppressed.
+      REQUIRE(fn_suppr->suppresses_function
+	      (fn, function_suppression::ADDED_FUNCTION_CHANGE_KIND,
+	       diff_context_sptr())
+	      == (i == 2));
+    }
+}
+
+/// Read the corpus of an ELF binary, applying a set of suppression
+/// specifications while reading its DWARF.
+///
+/// @param elf_path the path to the ELF binary.
+///
+/// @param suppr the suppression specifications to apply.
+///
+/// @param env the environment to use.
+///
+/// @return the corpus read.
+static corpus_sptr
+read_corpus_dropping_early(const std::string&	    elf_path,
+			   const suppressions_type& suppr,
+			   environment*		    env)
+{
+  std::vector<char**> di_roots;
+  abigail::dwarf_reader::read_context_sptr ctxt =
+    abigail::dwarf_reader::create_read_context(elf_path, di_roots, env);
+  abigail::dwarf_reader::add_read_context_suppressions(*ctxt, suppr);
+  abigail::dwarf_reader::status status = abigail::dwarf_reader::STATUS_UNKNOWN;
+  return abigail::dwarf_reader::read_corpus_from_elf(*ctxt, status);
+}
+
+/// Read the corpus of an ELF binary, applying a set of suppression
+/// specifications only once the whole corpus is built.
+///
+/// The whole corpus is read from DWARF and serialized into abixml.
+/// The suppression specifications are then applied while reading the
+/// abixml back.
+///
+/// @param elf_path the path to the ELF binary.
+///
+/// @param suppr the suppression specifications to apply.
+///
+/// @param env the environment to use.
+///
+/// @return the corpus read.
+static corpus_sptr
+read_corpus_dropping_late(const std::string&	   elf_path,
+			  const suppressions_type& suppr,
+			  environment*		   env)
+{
+  corpus_sptr whole_corpus =
+    read_corpus_dropping_early(elf_path, suppressions_type(), env);
+  REQUIRE(whole_corpus);
+
+  std::stringstream abixml;
+  abigail::xml_writer::write_context_sptr write_ctxt =
+    abigail::xml_writer::create_write_context(env, abixml);
+  REQUIRE(abigail::xml_writer::write_corpus(*write_ctxt, whole_corpus,
+					    /*indent=*/0));
+
+  abigail::xml_reader::read_context_sptr read_ctxt =
+    abigail::xml_reader::create_native_xml_read_context(&abixml, env);
+  abigail::xml_reader::add_read_context_suppressions(*read_ctxt, suppr);
+  return abigail::xml_reader::read_corpus_from_input(*read_ctxt);
+}
+
+/// Get a textual representation of the functions and variables of a
+/// corpus, along with their symbols.
+///
+/// @param corp the corpus to consider.
+///
+/// @param fns output parameter.  The representations of the
+/// functions of @p corp are added to this.
+///
+/// @param vars output parameter.  The representations of the
+/// variables of @p corp are added to this.
+static void
+get_decls_and_symbols(const corpus_sptr&     corp,
+		      std::set<std::string>& fns,
+		      std::set<std::string>& vars)
+{
+  for (corpus::functions::const_iterator i = corp->get_functions().begin();
+       i != corp->get_functions().end();
+       ++i)
+    fns.insert((*i)->get_pretty_representation() + " "
+	       + ((*i)->get_symbol() ? (*i)->get_symbol()->get_id_string()
+		  : std::string()));
+
+  for (corpus::variables::const_iterator i = corp->get_variables().begin();
+       i != corp->get_variables().end();
+       ++i)
+    vars.insert((*i)->get_pretty_representation() + " "
+		+ ((*i)->get_symbol() ? (*i)->get_symbol()->get_id_string()
+		   : std::string()));
+}
+
+TEST_CASE("WhitelistDropsFunctionAndVariableDiesEarly", "[whitelists]")
+{
+  std::vector<std::string> abi_whitelist_paths;
+  abi_whitelist_paths.push_back(whitelist_for_libtirpc);
+  suppressions_type suppr
+      = gen_suppr_spec_from_kernel_abi_whitelists(abi_whitelist_paths);
+  REQUIRE(suppr.size() == 2);
+
+  // The DWARF reader drops the DIEs of the functions and variables
+  // whose symbols are not whitelisted before building anything out
+  // of them.  The result must be the same as when the functions and
+  // variables are dropped once they are built.
+  environment early_env;
+  corpus_sptr early_corpus =
+    read_corpus_dropping_early(libtirpc, suppr, &early_env);
+  REQUIRE(early_corpus);
+
+  environment late_env;
+  corpus_sptr late_corpus =
+    read_corpus_dropping_late(libtirpc, suppr, &late_env);
+  REQUIRE(late_corpus);
+
+  std::set<std::string> early_fns, early_vars, late_fns, late_vars;
+  get_decls_and_symbols(early_corpus, early_fns, early_vars);
+  get_decls_and_symbols(late_corpus, late_fns, late_vars);
+
+  REQUIRE(early_fns.size() == 4);
+  REQUIRE(early_vars.size() == 2);
+  REQUIRE(early_fns == late_fns);
+  REQUIRE(early_vars == late_vars);
+
+  // Only the whitelisted symbols are left.
+  const char* kept_symbols[] =
+    {"clnt_create", "svc_register", "xdr_int", "xdr_string",
+     "rpc_createerr", "svc_fdset"};
+  size_t num_kept_symbols = sizeof(kept_symbols) / sizeof(kept_symbols[0]);
+  REQUIRE(early_corpus->get_fun_symbol_map().size()
+	  + early_corpus->get_var_symbol_map().size() == num_kept_symbols);
+  for (size_t i = 0; i < num_kept_symbols; ++i)
+    REQUIRE((early_corpus->lookup_function_symbol(kept_symbols[i])
+	     || early_corpus->lookup_variable_symbol(kept_symbols[i])));
 }
@@ -299,6 +299,13 @@ InOutSpec in_out_specs[] =
     "data/test-read-dwarf/libtest24-drop-fns-2.so.abi",
     "output/test-read-dwarf/libtest24-drop-fns-2.so.abi",
   },
+  {
+    "data/test-read-dwarf/libtest28-drop-vars.so",
+    "data/test-read-dwarf/test28-drop-vars.suppr",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/libtest28-drop-vars.so.abi",
+    "output/test-read-dwarf/libtest28-drop-vars.so.abi",
+  },
   {
     "data/test-read-dwarf/PR22015-libboost_iostreams.so",
     "",
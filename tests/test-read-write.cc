@@ -6,16 +6,23 @@
 /// @file read an XML corpus file (in the native Abigail XML format),
 /// save it back and diff the resulting XML file against the input
 /// file.  They should be identical.
+///
+/// XML corpus files are also saved in the binary corpus format, and
+/// compressed, and read back; that should yield the same XML file
+/// too.  They are also
+/// read lazily, and their functions and variables looked up.
 
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 #include "abg-ir.h"
 #include "abg-reader.h"
+#include "abg-reader-priv.h"
 #include "abg-writer.h"
 #include "abg-workers.h"
 #include "abg-tools-utils.h"
@@ -31,14 +38,28 @@ using std::dynamic_pointer_cast;
 using abigail::tools_utils::file_type;
 using abigail::tools_utils::check_file;
 using abigail::tools_utils::guess_file_type;
+using abigail::tools_utils::compressed_ofstream;
 using abigail::tests::get_build_dir;
 using abigail::ir::environment;
 using abigail::ir::environment_sptr;
 using abigail::translation_unit_sptr;
 using abigail::corpus_sptr;
+using abigail::corpus;
+using abigail::ir::function_decl_sptr;
+using abigail::ir::var_decl_sptr;
 using abigail::xml_reader::read_translation_unit_from_file;
 using abigail::xml_reader::read_corpus_from_native_xml_file;
+using abigail::xml_reader::read_corpus_from_native_xml_buffer;
+using abigail::xml_reader::read_context_sptr;
+using abigail::xml_reader::create_native_xml_read_context;
+using abigail::xml_reader::read_indexed_corpus_from_input;
+using abigail::xml_reader::lookup_function_from_index;
+using abigail::xml_reader::lookup_variable_from_index;
 using abigail::xml_writer::write_translation_unit;
+using abigail::xml_writer::write_context_sptr;
+using abigail::xml_writer::create_write_context;
+using abigail::xml_writer::write_corpus_to_binary;
+using abigail::xml_writer::write_corpus;
 
 using abigail::workers::queue;
 using abigail::workers::task;
@@ -242,6 +263,26 @@ InOutSpec in_out_specs[] =
   {NULL, NULL, NULL, NULL}
 };
 
+/// Serialize a corpus in memory.
+///
+/// @param corp the corpus to serialize.
+///
+/// @param binary if true, the corpus is serialized in the binary
+/// corpus format, rather than in abixml.
+///
+/// @return the serialized corpus.
+static string
+serialize_corpus(const corpus_sptr& corp, bool binary)
+{
+  std::ostringstream os;
+  write_context_sptr ctxt = create_write_context(corp->get_environment(), os);
+  if (binary)
+    write_corpus_to_binary(*ctxt, corp);
+  else
+    write_corpus(*ctxt, corp, 0);
+  return os.str();
+}
+
 /// A task wihch reads an abixml file using abilint and compares its
 /// output against a reference output.
 struct test_task : public abigail::workers::task
@@ -335,6 +376,150 @@ struct test_task : public abigail::workers::task
     diff_cmd = cmd;
     if (system(cmd.c_str()))
       is_ok = false;
+
+    if (is_ok
+	&& t == abigail::tools_utils::FILE_TYPE_XML_CORPUS
+	&& in_suppr_spec_path.empty())
+      {
+	// Save the corpus in the binary corpus format, read that back
+	// with abilint and make sure we get the same reference
+	// output.
+	corpus = read_corpus_from_native_xml_file(in_path, env.get());
+	if (!corpus)
+	  {
+	    error_message = "Could not read corpus " + in_path;
+	    is_ok = false;
+	    return;
+	  }
+
+	string bin_path = out_path + ".bin";
+	ofstream of(bin_path.c_str(),
+		    std::ios_base::trunc | std::ios_base::binary);
+	write_context_sptr ctxt = create_write_context(env.get(), of);
+	if (!write_corpus_to_binary(*ctxt, corpus))
+	  {
+	    error_message = "Could not write binary corpus " + bin_path;
+	    is_ok = false;
+	    return;
+	  }
+	of.close();
+
+	string bin_out_path = out_path + ".from-bin";
+	cmd = abilint + " " + bin_path + " > " + bin_out_path;
+	if (system(cmd.c_str()))
+	  {
+	    error_message =
+	      "Binary corpus file doesn't pass abilint: " + bin_path + "\n";
+	    is_ok = false;
+	  }
+
+	cmd = "diff -u " + ref_out_path + " " + bin_out_path;
+	diff_cmd = cmd;
+	if (system(cmd.c_str()))
+	  is_ok = false;
+
+	// Likewise, save the corpus in a gzip-compressed abixml file
+	// and read that back with abilint.
+	string gz_path = out_path + ".gz";
+	{
+	  compressed_ofstream gz_of(gz_path);
+	  write_context_sptr gz_ctxt = create_write_context(env.get(), gz_of);
+	  if (!write_corpus(*gz_ctxt, corpus, 0) || !gz_of.close())
+	    {
+	      error_message = "Could not write compressed corpus " + gz_path;
+	      is_ok = false;
+	      return;
+	    }
+	}
+
+	string gz_out_path = out_path + ".from-gz";
+	cmd = abilint + " " + gz_path + " > " + gz_out_path;
+	if (system(cmd.c_str()))
+	  {
+	    error_message =
+	      "Compressed corpus file doesn't pass abilint: " + gz_path + "\n";
+	    is_ok = false;
+	  }
+
+	cmd = "diff -u " + ref_out_path + " " + gz_out_path;
+	diff_cmd = cmd;
+	if (system(cmd.c_str()))
+	  is_ok = false;
+
+	// Save the corpus in memory, in abixml and in the binary
+	// corpus format, read it back from there in a new environment
+	// and make sure it serializes to the same abixml.
+	string abixml = serialize_corpus(corpus, /*binary=*/false);
+	for (int binary = 0; binary < 2; ++binary)
+	  {
+	    environment_sptr mem_env(new environment);
+	    corpus_sptr reread =
+	      read_corpus_from_native_xml_buffer(serialize_corpus(corpus,
+								  binary),
+						 mem_env.get());
+	    if (!reread || serialize_corpus(reread, false) != abixml)
+	      {
+		error_message = string("Could not read back in-memory ")
+		  + (binary ? "binary corpus" : "abixml") + " of " + in_path;
+		is_ok = false;
+	      }
+	  }
+
+	// Read the corpus lazily, look its functions and variables up
+	// by their ELF symbols and make sure we get the ones of the
+	// corpus read in full.
+	environment_sptr lazy_env(new environment);
+	read_context_sptr lazy_ctxt =
+	  create_native_xml_read_context(in_path, lazy_env.get());
+	if (!read_indexed_corpus_from_input(*lazy_ctxt))
+	  {
+	    error_message = "Could not read indexed corpus " + in_path;
+	    is_ok = false;
+	    return;
+	  }
+
+	for (corpus::functions::const_iterator f =
+	       corpus->get_functions().begin();
+	     f != corpus->get_functions().end();
+	     ++f)
+	  {
+	    if (!(*f)->get_symbol())
+	      continue;
+	    function_decl_sptr fn =
+	      lookup_function_from_index(*lazy_ctxt,
+					 (*f)->get_symbol()->get_id_string());
+	    if (!fn
+		|| (fn->get_pretty_representation()
+		    != (*f)->get_pretty_representation()))
+	      {
+		error_message = "Could not look up function "
+		  + (*f)->get_pretty_representation()
+		  + " in indexed corpus " + in_path;
+		is_ok = false;
+	      }
+	  }
+
+	for (corpus::variables::const_iterator v =
+	       corpus->get_variables().begin();
+	     v != corpus->get_variables().end();
+	     ++v)
+	  {
+	    if (!(*v)->get_symbol())
+	      continue;
+	    var_decl_sptr var =
+	      lookup_variable_from_index(*lazy_ctxt,
+					 (*v)->get_symbol()->get_id_string());
+	    if (!var
+		|| (var->get_pretty_representation()
+		    != (*v)->get_pretty_representation()))
+	      {
+		error_message = "Could not look up variable "
+		  + (*v)->get_pretty_representation()
+		  + " in indexed corpus " + in_path;
+		is_ok = false;
+	      }
+	  }
+      }
   }
 };// end struct test_task
 
@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2020 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests that regex::match() gives the same results as
+/// regexec, whether or not the regular expression can be matched
+/// without going through regexec, and that regex::compile_alternation()
+/// matches the same strings as the regular expressions it combines.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lib/catch.hpp"
+
+#include "abg-ini.h"
+#include "abg-regex.h"
+#include "test-utils.h"
+
+using std::string;
+using std::vector;
+using abigail::regex::regex_t_sptr;
+using abigail::ini::config;
+using abigail::ini::config_sptr;
+using abigail::ini::simple_property_sptr;
+using abigail::ini::is_simple_property;
+
+/// The strings matched against the regular expressions of the tests.
+static const char* strings[] =
+{
+  "",
+  "std",
+  "std::",
+  "std::vector<int, std::allocator<int> >::push_back",
+  "__gnu_cxx::__normal_iterator<int*, std::vector<int> >",
+  "WebCore::Node",
+  "WebKit::WebPage::create",
+  "webkit_web_view_new",
+  "boost::shared_ptr<int>",
+  "krb5int_foo",
+  "krb5_init_context",
+  "libc.so.6",
+  "libstdc++.so.6.0.28",
+  "libwebkit2gtk-4.0.so.37",
+  "libvirt.so.0",
+  "libm.so.6",
+  "ld-linux-x86-64.so.2",
+  "kernel.img",
+  "foo",
+  "foobar",
+  "barfoo",
+  "foo.bar",
+  "foo|bar",
+  "a$b",
+  "_ZN7android6Parcel5writeEPKvj",
+  0
+};
+
+/// Test that regex::match() and regexec agree on the strings of the
+/// array strings[], for a given regular expression.
+///
+/// @param pattern the regular expression to consider.
+static void
+test_match_is_consistent(const string& pattern)
+{
+  regex_t_sptr r = abigail::regex::compile(pattern);
+  REQUIRE(r);
+  // Going twice over the strings exercises the cache of the results
+  // of regexec.
+  for (int pass = 0; pass < 2; ++pass)
+    for (const char** s = strings; *s; ++s)
+      {
+	INFO("pattern: '" << pattern << "', string: '" << *s << "'");
+	bool expected = !regexec(r.get(), *s, 0, NULL, 0);
+	CHECK(abigail::regex::match(r, *s) == expected);
+      }
+}
+
+TEST_CASE("MatchIsConsistentWithRegexec")
+{
+  const char* patterns[] =
+  {
+    "std::.*",
+    "^std::.*",
+    "std::.*$",
+    ".*std::.*",
+    "^std$",
+    "^std",
+    "std",
+    "std$",
+    "(^std::.*|WebCore::.*|WebKit::.*)",
+    "^(std::|boost::)",
+    "^krb5int_.*",
+    "^webkit_.*",
+    "libstdc\\+\\+\\.so.*",
+    "libboost_.*\\.so.*",
+    "kernel\\.img",
+    "libvirt\\.so.*",
+    "libwebkit2?gtk-.*\\.so.*",
+    "(libanl|libc|libm|ld[a-z0-9-]*)\\.so\\.[0-9]*",
+    "^foo|bar$",
+    "foo\\|bar",
+    "a\\$b",
+    "^a\\$b$",
+    "foo.*bar",
+    "^foo.*bar$",
+    "^.*$",
+    "^.*foo.*$",
+    "f.o",
+    "^_^",
+    "",
+    0
+  };
+
+  for (const char** p = patterns; *p; ++p)
+    test_match_is_consistent(*p);
+}
+
+TEST_CASE("MatchIsConsistentWithRegexecForGeneratedRegexes")
+{
+  vector<string> names;
+  test_match_is_consistent(abigail::regex::generate_from_strings(names));
+
+  names.push_back("foo");
+  test_match_is_consistent(abigail::regex::generate_from_strings(names));
+
+  names.push_back("std::vector<int, std::allocator<int> >::push_back");
+  names.push_back("foo.bar");
+  names.push_back("libstdc++.so.6.0.28");
+  names.push_back("foo|bar");
+  test_match_is_consistent(abigail::regex::generate_from_strings(names));
+}
+
+TEST_CASE("MatchIsConsistentWithRegexecForDefaultSuppressions")
+{
+  string path = string(abigail::tests::get_src_dir()) + "/default.abignore";
+  config_sptr conf = abigail::ini::read_config(path);
+  REQUIRE(conf);
+
+  size_t num_regexes = 0;
+  for (config::sections_type::const_iterator s =
+	 conf->get_sections().begin();
+       s != conf->get_sections().end();
+       ++s)
+    for (config::properties_type::const_iterator p =
+	   (*s)->get_properties().begin();
+	 p != (*s)->get_properties().end();
+	 ++p)
+      {
+	const string& name = (*p)->get_name();
+	if (name.size() < 6 || name.compare(name.size() - 6, 6, "regexp"))
+	  continue;
+	if (simple_property_sptr prop = is_simple_property(*p))
+	  {
+	    test_match_is_consistent(prop->get_value()->as_string());
+	    ++num_regexes;
+	  }
+      }
+  CHECK(num_regexes > 0);
+}
+
+TEST_CASE("AlternationIsConsistentWithIndividualRegexes")
+{
+  const char* patterns[] =
+  {
+    "std::.*",
+    "^WebCore::.*",
+    "^foo|bar$",
+    "foo\\|bar",
+    "libstdc\\+\\+\\.so.*",
+    "(libanl|libc|libm|ld[a-z0-9-]*)\\.so\\.[0-9]*",
+    "^(.)\\1",
+    "",
+    "(unbalanced",
+    0
+  };
+
+  vector<string> pattern_strings;
+  for (const char** p = patterns; *p; ++p)
+    pattern_strings.push_back(*p);
+
+  for (size_t n = 0; n <= pattern_strings.size(); ++n)
+    {
+      vector<string> set(pattern_strings.begin(),
+			 pattern_strings.begin() + n);
+      vector<regex_t_sptr> alternation;
+      abigail::regex::compile_alternation(set, alternation);
+      CHECK(alternation.size() <= set.size());
+
+      for (const char** s = strings; *s; ++s)
+	{
+	  bool expected = false;
+	  for (vector<string>::const_iterator p = set.begin();
+	       p != set.end() && !expected;
+	       ++p)
+	    if (regex_t_sptr r = abigail::regex::compile(*p))
+	      expected = abigail::regex::match(r, *s);
+
+	  bool got = false;
+	  for (vector<regex_t_sptr>::const_iterator r = alternation.begin();
+	       r != alternation.end() && !got;
+	       ++r)
+	    got = abigail::regex::match(*r, *s);
+
+	  INFO("number of patterns: " << n << ", string: '" << *s << "'");
+	  CHECK(got == expected);
+	}
+    }
+}
+
+TEST_CASE("LargeAlternationsAreSplit")
+{
+  // Many regular expressions, among which an invalid one and one
+  // with a back-reference.
+  vector<string> set;
+  for (int i = 0; i < 300; ++i)
+    {
+      std::ostringstream o;
+      switch (i % 3)
+	{
+	case 0:
+	  o << "^func" << i << "[a-z_]*$";
+	  break;
+	case 1:
+	  o << "(foo|var" << i << ")$";
+	  break;
+	default:
+	  o << "type" << i << "[0-9]+x";
+	}
+      set.push_back(o.str());
+    }
+  set[150] = "(unbalanced";
+  set[151] = "^(var)\\1$";
+
+  vector<regex_t_sptr> alternation;
+  abigail::regex::compile_alternation(set, alternation);
+  CHECK(alternation.size() > 2);
+  CHECK(alternation.size() < 10);
+
+  const char* names[] =
+  {
+    "func0",
+    "func3_abc",
+    "func297",
+    "func298",
+    "xvar1",
+    "var298",
+    "var298x",
+    "foo",
+    "type2x",
+    "type5123x",
+    "type299x",
+    "varvar",
+    "unbalanced",
+    0
+  };
+
+  for (const char** s = names; *s; ++s)
+    {
+      bool expected = false;
+      for (vector<string>::const_iterator p = set.begin();
+	   p != set.end() && !expected;
+	   ++p)
+	if (regex_t_sptr r = abigail::regex::compile(*p))
+	  expected = abigail::regex::match(r, *s);
+
+      bool got = false;
+      for (vector<regex_t_sptr>::const_iterator r = alternation.begin();
+	   r != alternation.end() && !got;
+	   ++r)
+	got = abigail::regex::match(*r, *s);
+
+      INFO("string: '" << *s << "'");
+      CHECK(got == expected);
+    }
+}
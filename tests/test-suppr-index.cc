@@ -0,0 +1,373 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2020 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests that the functions and variables that the
+/// abixml reader drops from the IR, using the index of the
+/// suppression specifications it is given, are the ones that a linear
+/// scan of those suppression specifications would drop.
+///
+/// The suppression specifications are a mix of exact names, regular
+/// expressions, "not" regular expressions and sets of names of
+/// symbols to keep.
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+#include "lib/catch.hpp"
+
+#include "abg-corpus.h"
+#include "abg-reader.h"
+#include "abg-regex.h"
+#include "abg-suppression.h"
+#include "test-utils.h"
+
+using std::set;
+using std::istringstream;
+using std::string;
+using std::unordered_set;
+using abigail::ir::environment;
+using abigail::ir::environment_sptr;
+using abigail::ir::function_decl;
+using abigail::ir::var_decl;
+using abigail::corpus;
+using abigail::corpus_sptr;
+using abigail::regex::regex_t_sptr;
+using abigail::suppr::suppressions_type;
+using abigail::suppr::function_suppression;
+using abigail::suppr::function_suppression_sptr;
+using abigail::suppr::variable_suppression;
+using abigail::suppr::variable_suppression_sptr;
+using abigail::suppr::is_function_suppression;
+using abigail::suppr::is_variable_suppression;
+using abigail::xml_reader::read_context_sptr;
+using abigail::xml_reader::create_native_xml_read_context;
+using abigail::xml_reader::read_corpus_from_input;
+
+/// The abixml file the tests read, relative to the tests source
+/// directory.
+static const char* in_path =
+  "data/test-abidiff/test-PR18166-libtirpc.so.abi";
+
+/// Read the corpus of @ref in_path, dropping the functions and
+/// variables matched by a set of suppression specifications.
+///
+/// @param supprs the suppression specifications to consider.
+///
+/// @param env the environment to read the corpus in.
+///
+/// @return the corpus read.
+static corpus_sptr
+read_corpus(const suppressions_type& supprs, environment* env)
+{
+  string path = string(abigail::tests::get_src_dir()) + "/tests/" + in_path;
+  read_context_sptr ctxt = create_native_xml_read_context(path, env);
+  REQUIRE(ctxt);
+  add_read_context_suppressions(*ctxt, supprs);
+  corpus_sptr corp = read_corpus_from_input(*ctxt);
+  REQUIRE(corp);
+  return corp;
+}
+
+/// Read suppression specifications from a string.
+///
+/// @param text the text of the suppression specifications.
+///
+/// @param supprs the suppression specifications read are added to
+/// this vector.
+static void
+read_suppressions_from_string(const string& text, suppressions_type& supprs)
+{
+  istringstream in(text);
+  abigail::suppr::read_suppressions(in, supprs);
+}
+
+/// Test if a regular expression matches a string.
+///
+/// @param pattern the regular expression to consider.
+///
+/// @param str the string to consider.
+///
+/// @return true iff @p pattern matches @p str.
+static bool
+matches(const string& pattern, const string& str)
+{
+  regex_t_sptr r = abigail::regex::compile(pattern);
+  REQUIRE(r);
+  return abigail::regex::match(r, str);
+}
+
+/// Test if a function or variable suppression matches the name of a
+/// function or variable, without using the index of the suppression
+/// specifications.
+///
+/// @param s the suppression specification to consider.
+///
+/// @param name the qualified name of the function or variable.
+///
+/// @return true iff @p s matches @p name.
+template<typename SuppressionType>
+static bool
+suppression_matches_name(const SuppressionType& s, const string& name)
+{
+  if (!s.get_name_regex_str().empty())
+    return matches(s.get_name_regex_str(), name);
+  if (!s.get_name_not_regex_str().empty())
+    return !matches(s.get_name_not_regex_str(), name);
+  if (!s.get_name().empty())
+    return s.get_name() == name;
+  return false;
+}
+
+/// Test if a function or variable suppression matches the name of
+/// the symbol of a function or variable, without using the index of
+/// the suppression specifications.
+///
+/// @param s the suppression specification to consider.
+///
+/// @param sym_name the linkage name of the function or variable.
+///
+/// @return true iff @p s matches @p sym_name.
+template<typename SuppressionType>
+static bool
+suppression_matches_sym_name(const SuppressionType& s, const string& sym_name)
+{
+  if (s.get_symbol_name().empty()
+      && s.get_symbol_names_to_keep().count(sym_name))
+    return false;
+  if (!s.get_symbol_name_regex_str().empty())
+    return matches(s.get_symbol_name_regex_str(), sym_name);
+  if (!s.get_symbol_name_not_regex_str().empty())
+    return !matches(s.get_symbol_name_not_regex_str(), sym_name);
+  if (!s.get_symbol_name().empty())
+    return s.get_symbol_name() == sym_name;
+  return !s.get_symbol_names_to_keep().empty();
+}
+
+/// Test if a function is dropped by a set of suppression
+/// specifications, by walking all of them.
+///
+/// @param supprs the suppression specifications to consider.
+///
+/// @param fn the function to consider.
+///
+/// @return true iff one of @p supprs drops @p fn.
+static bool
+function_is_suppressed_linearly(const suppressions_type& supprs,
+				const function_decl& fn)
+{
+  for (suppressions_type::const_iterator i = supprs.begin();
+       i != supprs.end();
+       ++i)
+    if (function_suppression_sptr s = is_function_suppression(*i))
+      if (s->get_drops_artifact_from_ir()
+	  && (suppression_matches_name(*s, fn.get_qualified_name())
+	      || suppression_matches_sym_name(*s, fn.get_linkage_name())))
+	return true;
+  return false;
+}
+
+/// Test if a variable is dropped by a set of suppression
+/// specifications, by walking all of them.
+///
+/// @param supprs the suppression specifications to consider.
+///
+/// @param var the variable to consider.
+///
+/// @return true iff one of @p supprs drops @p var.
+static bool
+variable_is_suppressed_linearly(const suppressions_type& supprs,
+				const var_decl& var)
+{
+  for (suppressions_type::const_iterator i = supprs.begin();
+       i != supprs.end();
+       ++i)
+    if (variable_suppression_sptr s = is_variable_suppression(*i))
+      if (s->get_drops_artifact_from_ir()
+	  && (suppression_matches_name(*s, var.get_qualified_name())
+	      || suppression_matches_sym_name(*s, var.get_linkage_name())))
+	return true;
+  return false;
+}
+
+/// Get a string that identifies a function or a variable.
+///
+/// @param decl the function or variable to consider.
+///
+/// @return the string identifying @p decl.
+template<typename DeclType>
+static string
+get_id(const DeclType& decl)
+{return decl.get_qualified_name() + " " + decl.get_linkage_name();}
+
+/// Test that reading @ref in_path with a set of suppression
+/// specifications drops the functions and variables that a linear
+/// scan of those suppression specifications would drop.
+///
+/// @param supprs the suppression specifications to consider.
+static void
+test_index_is_consistent_with_linear_scan(const suppressions_type& supprs)
+{
+  environment_sptr whole_corpus_env(new environment);
+  corpus_sptr whole_corpus = read_corpus(suppressions_type(),
+					 whole_corpus_env.get());
+  environment_sptr env(new environment);
+  corpus_sptr corp = read_corpus(supprs, env.get());
+
+  set<string> expected_fns, fns;
+  for (corpus::functions::const_iterator i =
+	 whole_corpus->get_functions().begin();
+       i != whole_corpus->get_functions().end();
+       ++i)
+    if (!function_is_suppressed_linearly(supprs, **i))
+      expected_fns.insert(get_id(**i));
+  for (corpus::functions::const_iterator i = corp->get_functions().begin();
+       i != corp->get_functions().end();
+       ++i)
+    fns.insert(get_id(**i));
+
+  set<string> expected_vars, vars;
+  for (corpus::variables::const_iterator i =
+	 whole_corpus->get_variables().begin();
+       i != whole_corpus->get_variables().end();
+       ++i)
+    if (!variable_is_suppressed_linearly(supprs, **i))
+      expected_vars.insert(get_id(**i));
+  for (corpus::variables::const_iterator i = corp->get_variables().begin();
+       i != corp->get_variables().end();
+       ++i)
+    vars.insert(get_id(**i));
+
+  // Make sure the suppression specifications do drop something, but
+  // not everything, so that the test is meaningful.
+  CHECK(expected_fns.size() + expected_vars.size()
+	< whole_corpus->get_functions().size()
+	+ whole_corpus->get_variables().size());
+  CHECK(expected_fns.size() + expected_vars.size() > 0);
+
+  CHECK(fns == expected_fns);
+  CHECK(vars == expected_vars);
+}
+
+/// Suppression specifications matching exact names and symbol names.
+static const char* exact_names_supprs =
+  "[suppress_function]\n"
+  "  name = authnone_create\n"
+  "  drop = yes\n"
+  "[suppress_function]\n"
+  "  name = clnt_create\n"
+  "  drop = yes\n"
+  "[suppress_function]\n"
+  "  symbol_name = xdr_pmap\n"
+  "  drop = yes\n"
+  "[suppress_variable]\n"
+  "  name = svc_lock\n"
+  "  drop = yes\n"
+  "[suppress_variable]\n"
+  "  symbol_name = rpc_createerr\n"
+  "  drop = yes\n"
+  // Not dropping anything, so this must be ignored.
+  "[suppress_function]\n"
+  "  name = svc_run\n";
+
+/// Suppression specifications matching regular expressions.
+static const char* regexes_supprs =
+  "[suppress_function]\n"
+  "  name_regexp = ^xdr_u?int\n"
+  "  drop = yes\n"
+  "[suppress_function]\n"
+  "  symbol_name_regexp = ^svc_\n"
+  "  drop = yes\n"
+  "[suppress_variable]\n"
+  "  name_regexp = _lock$\n"
+  "  drop = yes\n"
+  "[suppress_variable]\n"
+  "  symbol_name_regexp = _key$\n"
+  "  drop = yes\n";
+
+/// Suppression specifications matching "not" regular expressions.
+static const char* not_regexes_supprs =
+  "[suppress_function]\n"
+  "  name_not_regexp = ^(clnt|rpcb)_\n"
+  "  drop = yes\n"
+  "[suppress_variable]\n"
+  "  symbol_name_not_regexp = ^__\n"
+  "  drop = yes\n";
+
+/// Suppression specifications that drop the functions and variables
+/// whose symbol names are not in a set of symbol names to keep.
+///
+/// @param supprs the suppression specifications are added to this
+/// vector.
+static void
+add_names_to_keep_supprs(suppressions_type& supprs)
+{
+  unordered_set<string> fn_names, var_names;
+  fn_names.insert("authnone_create");
+  fn_names.insert("clnt_create");
+  fn_names.insert("svc_run");
+  fn_names.insert("xdr_void");
+  var_names.insert("svc_lock");
+  var_names.insert("_null_auth");
+  var_names.insert("log_stderr");
+
+  function_suppression_sptr fn_suppr(new function_suppression);
+  fn_suppr->set_symbol_names_to_keep(fn_names);
+  fn_suppr->set_drops_artifact_from_ir(true);
+  supprs.push_back(fn_suppr);
+
+  variable_suppression_sptr var_suppr(new variable_suppression);
+  var_suppr->set_symbol_names_to_keep(var_names);
+  var_suppr->set_drops_artifact_from_ir(true);
+  supprs.push_back(var_suppr);
+}
+
+TEST_CASE("IndexIsConsistentWithLinearScanForExactNames")
+{
+  suppressions_type supprs;
+  read_suppressions_from_string(exact_names_supprs, supprs);
+  test_index_is_consistent_with_linear_scan(supprs);
+}
+
+TEST_CASE("IndexIsConsistentWithLinearScanForRegexes")
+{
+  suppressions_type supprs;
+  read_suppressions_from_string(regexes_supprs, supprs);
+  test_index_is_consistent_with_linear_scan(supprs);
+}
+
+TEST_CASE("IndexIsConsistentWithLinearScanForNotRegexes")
+{
+  suppressions_type supprs;
+  read_suppressions_from_string(not_regexes_supprs, supprs);
+  test_index_is_consistent_with_linear_scan(supprs);
+}
+
+TEST_CASE("IndexIsConsistentWithLinearScanForNamesToKeep")
+{
+  suppressions_type supprs;
+  add_names_to_keep_supprs(supprs);
+  test_index_is_consistent_with_linear_scan(supprs);
+}
+
+TEST_CASE("IndexIsConsistentWithLinearScanForMixedSuppressions")
+{
+  suppressions_type supprs;
+  read_suppressions_from_string(exact_names_supprs, supprs);
+  read_suppressions_from_string(regexes_supprs, supprs);
+  test_index_is_consistent_with_linear_scan(supprs);
+
+  read_suppressions_from_string(not_regexes_supprs, supprs);
+  test_index_is_consistent_with_linear_scan(supprs);
+
+  suppressions_type names_to_keep_supprs;
+  read_suppressions_from_string(exact_names_supprs, names_to_keep_supprs);
+  add_names_to_keep_supprs(names_to_keep_supprs);
+  read_suppressions_from_string(regexes_supprs, names_to_keep_supprs);
+  test_index_is_consistent_with_linear_scan(names_to_keep_supprs);
+}
@@ -0,0 +1,294 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2020 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests the evaluation of type suppression
+/// specifications against types.
+
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+#include "lib/catch.hpp"
+
+#include "abg-comparison.h"
+#include "abg-corpus.h"
+#include "abg-ir.h"
+#include "abg-suppression.h"
+
+using std::istringstream;
+using std::string;
+using std::unordered_set;
+using abigail::corpus;
+using abigail::corpus_sptr;
+using abigail::ir::environment;
+using abigail::ir::translation_unit;
+using abigail::ir::translation_unit_sptr;
+using abigail::ir::type_base_sptr;
+using abigail::ir::type_decl;
+using abigail::ir::type_decl_sptr;
+using abigail::ir::class_decl;
+using abigail::ir::class_decl_sptr;
+using abigail::ir::var_decl;
+using abigail::ir::var_decl_sptr;
+using abigail::ir::decl_base;
+using abigail::ir::location;
+using abigail::ir::add_decl_to_scope;
+using abigail::ir::canonicalize;
+using abigail::ir::get_name;
+using abigail::comparison::diff_context;
+using abigail::comparison::diff_context_sptr;
+using abigail::comparison::compute_diff;
+using abigail::suppr::suppressions_type;
+using abigail::suppr::type_suppression;
+using abigail::suppr::type_suppression_sptr;
+using abigail::suppr::is_type_suppression;
+
+/// Read a type suppression specification from a string.
+///
+/// @param text the text of the suppression specification.
+///
+/// @return the type suppression specification read.
+static type_suppression_sptr
+read_type_suppression(const string& text)
+{
+  istringstream in(text);
+  suppressions_type supprs;
+  abigail::suppr::read_suppressions(in, supprs);
+  REQUIRE(supprs.size() == 1);
+  type_suppression_sptr s = is_type_suppression(supprs.front());
+  REQUIRE(s);
+  return s;
+}
+
+/// Build a diff context for the comparison of two empty corpora.
+///
+/// The type suppression specifications evaluated in the context of a
+/// comparison need the corpora being compared.
+///
+/// @param env the environment of the corpora.
+///
+/// @return the diff context.
+static diff_context_sptr
+build_diff_context(environment* env)
+{
+  corpus_sptr first(new corpus(env, "libfirst.so"));
+  corpus_sptr second(new corpus(env, "libsecond.so"));
+  diff_context_sptr ctxt(new diff_context);
+  compute_diff(first, second, ctxt);
+  return ctxt;
+}
+
+/// Build an anonymous struct that has a data member of a given type.
+///
+/// @param name the name of the struct.
+///
+/// @param member_type the type of the data member of the struct.
+///
+/// @param tu the translation unit to add the struct to.
+///
+/// @return the struct.
+static class_decl_sptr
+build_anonymous_struct(const string& name,
+		       const type_base_sptr& member_type,
+		       const translation_unit_sptr& tu)
+{
+  class_decl_sptr s(new class_decl(tu->get_environment(), name,
+				   32, 32, /*is_struct=*/true, location(),
+				   decl_base::VISIBILITY_DEFAULT,
+				   /*is_anonymous=*/true));
+  add_decl_to_scope(s, tu->get_global_scope().get());
+  var_decl_sptr m(new var_decl("m", member_type, location(), ""));
+  s->add_data_member(m, abigail::ir::public_access,
+		     /*is_laid_out=*/true, /*is_static=*/false,
+		     /*offset_in_bits=*/0);
+  canonicalize(s);
+  return s;
+}
+
+TEST_CASE("CachedVerdictsDependOnTypeNames")
+{
+  environment env;
+  translation_unit_sptr tu(new translation_unit(&env, "test.c"));
+  type_decl_sptr int_type(new type_decl(&env, "int", 32, 32, location()));
+  add_decl_to_scope(int_type, tu->get_global_scope().get());
+  canonicalize(int_type);
+
+  // Two anonymous structs of the same shape have the same canonical
+  // type, but not the same name.
+  class_decl_sptr first =
+    build_anonymous_struct("__anonymous_struct__", int_type, tu);
+  class_decl_sptr second =
+    build_anonymous_struct("__anonymous_struct__1", int_type, tu);
+  REQUIRE(first->get_naked_canonical_type()
+	  == second->get_naked_canonical_type());
+  REQUIRE(get_name(first) != get_name(second));
+
+  const char* supprs[] =
+  {
+    "[suppress_type]\n"
+    "  name = __anonymous_struct__1\n",
+
+    "[suppress_type]\n"
+    "  name_regexp = 1$\n",
+
+    "[suppress_type]\n"
+    "  name_not_regexp = ^__anonymous_struct__$\n",
+
+    0
+  };
+
+  for (const char** text = supprs; *text; ++text)
+    {
+      INFO("suppression: " << *text);
+      type_suppression_sptr s = read_type_suppression(*text);
+
+      // Whichever type is considered first, its verdict must not be
+      // used for the other one.
+      diff_context_sptr ctxt = build_diff_context(&env);
+      CHECK(!s->suppresses_type(first, ctxt));
+      CHECK(s->suppresses_type(second, ctxt));
+
+      ctxt = build_diff_context(&env);
+      CHECK(s->suppresses_type(second, ctxt));
+      CHECK(!s->suppresses_type(first, ctxt));
+
+      // The cached verdicts are those of the uncached evaluation.
+      CHECK(!s->suppresses_type(first, ctxt));
+      CHECK(s->suppresses_type(second, ctxt));
+      CHECK(s->suppresses_type(first) == s->suppresses_type(first, ctxt));
+      CHECK(s->suppresses_type(second) == s->suppresses_type(second, ctxt));
+    }
+}
+
+/// Build a type declared at a given source location.
+///
+/// @param name the name of the type.
+///
+/// @param path the path of the file of the source location.
+///
+/// @param tu the translation unit to add the type to.
+///
+/// @return the type.
+static type_decl_sptr
+build_type_at(const string& name,
+	      const string& path,
+	      const translation_unit_sptr& tu)
+{
+  location loc = tu->get_loc_mgr().create_new_location(path, 1, 1);
+  type_decl_sptr t(new type_decl(tu->get_environment(), name, 32, 32, loc));
+  add_decl_to_scope(t, tu->get_global_scope().get());
+  return t;
+}
+
+/// Test if a type suppression keeps a type declared in a given file.
+///
+/// @param s the type suppression to consider.  It must match the
+/// name of any type.
+///
+/// @param path the path of the file the type is declared in.
+///
+/// @param tu the translation unit to add the type to.
+///
+/// @return true iff @p s does not suppress the type.
+static bool
+keeps_type_from(const type_suppression& s,
+		const string& path,
+		const translation_unit_sptr& tu)
+{
+  static int num_types = 0;
+  std::ostringstream name;
+  name << "type" << num_types++;
+  return !s.suppresses_type(build_type_at(name.str(), path, tu));
+}
+
+TEST_CASE("SourceLocationsToKeepAreNormalized")
+{
+  environment env;
+  translation_unit_sptr tu(new translation_unit(&env, "test.c"));
+
+  type_suppression s("", ".*", "");
+  unordered_set<string> paths;
+  paths.insert("foo/bar.h");
+  paths.insert("./include//baz.h");
+  paths.insert("/usr/include/./qux.h");
+  paths.insert("quux.h");
+  s.set_source_locations_to_keep(paths);
+
+  struct
+  {
+    const char* path;
+    bool kept;
+  } cases[] =
+  {
+    {"foo/bar.h", true},
+    {"./foo/bar.h", true},
+    {"foo//bar.h", true},
+    {"foo/./bar.h", true},
+    {"foo/bar.h/", true},
+    {"include/baz.h", true},
+    {"./include/./baz.h", true},
+    {"/usr/include/qux.h", true},
+    {"/usr//include/qux.h", true},
+    // The base name of a file path is matched against the file paths
+    // to keep, not the other way around.
+    {"bar.h", false},
+    {"/src/quux.h", true},
+    {"src/./quux.h", true},
+    // ".." components are not resolved, as the file paths might
+    // involve symbolic links.
+    {"foo/../foo/bar.h", false},
+    {"usr/include/qux.h", false},
+    {"foo/bar.hh", false},
+    {"foo", false},
+    {".", false},
+    {"", false},
+    {0, false}
+  };
+
+  for (int i = 0; cases[i].path; ++i)
+    {
+      INFO("path: '" << cases[i].path << "'");
+      CHECK(keeps_type_from(s, cases[i].path, tu) == cases[i].kept);
+      // The second verdict comes from the cache of the matcher.
+      CHECK(keeps_type_from(s, cases[i].path, tu) == cases[i].kept);
+    }
+}
+
+TEST_CASE("SourceLocationsToKeepMatcherIsRebuilt")
+{
+  environment env;
+  translation_unit_sptr tu(new translation_unit(&env, "test.c"));
+
+  type_suppression s("", ".*", "");
+  s.get_source_locations_to_keep().insert("foo.h");
+  CHECK(keeps_type_from(s, "foo.h", tu));
+  CHECK(!keeps_type_from(s, "bar.h", tu));
+
+  // Modifying the set of file paths in place, without changing its
+  // size.
+  s.get_source_locations_to_keep().erase("foo.h");
+  s.get_source_locations_to_keep().insert("bar.h");
+  CHECK(!keeps_type_from(s, "foo.h", tu));
+  CHECK(keeps_type_from(s, "bar.h", tu));
+
+  s.set_source_location_to_keep_regex_str("^src/");
+  CHECK(keeps_type_from(s, "src/foo.h", tu));
+  CHECK(keeps_type_from(s, "bar.h", tu));
+  CHECK(!keeps_type_from(s, "include/foo.h", tu));
+
+  s.set_source_location_to_keep_regex_str("^include/");
+  CHECK(!keeps_type_from(s, "src/foo.h", tu));
+  CHECK(keeps_type_from(s, "include/foo.h", tu));
+
+  unordered_set<string> paths;
+  s.set_source_locations_to_keep(paths);
+  CHECK(!keeps_type_from(s, "bar.h", tu));
+  CHECK(keeps_type_from(s, "include/bar.h", tu));
+
+  s.set_source_location_to_keep_regex_str("");
+  CHECK(!keeps_type_from(s, "include/bar.h", tu));
+}
@@ -40,5 +40,17 @@ get_build_dir()
   return s;
 }
 
+/// Get the number of milliseconds elapsed since a given time point.
+///
+/// @param start the time point to consider.
+///
+/// @return the number of milliseconds elapsed since @p start.
+long
+elapsed_ms(const bench_clock::time_point& start)
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>
+    (bench_clock::now() - start).count();
+}
+
 }//end namespace tests
 }//end namespace abigail
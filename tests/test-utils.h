@@ -7,6 +7,7 @@
 #define __TEST_UTILS_H__
 
 #include "config.h"
+#include <chrono>
 #include <string>
 
 namespace abigail
@@ -17,6 +18,11 @@ namespace tests
 const char* get_src_dir();
 const char* get_build_dir();
 
+/// The clock used to time the benchmark programs.
+typedef std::chrono::steady_clock bench_clock;
+
+long elapsed_ms(const bench_clock::time_point& start);
+
 }//end namespace tests
 }//end namespace abigail
 #endif //__TEST_UTILS_H__
@@ -0,0 +1,314 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2020 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests the worker threads of libabigail: the tasks
+/// scheduled through a queue, the sub-tasks scheduled by tasks
+/// through task groups and futures, the thread budget shared by
+/// nested queues, and the memory budget of a queue.
+
+#include <unistd.h>
+#include <atomic>
+
+#include "lib/catch.hpp"
+
+#include "abg-workers.h"
+
+using abigail::workers::task;
+using abigail::workers::task_sptr;
+using abigail::workers::queue;
+using abigail::workers::task_group;
+using abigail::workers::future;
+
+/// A task that counts how many times it was performed, and how many
+/// of these tasks run at the same time.
+struct counting_task : public task
+{
+  static std::atomic<size_t> num_performed;
+  static std::atomic<size_t> num_running;
+  static std::atomic<size_t> max_num_running;
+
+  virtual void
+  perform()
+  {
+    size_t n = ++num_running;
+    size_t max = max_num_running;
+    while (n > max && !max_num_running.compare_exchange_weak(max, n))
+      ;
+    usleep(1000);
+    --num_running;
+    ++num_performed;
+  }
+
+  static void
+  reset()
+  {
+    num_performed = 0;
+    num_running = 0;
+    max_num_running = 0;
+  }
+}; // end struct counting_task
+
+std::atomic<size_t> counting_task::num_performed;
+std::atomic<size_t> counting_task::num_running;
+std::atomic<size_t> counting_task::max_num_running;
+
+/// A notifier that counts the tasks it's notified about.
+struct counting_notify : public queue::task_done_notify
+{
+  size_t num_notified;
+
+  counting_notify()
+    : num_notified()
+  {}
+
+  virtual void
+  operator()(const task_sptr&)
+  {++num_notified;}
+}; // end struct counting_notify
+
+/// A task that computes a fibonacci number by scheduling the
+/// computation of the two previous ones as sub-tasks, and waiting for
+/// them.
+struct fibonacci_task : public task
+{
+  unsigned n;
+  unsigned result;
+
+  fibonacci_task(unsigned i)
+    : n(i),
+      result()
+  {}
+
+  virtual void
+  perform()
+  {
+    if (n < 2)
+      {
+	result = n;
+	return;
+      }
+
+    std::shared_ptr<fibonacci_task> a(new fibonacci_task(n - 1));
+    std::shared_ptr<fibonacci_task> b(new fibonacci_task(n - 2));
+    {
+      task_group g;
+      g.schedule_task(a);
+      g.schedule_task(b);
+    }
+    result = a->result + b->result;
+  }
+}; // end struct fibonacci_task
+
+/// A task that computes a fibonacci number like fibonacci_task, but
+/// using futures.
+struct fibonacci_future_task : public task
+{
+  unsigned n;
+  unsigned result;
+
+  fibonacci_future_task(unsigned i)
+    : n(i),
+      result()
+  {}
+
+  virtual void
+  perform()
+  {
+    if (n < 2)
+      {
+	result = n;
+	return;
+      }
+
+    future a = abigail::workers::async
+      (task_sptr(new fibonacci_future_task(n - 1)));
+    future b = abigail::workers::async
+      (task_sptr(new fibonacci_future_task(n - 2)));
+    result =
+      static_cast<fibonacci_future_task*>(a.get().get())->result
+      + static_cast<fibonacci_future_task*>(b.get().get())->result;
+  }
+}; // end struct fibonacci_future_task
+
+/// A task that accounts for the memory it is said to need, while it's
+/// performed.
+struct memory_task : public task
+{
+  size_t memory;
+
+  static std::atomic<size_t> memory_in_use;
+  static std::atomic<size_t> max_memory_in_use;
+
+  memory_task(size_t m)
+    : memory(m)
+  {}
+
+  virtual void
+  perform()
+  {
+    size_t n = memory_in_use += memory;
+    size_t max = max_memory_in_use;
+    while (n > max && !max_memory_in_use.compare_exchange_weak(max, n))
+      ;
+    usleep(1000);
+    memory_in_use -= memory;
+  }
+}; // end struct memory_task
+
+std::atomic<size_t> memory_task::memory_in_use;
+std::atomic<size_t> memory_task::max_memory_in_use;
+
+/// A memory estimator that estimates the memory of a @ref memory_task
+/// as what the task is said to need, and counts the tasks it's told
+/// about.
+struct memory_task_estimator : public queue::memory_estimator
+{
+  size_t num_observed;
+
+  memory_task_estimator()
+    : num_observed()
+  {}
+
+  virtual size_t
+  estimate(const task_sptr& t)
+  {return static_cast<memory_task*>(t.get())->memory;}
+
+  virtual void
+  observe(const task_sptr&, size_t)
+  {++num_observed;}
+}; // end struct memory_task_estimator
+
+/// A task that performs counting tasks through a queue of its own.
+struct nested_queue_task : public task
+{
+  virtual void
+  perform()
+  {
+    queue q(4);
+    for (int i = 0; i < 8; ++i)
+      q.schedule_task(task_sptr(new counting_task));
+    q.wait_for_workers_to_complete();
+  }
+}; // end struct nested_queue_task
+
+TEST_CASE("QueuePerformsAllTasks")
+{
+  counting_task::reset();
+  counting_notify notify;
+  queue q(4, notify);
+  for (int i = 0; i < 100; ++i)
+    CHECK(q.schedule_task(task_sptr(new counting_task)));
+  q.wait_for_workers_to_complete();
+
+  CHECK(counting_task::num_performed == 100);
+  CHECK(q.get_completed_tasks().size() == 100);
+  CHECK(notify.num_notified == 100);
+  CHECK(q.get_size() == 0);
+  CHECK(!q.schedule_task(task_sptr(new counting_task)));
+}
+
+TEST_CASE("NestedTaskGroupsDoNotDeadlock")
+{
+  for (unsigned num_workers = 1; num_workers <= 4; ++num_workers)
+    {
+      queue q(num_workers);
+      std::shared_ptr<fibonacci_task> t(new fibonacci_task(15));
+      q.schedule_task(t);
+      q.wait_for_workers_to_complete();
+      CHECK(t->result == 610);
+      CHECK(q.get_completed_tasks().size() == 1);
+    }
+}
+
+TEST_CASE("FuturesDoNotDeadlock")
+{
+  for (unsigned num_workers = 1; num_workers <= 4; ++num_workers)
+    {
+      queue q(num_workers);
+      future f =
+	abigail::workers::async(q, task_sptr(new fibonacci_future_task(15)));
+      REQUIRE(f.is_valid());
+      CHECK(static_cast<fibonacci_future_task*>(f.get().get())->result == 610);
+      CHECK(f.is_ready());
+      q.wait_for_workers_to_complete();
+      // The task of a future is not a task of the queue.
+      CHECK(q.get_completed_tasks().empty());
+    }
+}
+
+TEST_CASE("SubTasksArePerformedRightAwayOutsideOfWorkers")
+{
+  std::shared_ptr<fibonacci_task> t(new fibonacci_task(10));
+  t->perform();
+  CHECK(t->result == 55);
+
+  future f =
+    abigail::workers::async(task_sptr(new fibonacci_future_task(10)));
+  CHECK(f.is_ready());
+  CHECK(static_cast<fibonacci_future_task*>(f.get().get())->result == 55);
+
+  CHECK(!future().is_valid());
+  CHECK(!future().get());
+}
+
+TEST_CASE("ThreadBudgetIsSharedByNestedQueues")
+{
+  abigail::workers::set_thread_budget(2);
+  CHECK(abigail::workers::get_thread_budget() == 2);
+
+  counting_task::reset();
+  queue q(8);
+  for (int i = 0; i < 32; ++i)
+    q.schedule_task(task_sptr(new counting_task));
+  q.wait_for_workers_to_complete();
+  CHECK(counting_task::num_performed == 32);
+  CHECK(counting_task::max_num_running <= 2);
+
+  counting_task::reset();
+  queue outer(4);
+  for (int i = 0; i < 4; ++i)
+    outer.schedule_task(task_sptr(new nested_queue_task));
+  outer.wait_for_workers_to_complete();
+  CHECK(counting_task::num_performed == 32);
+  CHECK(counting_task::max_num_running <= 2);
+
+  abigail::workers::set_thread_budget(0);
+  CHECK(abigail::workers::get_thread_budget()
+	== abigail::workers::get_number_of_threads());
+}
+
+TEST_CASE("MemoryBudgetBoundsTheTasksPerformedAtTheSameTime")
+{
+  abigail::workers::set_thread_budget(4);
+
+  memory_task::memory_in_use = 0;
+  memory_task::max_memory_in_use = 0;
+  counting_notify notify;
+  memory_task_estimator estimator;
+  queue q(4, notify, /*memory_budget=*/100, estimator);
+  CHECK(q.get_memory_budget() == 100);
+
+  // A task that needs more than the whole budget is performed on its
+  // own, and doesn't prevent the other tasks from being performed.
+  q.schedule_task(task_sptr(new memory_task(150)));
+  for (int i = 0; i < 20; ++i)
+    q.schedule_task(task_sptr(new memory_task(40)));
+  for (int i = 0; i < 20; ++i)
+    q.schedule_task(task_sptr(new memory_task(10)));
+  q.wait_for_workers_to_complete();
+
+  CHECK(notify.num_notified == 41);
+  CHECK(estimator.num_observed == 41);
+  CHECK(memory_task::max_memory_in_use <= 150);
+  CHECK(memory_task::memory_in_use == 0);
+
+  abigail::workers::set_thread_budget(0);
+
+  CHECK(abigail::workers::get_resident_set_size() > 0);
+  CHECK(abigail::workers::get_physical_memory_size()
+	>= abigail::workers::get_resident_set_size());
+}
@@ -35,6 +35,8 @@ using abigail::comparison::translation_unit_diff_sptr;
 using abigail::comparison::corpus_diff;
 using abigail::comparison::corpus_diff_sptr;
 using abigail::comparison::compute_diff;
+using abigail::comparison::reporter_base_sptr;
+using abigail::comparison::json_reporter;
 using abigail::comparison::get_default_harmless_categories_bitmap;
 using abigail::comparison::get_default_harmful_categories_bitmap;
 using abigail::suppr::suppression_sptr;
@@ -74,6 +76,7 @@ struct options
   bool			no_arch;
   bool			no_corpus;
   bool			leaf_changes_only;
+  bool			json_report;
   bool			fail_no_debug_info;
   bool			show_hexadecimal_values;
   bool			show_offsets_sizes_in_bits;
@@ -115,6 +118,7 @@ struct options
       no_arch(),
       no_corpus(),
       leaf_changes_only(),
+      json_report(),
       fail_no_debug_info(),
       show_hexadecimal_values(),
       show_offsets_sizes_in_bits(true),
@@ -189,6 +193,8 @@ display_usage(const string& prog_name, ostream& out)
     << " --fail-no-debug-info  bail out if no debug info was found\n"
     << " --leaf-changes-only|-l  only show leaf changes, "
     "so no change impact analysis (implies --redundant)\n"
+    << " --json  emit the report as JSON Lines records "
+    "(implies --redundant)\n"
     << " --deleted-fns  display deleted public functions\n"
     << " --changed-fns  display changed public functions\n"
     << " --added-fns  display added public functions\n"
@@ -386,6 +392,8 @@ parse_command_line(int argc, char* argv[], options& opts)
       else if (!strcmp(argv[i], "--leaf-changes-only")
 	       ||!strcmp(argv[i], "-l"))
 	opts.leaf_changes_only = true;
+      else if (!strcmp(argv[i], "--json"))
+	opts.json_report = true;
       else if (!strcmp(argv[i], "--deleted-fns"))
 	{
 	  opts.show_deleted_fns = true;
@@ -679,8 +687,12 @@ set_diff_context_from_opts(diff_context_sptr ctxt,
   // TODO: maybe that in this case we should avoid firing the
   // redundancy analysis pass altogether.  That could help save a
   // couple of CPU cycle here and there!
+  //
+  // Likewise, the JSON report lists all the changed types that impact
+  // each changed interface.
   ctxt->show_redundant_changes(opts.show_redundant_changes
-                               || opts.leaf_changes_only);
+                               || opts.leaf_changes_only
+                               || opts.json_report);
   ctxt->show_symbols_unreferenced_by_debug_info
     (opts.show_symbols_not_referenced_by_debug_info);
   ctxt->show_added_symbols_unreferenced_by_debug_info
@@ -688,6 +700,12 @@ set_diff_context_from_opts(diff_context_sptr ctxt,
   ctxt->show_unreachable_types(opts.show_all_types);
   ctxt->show_impacted_interfaces(opts.show_impacted_interfaces);
 
+  if (opts.json_report)
+    {
+      reporter_base_sptr r(new json_reporter);
+      ctxt->set_reporter(r);
+    }
+
   if (!opts.show_harmless_changes)
       ctxt->switch_categories_off(get_default_harmless_categories_bitmap());
 
@@ -820,6 +838,7 @@ set_native_xml_reader_options(abigail::xml_reader::read_context& ctxt,
 {
   consider_types_not_reachable_from_public_interfaces(ctxt,
 						      opts.show_all_types);
+  parse_translation_units_concurrently(ctxt, true);
 }
 
 /// Set the regex patterns describing the functions to drop from the
@@ -1131,6 +1150,7 @@ main(int argc, char* argv[])
 	  }
 	  break;
 	case abigail::tools_utils::FILE_TYPE_XML_CORPUS:
+	case abigail::tools_utils::FILE_TYPE_BINARY_CORPUS:
 	  {
 	    abigail::xml_reader::read_context_sptr ctxt =
 	      abigail::xml_reader::create_native_xml_read_context(opts.file1,
@@ -1207,6 +1227,7 @@ main(int argc, char* argv[])
 	  }
 	  break;
 	case abigail::tools_utils::FILE_TYPE_XML_CORPUS:
+	case abigail::tools_utils::FILE_TYPE_BINARY_CORPUS:
 	  {
 	    abigail::xml_reader::read_context_sptr ctxt =
 	      abigail::xml_reader::create_native_xml_read_context(opts.file2,
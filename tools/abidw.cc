@@ -19,6 +19,7 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 #include "abg-config.h"
@@ -34,14 +35,15 @@ using std::cerr;
 using std::cout;
 using std::ostream;
 using std::ofstream;
+using std::ostringstream;
 using std::vector;
 using std::shared_ptr;
 using abigail::tools_utils::emit_prefix;
-using abigail::tools_utils::temp_file;
-using abigail::tools_utils::temp_file_sptr;
 using abigail::tools_utils::check_file;
 using abigail::tools_utils::build_corpus_group_from_kernel_dist_under;
 using abigail::tools_utils::timer;
+using abigail::tools_utils::compressed_ofstream;
+using abigail::tools_utils::string_ends_with;
 using abigail::ir::environment_sptr;
 using abigail::ir::environment;
 using abigail::corpus;
@@ -61,7 +63,9 @@ using abigail::xml_writer::create_write_context;
 using abigail::xml_writer::type_id_style_kind;
 using abigail::xml_writer::write_context_sptr;
 using abigail::xml_writer::write_corpus;
-using abigail::xml_reader::read_corpus_from_native_xml_file;
+using abigail::xml_writer::write_corpus_to_binary;
+using abigail::xml_writer::set_write_translation_units_concurrently;
+using abigail::xml_reader::read_corpus_from_native_xml_buffer;
 using abigail::dwarf_reader::read_context;
 using abigail::dwarf_reader::read_context_sptr;
 using abigail::dwarf_reader::read_corpus_from_elf;
@@ -99,6 +103,8 @@ struct options
   bool			show_locs;
   bool			abidiff;
   bool			annotate;
+  bool			binary;
+  bool			compress;
   bool			do_log;
   bool			drop_private_types;
   bool			drop_undefined_syms;
@@ -123,6 +129,8 @@ struct options
       show_locs(true),
       abidiff(),
       annotate(),
+      binary(),
+      compress(),
       do_log(),
       drop_private_types(false),
       drop_undefined_syms(false),
@@ -183,6 +191,10 @@ display_usage(const string& prog_name, ostream& out)
        "the ABI of the union of vmlinux and its modules\n"
     << "  --abidiff  compare the loaded ABI against itself\n"
     << "  --annotate  annotate the ABI artifacts emitted in the output\n"
+    << "  --binary  emit the ABI in the binary corpus format rather "
+    "than in abixml\n"
+    << "  --compress  compress the output file in the gzip format; this is "
+    "the default if its name ends with .gz\n"
     << "  --stats  show statistics about various internal stuff\n"
     << "  --verbose show verbose messages about internal stuff\n";
   ;
@@ -330,6 +342,10 @@ parse_command_line(int argc, char* argv[], options& opts)
 	opts.abidiff = true;
       else if (!strcmp(argv[i], "--annotate"))
 	opts.annotate = true;
+      else if (!strcmp(argv[i], "--binary"))
+	opts.binary = true;
+      else if (!strcmp(argv[i], "--compress"))
+	opts.compress = true;
       else if (!strcmp(argv[i], "--stats"))
 	opts.show_stats = true;
       else if (!strcmp(argv[i], "--verbose"))
@@ -345,9 +361,43 @@ parse_command_line(int argc, char* argv[], options& opts)
 	}
     }
 
+  if (string_ends_with(opts.out_file_path, ".gz"))
+    opts.compress = true;
+
   return true;
 }
 
+/// Open the output file given by the --out-file option.
+///
+/// The file is compressed on the fly if the --compress option was
+/// given, or if its name ends with '.gz'.
+///
+/// @param opts the options of the program.
+///
+/// @return the output stream of the file, or nil if the file
+/// couldn't be opened.
+static shared_ptr<ostream>
+open_output_file(const options& opts)
+{
+  shared_ptr<ostream> result;
+  if (opts.compress)
+    {
+      shared_ptr<compressed_ofstream> o
+	(new compressed_ofstream(opts.out_file_path));
+      if (o->is_open())
+	result = o;
+    }
+  else
+    {
+      shared_ptr<ofstream> o(new ofstream(opts.out_file_path.c_str(),
+					  std::ios_base::trunc
+					  | std::ios_base::binary));
+      if (o->is_open())
+	result = o;
+    }
+  return result;
+}
+
 /// Initialize the context use for driving ABI comparison.
 ///
 /// @param ctxt the context to initialize.
@@ -535,6 +585,9 @@ load_corpus_and_write_abixml(char* argv[],
       const write_context_sptr& write_ctxt
 	  = create_write_context(corp->get_environment(), cout);
       set_common_options(*write_ctxt, opts);
+      // Compressing the output is costly enough for it to be worth
+      // overlapping with the serialization.
+      set_write_translation_units_concurrently(*write_ctxt, opts.compress);
       t.stop();
 
       if (opts.do_log)
@@ -544,17 +597,24 @@ load_corpus_and_write_abixml(char* argv[],
 
       if (opts.abidiff)
 	{
-	  // Save the abi in abixml format in a temporary file, read
-	  // it back, and compare the ABI of what we've read back
-	  // against the ABI of the input ELF file.
-	  temp_file_sptr tmp_file = temp_file::create();
-	  set_ostream(*write_ctxt, tmp_file->get_stream());
-	  write_corpus(*write_ctxt, corp, 0);
-	  tmp_file->get_stream().flush();
+	  // Save the abi in abixml format (or in the binary corpus
+	  // format if --binary was given) in memory, read it back, and
+	  // compare the ABI of what we've read back against the ABI of
+	  // the input ELF file.
+	  string abi;
+	  {
+	    ostringstream abi_stream;
+	    set_ostream(*write_ctxt, abi_stream);
+	    if (opts.binary)
+	      write_corpus_to_binary(*write_ctxt, corp);
+	    else
+	      write_corpus(*write_ctxt, corp, 0);
+	    set_ostream(*write_ctxt, cout);
+	    abi = abi_stream.str();
+	  }
 	  t.start();
-	  corpus_sptr corp2 =
-	    read_corpus_from_native_xml_file(tmp_file->get_path(),
-					     env.get());
+	  corpus_sptr corp2 = read_corpus_from_native_xml_buffer(abi, env.get());
+	  string().swap(abi);
 	  t.stop();
 	  if (opts.do_log)
 	    emit_prefix(argv[0], cerr)
@@ -563,7 +623,7 @@ load_corpus_and_write_abixml(char* argv[],
 	  if (!corp2)
 	    {
 	      emit_prefix(argv[0], cerr)
-		<< "Could not read temporary XML representation of "
+		<< "Could not read the in-memory XML representation of "
 		"elf file back\n";
 	      return 1;
 	    }
@@ -597,28 +657,33 @@ load_corpus_and_write_abixml(char* argv[],
 
       if (!opts.out_file_path.empty())
 	{
-	  ofstream of(opts.out_file_path.c_str(), std::ios_base::trunc);
-	  if (!of.is_open())
+	  shared_ptr<ostream> of = open_output_file(opts);
+	  if (!of)
 	    {
 	      emit_prefix(argv[0], cerr)
 		<< "could not open output file '"
 		<< opts.out_file_path << "'\n";
 	      return 1;
 	    }
-	  set_ostream(*write_ctxt, of);
+	  set_ostream(*write_ctxt, *of);
 	  t.start();
-	  write_corpus(*write_ctxt, corp, 0);
+	  if (opts.binary)
+	    write_corpus_to_binary(*write_ctxt, corp);
+	  else
+	    write_corpus(*write_ctxt, corp, 0);
 	  t.stop();
 	  if (opts.do_log)
 	    emit_prefix(argv[0], cerr)
 	      << "emitted abixml output in: " << t << "\n";
-	  of.close();
 	  return 0;
 	}
       else
 	{
 	  t.start();
-	  exit_code = !write_corpus(*write_ctxt, corp, 0);
+	  if (opts.binary)
+	    exit_code = !write_corpus_to_binary(*write_ctxt, corp);
+	  else
+	    exit_code = !write_corpus(*write_ctxt, corp, 0);
 	  t.stop();
 	  if (opts.do_log)
 	    emit_prefix(argv[0], cerr)
@@ -688,11 +753,14 @@ load_kernel_corpus_group_and_write_abixml(char* argv[],
       const xml_writer::write_context_sptr& ctxt
 	  = xml_writer::create_write_context(group->get_environment(), cout);
       set_common_options(*ctxt, opts);
+      // Compressing the output is costly enough for it to be worth
+      // overlapping with the serialization.
+      set_write_translation_units_concurrently(*ctxt, opts.compress);
 
       if (!opts.out_file_path.empty())
 	{
-	  ofstream of(opts.out_file_path.c_str(), std::ios_base::trunc);
-	  if (!of.is_open())
+	  shared_ptr<ostream> of = open_output_file(opts);
+	  if (!of)
 	    {
 	      emit_prefix(argv[0], cerr)
 		<< "could not open output file '"
@@ -703,7 +771,7 @@ load_kernel_corpus_group_and_write_abixml(char* argv[],
 	  if (opts.do_log)
 	    emit_prefix(argv[0], cerr)
 	      << "emitting the abixml output ...\n";
-	  set_ostream(*ctxt, of);
+	  set_ostream(*ctxt, *of);
 	  t.start();
 	  exit_code = !write_corpus_group(*ctxt, group, 0);
 	  t.stop();
@@ -768,6 +836,13 @@ main(int argc, char* argv[])
       return 0;
     }
 
+  if (opts.compress && opts.out_file_path.empty())
+    {
+      emit_prefix(argv[0], cerr)
+	<< "option --compress requires option --out-file\n";
+      return 1;
+    }
+
   ABG_ASSERT(!opts.in_file_path.empty());
   if (opts.corpus_group_for_linux)
     {
@@ -349,6 +349,7 @@ main(int argc, char* argv[])
 	  }
 	  break;
 	case abigail::tools_utils::FILE_TYPE_XML_CORPUS:
+	case abigail::tools_utils::FILE_TYPE_BINARY_CORPUS:
 	  {
 	    abigail::xml_reader::read_context_sptr ctxt =
 	      abigail::xml_reader::create_native_xml_read_context(opts.file_path,
@@ -446,6 +447,7 @@ main(int argc, char* argv[])
       else
 	{
 	  if (type == abigail::tools_utils::FILE_TYPE_XML_CORPUS
+	      || type == abigail::tools_utils::FILE_TYPE_BINARY_CORPUS
 	      ||type == abigail::tools_utils::FILE_TYPE_XML_CORPUS_GROUP
 	      || type == abigail::tools_utils::FILE_TYPE_ELF)
 	    {
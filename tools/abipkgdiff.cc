@@ -55,6 +55,7 @@
 #include "config.h"
 
 #include <assert.h>
+#include <dirent.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 
@@ -72,6 +73,7 @@
 #endif
 
 #include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
@@ -110,9 +112,11 @@ using abigail::tools_utils::maybe_get_symlink_target_file_path;
 using abigail::tools_utils::file_exists;
 using abigail::tools_utils::is_dir;
 using abigail::tools_utils::emit_prefix;
+using abigail::tools_utils::emit_json_string;
 using abigail::tools_utils::check_file;
 using abigail::tools_utils::ensure_dir_path_created;
 using abigail::tools_utils::guess_file_type;
+using abigail::tools_utils::string_begins_with;
 using abigail::tools_utils::string_ends_with;
 using abigail::tools_utils::dir_name;
 using abigail::tools_utils::real_path;
@@ -137,6 +141,8 @@ using abigail::ir::corpus_group_sptr;
 using abigail::comparison::diff_context;
 using abigail::comparison::diff_context_sptr;
 using abigail::comparison::compute_diff;
+using abigail::comparison::reporter_base_sptr;
+using abigail::comparison::json_reporter;
 using abigail::comparison::corpus_diff_sptr;
 using abigail::comparison::get_default_harmless_categories_bitmap;
 using abigail::comparison::get_default_harmful_categories_bitmap;
@@ -179,6 +185,7 @@ public:
   string	devel_package1;
   string	devel_package2;
   size_t	num_workers;
+  size_t	memory_budget;
   bool		verbose;
   bool		drop_private_types;
   bool		show_relative_offset_changes;
@@ -187,6 +194,7 @@ public:
   bool		compare_dso_only;
   bool		compare_private_dsos;
   bool		leaf_changes_only;
+  bool		json_report;
   bool		show_all_types;
   bool		show_hexadecimal_values;
   bool		show_offsets_sizes_in_bits;
@@ -225,6 +233,7 @@ public:
       compare_dso_only(),
       compare_private_dsos(),
       leaf_changes_only(),
+      json_report(),
       show_all_types(),
       show_hexadecimal_values(),
       show_offsets_sizes_in_bits(true),
@@ -245,6 +254,10 @@ public:
     // underlying maching.  This is the default value for the number
     // of workers to use in workers queues throughout the code.
     num_workers = abigail::workers::get_number_of_threads();
+
+    // By default, there is no memory budget: the comparisons are
+    // performed in parallel regardless of the memory they need.
+    memory_budget = 0;
   }
 };
 
@@ -736,6 +749,10 @@ struct compare_args
   const string&		debug_dir2;
   const suppressions_type	private_types_suppr2;
   const options&		opts;
+  // The sizes of the debug info files of elf1 and elf2, or zero if
+  // they are unknown.
+  off_t				debug_info_size1;
+  off_t				debug_info_size2;
 
   /// Constructor for compare_args, which is used to pass
   /// information to the comparison threads.
@@ -760,8 +777,18 @@ struct compare_args
       private_types_suppr1(priv_types_suppr1),
       elf2(elf2), debug_dir2(debug_dir2),
       private_types_suppr2(priv_types_suppr2),
-      opts(opts)
+      opts(opts),
+      debug_info_size1(),
+      debug_info_size2()
   {}
+
+  /// Getter of the size of the input of the comparison.
+  ///
+  /// @return the sum of the sizes of the two ELF files and of their
+  /// debug info files.
+  off_t
+  input_size() const
+  {return elf1.size + debug_info_size1 + elf2.size + debug_info_size2;}
 }; // end struct compare_args
 
 /// A convenience typedef for arguments passed to the comparison workers.
@@ -854,6 +881,8 @@ display_usage(const string& prog_name, ostream& out)
     "to the package as well\n"
     << " --leaf-changes-only|-l  only show leaf changes, "
     "so no change impact analysis (implies --redundant)\n"
+    << " --json  emit the reports as JSON Lines records "
+    "(implies --redundant)\n"
     << " --impacted-interfaces|-i  display interfaces impacted by leaf changes\n"
     << " --full-impact|-f  when comparing kernel packages, show the "
     "full impact analysis report rather than the default leaf changes reports\n"
@@ -876,6 +905,9 @@ display_usage(const string& prog_name, ostream& out)
     << " --no-added-binaries            do not display added binaries\n"
     << " --no-abignore                  do not look for *.abignore files\n"
     << " --no-parallel                  do not execute in parallel\n"
+    << " --memory-budget <MiB>          the memory the comparisons "
+    "performed in parallel are estimated to need at most; 0, the default, "
+    "means no limit\n"
     << " --fail-no-dbg                  fail if no debug info was found\n"
     << " --show-identical-binaries      show the names of identical binaries\n"
     << " --verbose                      emit verbose progress messages\n"
@@ -1180,8 +1212,14 @@ set_diff_context_from_opts(diff_context_sptr ctxt,
   ctxt->error_output_stream(&cerr);
   // See comment in abidiff.cc's set_diff_context_from_opts.
   ctxt->show_redundant_changes(opts.show_redundant_changes
-                               || opts.leaf_changes_only);
+                               || opts.leaf_changes_only
+                               || opts.json_report);
   ctxt->show_leaf_changes_only(opts.leaf_changes_only);
+  if (opts.json_report)
+    {
+      reporter_base_sptr r(new json_reporter);
+      ctxt->set_reporter(r);
+    }
   ctxt->show_impacted_interfaces(opts.show_impacted_interfaces);
   ctxt->show_unreachable_types(opts.show_all_types);
   ctxt->show_hex_values(opts.show_hexadecimal_values);
@@ -1574,85 +1612,80 @@ compare_to_self(const elf_file& elf,
   }
 
   corpus_sptr reread_corp;
-  string abi_file_path;
   {
-    if (!opts.pkg1->create_abi_file_path(elf.path, abi_file_path))
-      {
-	if (opts.verbose)
-	  emit_prefix("abipkgdiff", cerr)
-	    << "Could not create the directory tree to store the abi for '"
-	    << elf.path
-	    << "'\n";
-      }
-    ofstream of(abi_file_path.c_str(), std::ios_base::trunc);
-
+    // Serialize the ABIXML representation of the corpus in memory,
+    // and read it back from there.
+    string abixml;
     {
+      ostringstream os;
       const abigail::xml_writer::write_context_sptr c =
-	abigail::xml_writer::create_write_context(env.get(), of);
+	abigail::xml_writer::create_write_context(env.get(), os);
 
       if (opts.verbose)
 	emit_prefix("abipkgdiff", cerr)
-	  << "Writting ABIXML file '"
-	  << abi_file_path
+	  << "Writting ABIXML representation of '"
+	  << elf.path
 	  << "' ...\n";
 
       if (!write_corpus(*c, corp, 0))
 	{
 	  if (opts.verbose)
 	    emit_prefix("abipkgdiff", cerr)
-	      << "Could not write the ABIXML file to '"
-	      << abi_file_path << "'\n";
+	      << "Could not write the ABIXML representation of '"
+	      << elf.path << "'\n";
 
 	  return abigail::tools_utils::ABIDIFF_ERROR;
 	}
 
-      of.flush();
-      of.close();
+      abixml = os.str();
 
       if (opts.verbose)
 	emit_prefix("abipkgdiff", cerr)
-	  << "Wrote ABIXML file '"
-	  << abi_file_path
+	  << "Wrote ABIXML representation of '"
+	  << elf.path
 	  << "' OK\n";
     }
 
-    {
-      abigail::xml_reader::read_context_sptr c =
-	abigail::xml_reader::create_native_xml_read_context(abi_file_path,
-							    env.get());
-      if (!c)
-	{
-	  if (opts.verbose)
-	    emit_prefix("abipkgdiff", cerr)
-	      << "Could not create read context for ABIXML file '"
-	      << abi_file_path << "'\n";
-
-	  return abigail::tools_utils::ABIDIFF_ERROR;
-	}
+    // If the temporary files are to be kept, save the ABIXML
+    // representation in a file, for inspection.
+    string abi_file_path;
+    if (opts.keep_tmp_files
+	&& opts.pkg1->create_abi_file_path(elf.path, abi_file_path))
+      {
+	ofstream of(abi_file_path.c_str(), std::ios_base::trunc);
+	of << abixml;
+	of.close();
+	if (opts.verbose)
+	  emit_prefix("abipkgdiff", cerr)
+	    << "Saved ABIXML file '"
+	    << abi_file_path
+	    << "'\n";
+      }
 
-      if (opts.verbose)
-	emit_prefix("abipkgdiff", cerr)
-	  << "Reading ABIXML file '"
-	  << abi_file_path
-	  << "' ...\n";
+    if (opts.verbose)
+      emit_prefix("abipkgdiff", cerr)
+	<< "Reading back ABIXML representation of '"
+	<< elf.path
+	<< "' ...\n";
 
-      reread_corp = read_corpus_from_input(*c);
-      if (!reread_corp)
-	{
-	  if (opts.verbose)
-	    emit_prefix("abipkgdiff", cerr)
-	      << "Could not read temporary ABIXML file '"
-	      << abi_file_path << "'\n";
+    reread_corp =
+      abigail::xml_reader::read_corpus_from_native_xml_buffer(abixml,
+							      env.get());
+    if (!reread_corp)
+      {
+	if (opts.verbose)
+	  emit_prefix("abipkgdiff", cerr)
+	    << "Could not read back ABIXML representation of '"
+	    << elf.path << "'\n";
 
-	  return abigail::tools_utils::ABIDIFF_ERROR;
-	}
+	return abigail::tools_utils::ABIDIFF_ERROR;
+      }
 
-      if (opts.verbose)
-	emit_prefix("abipkgdiff", cerr)
-	  << "Read file '"
-	  << abi_file_path
-	  << "' OK\n";
-    }
+    if (opts.verbose)
+      emit_prefix("abipkgdiff", cerr)
+	<< "Read back ABIXML representation of '"
+	<< elf.path
+	<< "' OK\n";
   }
 
   ctxt.reset(new diff_context);
@@ -1662,7 +1695,7 @@ compare_to_self(const elf_file& elf,
     emit_prefix("abipkgdiff", cerr)
       << "Comparing the ABIs of: \n"
       << "   '" << corp->get_path() << "' against \n"
-      << "   '" << abi_file_path << "'...\n";
+      << "   its ABIXML representation ...\n";
 
   diff = compute_diff(corp, reread_corp, ctxt);
   if (opts.verbose)
@@ -1970,6 +2003,65 @@ public:
 /// A convenience typedef for a shared_ptr to @ref pkg_prepare_task
 typedef shared_ptr<pkg_prepare_task> pkg_prepare_task_sptr;
 
+/// Get the size of the debug info file of an ELF file of a package.
+///
+/// The debug info file is looked for in the directory of the debug
+/// info directory that mirrors the directory of the ELF file in the
+/// package.  Its name is the name of the ELF file, possibly followed
+/// by a dash and a version string starting with a digit, with the
+/// ".debug" extension.  If several files match, the biggest one is
+/// considered.
+///
+/// @param pkg the package the ELF file belongs to.
+///
+/// @param elf the ELF file to consider.
+///
+/// @param debug_dir the root directory of the debug info files.
+///
+/// @return the size of the debug info file of @p elf, or zero if it
+/// was not found.
+static off_t
+get_debug_info_file_size(const package& pkg,
+			 const elf_file& elf,
+			 const string& debug_dir)
+{
+  const string& root = pkg.extracted_dir_path();
+  if (debug_dir.empty()
+      || !string_begins_with(elf.path, root))
+    return 0;
+
+  string dir;
+  dir_name(elf.path.substr(root.size()), dir);
+  dir = debug_dir + dir;
+
+  DIR* d = opendir(dir.c_str());
+  if (!d)
+    return 0;
+
+  const string exact_name = elf.name + ".debug";
+  const string versioned_prefix = elf.name + "-";
+  off_t size = 0;
+  while (struct dirent* entry = readdir(d))
+    {
+      string name = entry->d_name;
+      if (name != exact_name
+	  && !(string_begins_with(name, versioned_prefix)
+	       && name.size() > versioned_prefix.size()
+	       && isdigit(static_cast<unsigned char>
+			  (name[versioned_prefix.size()]))
+	       && string_ends_with(name, ".debug")))
+	continue;
+
+      struct stat s;
+      string path = dir + "/" + name;
+      if (stat(path.c_str(), &s) == 0 && s.st_size > size)
+	size = s.st_size;
+    }
+  closedir(d);
+
+  return size;
+}
+
 /// The worker task which job is to compare two ELF binaries
 class compare_task : public abigail::workers::task
 {
@@ -2014,11 +2106,16 @@ public:
 	diff->report(out, /*prefix=*/"  ");
 	string name = args->elf1.name;
 
-	pretty_output +=
-	  string("================ changes of '") + name + "'===============\n"
-	  + out.str()
-	  + "================ end of changes of '"
-	  + name + "'===============\n\n";
+	if (args->opts.json_report)
+	  // The records of the JSON report name the binaries they
+	  // are about already.
+	  pretty_output += out.str();
+	else
+	  pretty_output +=
+	    string("================ changes of '") + name + "'===============\n"
+	    + out.str()
+	    + "================ end of changes of '"
+	    + name + "'===============\n\n";
       }
     else
       {
@@ -2555,6 +2652,78 @@ elf_size_is_greater(const task_sptr &task1,
 
 }
 
+/// This type estimates the memory needed by the comparison of two ELF
+/// files, so that the comparisons performed in parallel fit in the
+/// memory budget of the comparison queue.
+///
+/// The memory needed by a comparison is estimated to be proportional
+/// to the size of its input, that is, the size of the ELF files and
+/// of their debug info.  The ratio starts with a conservative guess;
+/// it's then raised to the highest ratio observed for the
+/// comparisons performed so far, if that one is higher.  Since the
+/// larger ELF files are compared first, the ratio is usually refined
+/// early, on comparisons that are representative of the biggest
+/// ones.
+class comparison_memory_estimator
+  : public abigail::workers::queue::memory_estimator
+{
+  // The number of bytes a comparison is estimated to need per byte of
+  // input.
+  double	ratio;
+
+  /// The initial number of bytes a comparison is estimated to need
+  /// per byte of input.
+  static const double initial_ratio;
+
+  /// The comparisons which inputs are smaller than this, in bytes, are
+  /// not considered to refine the ratio, as their memory usage is
+  /// dominated by fixed costs and sampling noise.
+  static const off_t min_observed_input_size = 1024 * 1024;
+
+public:
+  comparison_memory_estimator()
+    : ratio(initial_ratio)
+  {}
+
+  /// Estimate the memory needed by a comparison task.
+  ///
+  /// @param t the comparison task to consider.
+  ///
+  /// @return the estimated memory needed by @p t, in bytes.
+  virtual size_t
+  estimate(const task_sptr& t)
+  {
+    compare_task_sptr comp_task = dynamic_pointer_cast<compare_task>(t);
+    if (!comp_task || !comp_task->args)
+      return 0;
+    return static_cast<size_t>(comp_task->args->input_size() * ratio);
+  }
+
+  /// Refine the ratio used for the estimations, given the peak of the
+  /// memory used by a comparison task.
+  ///
+  /// @param t the comparison task that was performed.
+  ///
+  /// @param peak_memory the peak of the memory used by @p t, in
+  /// bytes.
+  virtual void
+  observe(const task_sptr& t, size_t peak_memory)
+  {
+    compare_task_sptr comp_task = dynamic_pointer_cast<compare_task>(t);
+    if (!comp_task || !comp_task->args || !peak_memory)
+      return;
+
+    off_t input_size = comp_task->args->input_size();
+    if (input_size < min_observed_input_size)
+      return;
+
+    double observed_ratio = static_cast<double>(peak_memory) / input_size;
+    ratio = std::max(ratio, observed_ratio);
+  }
+}; // end class comparison_memory_estimator
+
+const double comparison_memory_estimator::initial_ratio = 8;
+
 /// This type is used to notify the calling thread that the comparison
 /// of two ELF files is done.
 class comparison_done_notify : public abigail::workers::queue::task_done_notify
@@ -2615,6 +2784,36 @@ maybe_erase_temp_dirs(package& first_package, package& second_package,
   erase_created_temporary_directories_parent(opts);
 }
 
+/// Emit a JSON Lines record about a binary that was removed from, or
+/// added to, a package.
+///
+/// @param change the kind of change; either "removed" or "added".
+///
+/// @param relative_path the path of the binary, relative to the root
+/// of the extracted package.
+///
+/// @param soname the SONAME of the binary, or the empty string if it
+/// has none.
+///
+/// @param out the output stream to emit the record to.
+static void
+emit_binary_json_record(const string& change,
+			const string& relative_path,
+			const string& soname,
+			ostream& out)
+{
+  out << "{\"record\":\"binary\",\"change\":";
+  emit_json_string(change, out);
+  out << ",\"name\":";
+  emit_json_string(relative_path, out);
+  if (!soname.empty())
+    {
+      out << ",\"soname\":";
+      emit_json_string(soname, out);
+    }
+  out << "}\n";
+}
+
 /// Compare the ABI of two prepared packages that contain userspace
 /// binaries.
 ///
@@ -2681,6 +2880,12 @@ compare_prepared_userspace_packages(package& first_package,
 				  debug_dir2,
 				  create_private_types_suppressions
 				  (second_package, opts), opts));
+	      args->debug_info_size1 =
+		get_debug_info_file_size(first_package, *it->second,
+					 debug_dir1);
+	      args->debug_info_size2 =
+		get_debug_info_file_size(second_package, *iter->second,
+					 debug_dir2);
 	      compare_task_sptr t(new compare_task(args));
 	      compare_tasks.push_back(t);
 	    }
@@ -2712,8 +2917,12 @@ compare_prepared_userspace_packages(package& first_package,
 			: 1);
   assert(num_workers >= 1);
 
+  // Only perform in parallel the comparisons that are estimated to
+  // fit in the memory budget.
   comparison_done_notify notifier(diff);
-  abigail::workers::queue comparison_queue(num_workers, notifier);
+  comparison_memory_estimator estimator;
+  abigail::workers::queue comparison_queue(num_workers, notifier,
+					   opts.memory_budget, estimator);
 
   // Compare all the binaries, in parallel and then wait for the
   // comparisons to complete.
@@ -2743,40 +2952,52 @@ compare_prepared_userspace_packages(package& first_package,
   // Print information about removed binaries on standard output.
   if (diff.removed_binaries.size())
     {
-      cout << "Removed binaries:\n";
+      if (!opts.json_report)
+	cout << "Removed binaries:\n";
       for (vector<elf_file_sptr>::iterator it = diff.removed_binaries.begin();
 	   it != diff.removed_binaries.end(); ++it)
 	{
 	  string relative_path;
 	  first_package.convert_path_to_relative((*it)->path, relative_path);
-	  cout << "  [D] " << relative_path << ", ";
 	  string soname;
 	  get_soname_of_elf_file((*it)->path, soname);
-	  if (!soname.empty())
-	    cout << "SONAME: " << soname;
+	  if (opts.json_report)
+	    emit_binary_json_record("removed", relative_path, soname, cout);
 	  else
-	    cout << "no SONAME";
-	  cout << "\n";
+	    {
+	      cout << "  [D] " << relative_path << ", ";
+	      if (!soname.empty())
+		cout << "SONAME: " << soname;
+	      else
+		cout << "no SONAME";
+	      cout << "\n";
+	    }
 	}
     }
 
   // Print information about added binaries on standard output.
   if (opts.show_added_binaries && diff.added_binaries.size())
     {
-      cout << "Added binaries:\n";
+      if (!opts.json_report)
+	cout << "Added binaries:\n";
       for (vector<elf_file_sptr>::iterator it = diff.added_binaries.begin();
 	   it != diff.added_binaries.end(); ++it)
 	{
 	  string relative_path;
 	  second_package.convert_path_to_relative((*it)->path, relative_path);
-	  cout << "  [A] " << relative_path << ", ";
 	  string soname;
 	  get_soname_of_elf_file((*it)->path, soname);
-	  if (!soname.empty())
-	    cout << "SONAME: " << soname;
+	  if (opts.json_report)
+	    emit_binary_json_record("added", relative_path, soname, cout);
 	  else
-	    cout << "no SONAME";
-	  cout << "\n";
+	    {
+	      cout << "  [A] " << relative_path << ", ";
+	      if (!soname.empty())
+		cout << "SONAME: " << soname;
+	      else
+		cout << "no SONAME";
+	      cout << "\n";
+	    }
 	}
     }
 
@@ -2838,6 +3059,8 @@ self_compare_prepared_userspace_package(package&	pkg,
 				  debug_dir,
 				  supprs,
 				  opts));
+	      args->debug_info_size1 = args->debug_info_size2 =
+		get_debug_info_file_size(pkg, *it->second, debug_dir);
 	      self_compare_task_sptr t(new self_compare_task(args));
 	      self_compare_tasks.push_back(t);
 	    }
@@ -2864,8 +3087,12 @@ self_compare_prepared_userspace_package(package&	pkg,
 			: 1);
   assert(num_workers >= 1);
 
+  // Only perform in parallel the comparisons that are estimated to
+  // fit in the memory budget.
   comparison_done_notify notifier(diff);
-  abigail::workers::queue comparison_queue(num_workers, notifier);
+  comparison_memory_estimator estimator;
+  abigail::workers::queue comparison_queue(num_workers, notifier,
+					   opts.memory_budget, estimator);
 
   // Compare all the binaries, in parallel and then wait for the
   // comparisons to complete.
@@ -2982,7 +3209,10 @@ compare_prepared_linux_kernel_packages(package& first_package,
   if (diff->has_incompatible_changes())
     status |= abigail::tools_utils::ABIDIFF_ABI_INCOMPATIBLE_CHANGE;
 
-  if (status & abigail::tools_utils::ABIDIFF_ABI_CHANGE)
+  if ((status & abigail::tools_utils::ABIDIFF_ABI_CHANGE)
+      && opts.json_report)
+    diff->report(cout);
+  else if (status & abigail::tools_utils::ABIDIFF_ABI_CHANGE)
     {
       cout << "== Kernel ABI changes between packages '"
 	   << first_package.path() << "' and '"
@@ -3239,6 +3469,8 @@ parse_command_line(int argc, char* argv[], options& opts)
       else if (!strcmp(argv[i], "--leaf-changes-only")
 	       ||!strcmp(argv[i], "-l"))
 	opts.leaf_changes_only = true;
+      else if (!strcmp(argv[i], "--json"))
+	opts.json_report = true;
       else if (!strcmp(argv[i], "--impacted-interfaces")
 	       ||!strcmp(argv[i], "-i"))
 	opts.show_impacted_interfaces = true;
@@ -3280,6 +3512,25 @@ parse_command_line(int argc, char* argv[], options& opts)
 	opts.abignore = false;
       else if (!strcmp(argv[i], "--no-parallel"))
 	opts.parallel = false;
+      else if (!strcmp(argv[i], "--memory-budget"))
+	{
+	  int j = i + 1;
+	  if (j >= argc)
+	    {
+	      opts.missing_operand = true;
+	      opts.wrong_option = argv[i];
+	      return true;
+	    }
+	  char* end = 0;
+	  unsigned long mib = strtoul(argv[j], &end, 10);
+	  if (end == argv[j] || *end)
+	    {
+	      opts.wrong_arg = argv[j];
+	      return false;
+	    }
+	  opts.memory_budget = mib * 1024 * 1024;
+	  ++i;
+	}
       else if (!strcmp(argv[i], "--show-identical-binaries"))
 	opts.show_identical_binaries = true;
       else if (!strcmp(argv[i], "--self-check"))
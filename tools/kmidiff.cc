@@ -40,6 +40,8 @@ using abigail::comparison::translation_unit_diff_sptr;
 using abigail::comparison::corpus_diff;
 using abigail::comparison::corpus_diff_sptr;
 using abigail::comparison::compute_diff;
+using abigail::comparison::reporter_base_sptr;
+using abigail::comparison::json_reporter;
 using abigail::comparison::get_default_harmless_categories_bitmap;
 using abigail::comparison::get_default_harmful_categories_bitmap;
 using abigail::suppr::suppression_sptr;
@@ -57,6 +59,7 @@ struct options
   bool			verbose;
   bool			missing_operand;
   bool			leaf_changes_only;
+  bool			json_report;
   bool			show_hexadecimal_values;
   bool			show_offsets_sizes_in_bits;
   bool			show_impacted_interfaces;
@@ -78,6 +81,7 @@ struct options
       verbose(),
       missing_operand(),
       leaf_changes_only(true),
+      json_report(),
       show_hexadecimal_values(true),
       show_offsets_sizes_in_bits(false),
       show_impacted_interfaces(false)
@@ -110,6 +114,7 @@ display_usage(const string& prog_name, ostream& out)
     << " --impacted-interfaces|-i  show interfaces impacted by ABI changes\n"
     << " --full-impact|-f  show the full impact of changes on top-most "
 	 "interfaces\n"
+    << " --json  emit the report as JSON Lines records\n"
     << " --show-bytes  show size and offsets in bytes\n"
     << " --show-bits  show size and offsets in bits\n"
     << " --show-hex  show size and offset in hexadecimal\n"
@@ -248,6 +253,8 @@ parse_command_line(int argc, char* argv[], options& opts)
       else if (!strcmp(argv[i], "--full-impact")
 	       || !strcmp(argv[i], "-f"))
 	opts.leaf_changes_only = false;
+      else if (!strcmp(argv[i], "--json"))
+	opts.json_report = true;
       else if (!strcmp(argv[i], "--show-bytes"))
 	opts.show_offsets_sizes_in_bits = false;
       else if (!strcmp(argv[i], "--show-bits"))
@@ -303,7 +310,9 @@ set_diff_context(diff_context_sptr ctxt, const options& opts)
   ctxt->default_output_stream(&cout);
   ctxt->error_output_stream(&cerr);
   ctxt->show_relative_offset_changes(true);
-  ctxt->show_redundant_changes(false);
+  // The JSON report lists all the changed types that impact each
+  // changed interface.
+  ctxt->show_redundant_changes(opts.json_report);
   ctxt->show_locs(true);
   ctxt->show_linkage_names(false);
   ctxt->show_symbols_unreferenced_by_debug_info
@@ -313,6 +322,12 @@ set_diff_context(diff_context_sptr ctxt, const options& opts)
   ctxt->show_hex_values(opts.show_hexadecimal_values);
   ctxt->show_offsets_sizes_in_bits(opts.show_offsets_sizes_in_bits);
 
+  if (opts.json_report)
+    {
+      reporter_base_sptr r(new json_reporter);
+      ctxt->set_reporter(r);
+    }
+
   ctxt->switch_categories_off(get_default_harmless_categories_bitmap());
 
   if (!opts.diff_time_supprs.empty())